@@ -0,0 +1,75 @@
+/**
+ * @file bench_pool.cpp
+ * @brief Render pool throughput: many virtual marquees on 1, 2, 4 ... up to the core count.
+ *
+ * Usage: bench_pool [instances] [frames]
+ *
+ * Instances cycle through a plain, a styled and a multi-row text with
+ * different motions. Each worker count is compared against one worker.
+ */
+
+#include "os_agnostic/MarqueeFarm.hpp"
+#include "os_agnostic/MarqueeState.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace {
+
+constexpr std::size_t kDefaultInstances = 1000;
+constexpr std::size_t kDefaultFrames = 250;
+constexpr double kHz = 50.0;  // timeline rate the frames follow
+
+bool parseCount(std::string_view s, std::size_t& out) {
+    const auto [end, ec] = std::from_chars(s.data(), s.data() + s.size(), out);
+    return ec == std::errc{} && end == s.data() + s.size() && out > 0;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    std::size_t instances = kDefaultInstances;
+    std::size_t frames = kDefaultFrames;
+    if (argc > 3 || (argc > 1 && !parseCount(argv[1], instances)) || (argc > 2 && !parseCount(argv[2], frames))) {
+        std::fprintf(stderr, "Usage: bench_pool [instances] [frames]\n");
+        return EXIT_FAILURE;
+    }
+
+    const MarqueeLane lanes[] = {
+        {std::make_shared<const PreparedText>("Welcome to Marquee Console! "), 5.0, ScrollMode::Left},
+        {std::make_shared<const PreparedText>("Colour on every character ", TextEffect{TextEffectKind::Rainbow, {}}),
+         12.0, ScrollMode::Right},
+        {std::make_shared<const PreparedText>(" /\\_/\\ \n( o.o )\n > ^ < "), 3.0, ScrollMode::Bounce},
+    };
+    const std::size_t cores = std::max(1u, std::thread::hardware_concurrency());
+
+    std::vector<FarmBenchmark> results;
+    for (std::size_t workers = 1;; workers = std::min(workers * 2, cores)) {
+        MarqueeFarm farm(workers);
+        for (std::size_t i = 0; i < instances; ++i) {
+            const MarqueeLane& lane = lanes[i % std::size(lanes)];
+            farm.add(lane.text, lane.mode, lane.velocity);
+        }
+        results.push_back(farm.benchmark(frames, kHz));
+        if (workers == cores) break;
+    }
+
+    std::printf("Render pool: %zu marquees x %zu frames (%zu %s)\n", instances, frames, cores,
+                cores == 1 ? "core" : "cores");
+    const double single = results.front().framesPerSecond();
+    for (const FarmBenchmark& r : results) {
+        std::printf("  %zu %s %llu frames/s, %llu ns/frame, %.2fx, %llu steals\n", r.workers,
+                    r.workers == 1 ? "worker: " : "workers:",
+                    static_cast<unsigned long long>(r.framesPerSecond()),
+                    static_cast<unsigned long long>(r.frames ? r.seconds * 1e9 / static_cast<double>(r.frames) : 0),
+                    single > 0 ? r.framesPerSecond() / single : 0.0,
+                    static_cast<unsigned long long>(r.steals));
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,122 @@
+/**
+ * @file bench_runtime.cpp
+ * @brief Thread and coroutine runtimes, and recording, compared with HeadlessRunner.
+ *
+ * Usage: bench_runtime [frames] [fps]
+ *
+ * Each comparison runs the same lanes twice and prints both results and
+ * the difference. Virtual-clock runs (kVirtualFrames, no sleeping) give
+ * the CPU cost per frame; real-clock runs (frames at fps, default 1000 at
+ * 200) give how long after its due time each frame was written, and (for
+ * the runtimes) the CPU time, context switches and wakeups they took.
+ */
+
+#include "os_agnostic/HeadlessRunner.hpp"
+
+#include <charconv>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+constexpr std::uint64_t kVirtualFrames = 100000;
+
+template <typename T>
+bool parseValue(std::string_view s, T& out) {
+    const auto [end, ec] = std::from_chars(s.data(), s.data() + s.size(), out);
+    return ec == std::errc{} && end == s.data() + s.size() && out > 0;
+}
+
+/** @brief Two lanes fast enough that (up to 250 fps) every tick moves one of them. */
+std::vector<MarqueeLane> benchLanes() {
+    return {
+        {std::make_shared<const PreparedText>("Welcome to Marquee Console! "), 400.0, ScrollMode::Left},
+        {std::make_shared<const PreparedText>("Colour on every character ", TextEffect{TextEffectKind::Rainbow, {}}),
+         250.0, ScrollMode::Right},
+    };
+}
+
+/** @brief One run; exits on error. */
+HeadlessReport runOnce(const HeadlessOptions& opts) {
+    HeadlessRunner runner(benchLanes(), opts);
+    std::string error;
+    HeadlessReport r = runner.run(error);
+    if (!error.empty()) {
+        std::fprintf(stderr, "bench_runtime: %s\n", error.c_str());
+        std::exit(EXIT_FAILURE);
+    }
+    return r;
+}
+
+/** @brief One figure of two runs: the first, the second and the difference. */
+void printDelta(const char* name, double first, double second, const char* unit) {
+    std::printf("  %-24s %12.0f %12.0f %+12.0f %-8s", name, first, second, second - first, unit);
+    if (first > 0) std::printf(" (%+.1f%%)", (second - first) / first * 100);
+    std::printf("\n");
+}
+
+/** @brief The console's display runtimes: a render thread and a writer, or one coroutine. */
+void benchRuntimes(std::uint64_t frames, double fps) {
+    HeadlessOptions opts;
+    opts.output = HeadlessOptions::Output::Null;
+    opts.timing = HeadlessOptions::Timing::Real;
+    opts.frames = frames;
+    opts.fps = fps;
+
+    std::printf("Runtime (real clock)      %12s %12s %12s\n", "threads", "coro", "difference");
+    opts.runtime = HeadlessOptions::Runtime::Threads;
+    const HeadlessReport threads = runOnce(opts);
+    opts.runtime = HeadlessOptions::Runtime::Coro;
+    const HeadlessReport coro = runOnce(opts);
+    printDelta("CPU", threads.cpuSeconds * 1e6, coro.cpuSeconds * 1e6, "us");
+    printDelta("context switches", static_cast<double>(threads.contextSwitches),
+               static_cast<double>(coro.contextSwitches), "");
+    printDelta("wakeups", static_cast<double>(threads.wakeups), static_cast<double>(coro.wakeups), "");
+    printDelta("avg late", threads.lateNsAverage(), coro.lateNsAverage(), "ns");
+    printDelta("max late", static_cast<double>(threads.lateNsMax), static_cast<double>(coro.lateNsMax), "ns");
+    printDelta("late frames", static_cast<double>(threads.late), static_cast<double>(coro.late), "");
+}
+
+void benchRecording(std::uint64_t frames, double fps) {
+    const std::string cast = (std::filesystem::temp_directory_path() / "bench_runtime.cast").string();
+    HeadlessOptions opts;
+    opts.output = HeadlessOptions::Output::Null;
+    opts.fps = fps;
+
+    std::printf("Recording (null output)   %12s %12s %12s\n", "without", "with", "difference");
+    opts.frames = kVirtualFrames;
+    const HeadlessReport fast = runOnce(opts);
+    opts.record = cast;
+    const HeadlessReport fastRec = runOnce(opts);
+    printDelta("virtual clock", fast.nsPerFrame(), fastRec.nsPerFrame(), "ns/frame");
+
+    opts.timing = HeadlessOptions::Timing::Real;
+    opts.frames = frames;
+    opts.record.clear();
+    const HeadlessReport paced = runOnce(opts);
+    opts.record = cast;
+    const HeadlessReport pacedRec = runOnce(opts);
+    printDelta("real clock, avg late", paced.lateNsAverage(), pacedRec.lateNsAverage(), "ns");
+    printDelta("real clock, max late", static_cast<double>(paced.lateNsMax), static_cast<double>(pacedRec.lateNsMax), "ns");
+    printDelta("real clock, late frames", static_cast<double>(paced.late), static_cast<double>(pacedRec.late), "");
+    std::filesystem::remove(cast);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    std::uint64_t frames = 1000;
+    double fps = 200.0;
+    if (argc > 3 || (argc > 1 && !parseValue(argv[1], frames)) || (argc > 2 && !parseValue(argv[2], fps))) {
+        std::fprintf(stderr, "Usage: bench_runtime [frames] [fps]\n");
+        return EXIT_FAILURE;
+    }
+    benchRuntimes(frames, fps);
+    benchRecording(frames, fps);
+    return EXIT_SUCCESS;
+}
@@ -6,22 +6,80 @@ if not exist obj mkdir obj
 if not exist bin mkdir bin
 
 REM C++20, warnings, PDB, parallel build; avoid Windows min/max macros
-cl ^
-  /nologo /std:c++20 /EHsc /W4 /Zi /MP /utf-8 /DNOMINMAX ^
-  /Foobj\ /Fd:bin\app.pdb /Fe:bin\app.exe ^
+set CXXFLAGS=/nologo /std:c++20 /EHsc /W4 /Zi /MP /utf-8 /DNOMINMAX /Foobj\ /Fd:bin\app.pdb
+REM set PROFILE_LOCKS=1 first to instrument the console's mutexes ("locks" command)
+if "%PROFILE_LOCKS%"=="1" set CXXFLAGS=%CXXFLAGS% /DMARQUEE_PROFILE_LOCKS
+
+REM Engine library (marquee_core)
+cl /c %CXXFLAGS% ^
+  src\os_agnostic\Broadcast.cpp ^
+  src\os_agnostic\CommandProcessor.cpp ^
+  src\os_agnostic\CoroRuntime.cpp ^
+  src\os_agnostic\HeadlessRunner.cpp ^
+  src\os_agnostic\LaneTimeline.cpp ^
+  src\os_agnostic\MarqueeEngine.cpp ^
+  src\os_agnostic\MarqueeFarm.cpp ^
+  src\os_agnostic\PreparedText.cpp ^
+  src\os_agnostic\ProfiledMutex.cpp ^
+  src\os_agnostic\Recorder.cpp ^
+  src\os_agnostic\RenderPool.cpp ^
+  src\os_agnostic\TextRope.cpp ^
+  src\os_dependent\FrameTimer_win32.cpp ^
+  src\os_dependent\ProcessUsage_win32.cpp ^
+  src\os_dependent\SinkFile_win32.cpp
+if errorlevel 1 goto failed
+
+lib /nologo /OUT:obj\marquee_core.lib ^
+  obj\Broadcast.obj obj\CommandProcessor.obj obj\CoroRuntime.obj obj\HeadlessRunner.obj obj\LaneTimeline.obj ^
+  obj\MarqueeEngine.obj obj\MarqueeFarm.obj obj\PreparedText.obj obj\ProfiledMutex.obj obj\Recorder.obj obj\RenderPool.obj obj\TextRope.obj ^
+  obj\FrameTimer_win32.obj obj\ProcessUsage_win32.obj obj\SinkFile_win32.obj
+if errorlevel 1 goto failed
+
+REM Interactive front end
+cl %CXXFLAGS% /Fe:bin\app.exe ^
   src\main.cpp ^
   src\os_agnostic\CommandHandler.cpp ^
   src\os_agnostic\DisplayHandler.cpp ^
+  src\os_agnostic\FollowCommands.cpp ^
+  src\os_agnostic\FollowHandler.cpp ^
+  src\os_agnostic\FrameScheduler.cpp ^
+  src\os_agnostic\HandlerRegistry.cpp ^
+  src\os_agnostic\JitterCommands.cpp ^
   src\os_agnostic\KeyboardHandler.cpp ^
+  src\os_agnostic\LockCommands.cpp ^
   src\os_agnostic\MarqueeConsole.cpp ^
-  src\os_dependent\Scanner_win32.cpp
+  src\os_agnostic\PlaylistCommands.cpp ^
+  src\os_agnostic\PlaylistHandler.cpp ^
+  src\os_agnostic\RecordCommands.cpp ^
+  src\os_agnostic\SinkCommands.cpp ^
+  src\os_agnostic\StatsCommands.cpp ^
+  src\os_agnostic\StatusLine.cpp ^
+  src\os_agnostic\TimerCommands.cpp ^
+  src\os_agnostic\TimerHandler.cpp ^
+  src\os_dependent\FileFollower_win32.cpp ^
+  src\os_dependent\Scanner_win32.cpp ^
+  src\os_dependent\Terminal_win32.cpp ^
+  src\os_dependent\ThreadTuning_win32.cpp ^
+  obj\marquee_core.lib
+if errorlevel 1 goto failed
 
-if errorlevel 1 (
-  echo.
-  echo Build failed.
-  exit /b 1
-)
+REM Checks on the engine library (what ctest runs): a failed check fails the build
+cl %CXXFLAGS% /Isrc /Fe:bin\marquee_tests.exe tests\marquee_tests.cpp obj\marquee_core.lib
+if errorlevel 1 goto failed
+bin\marquee_tests.exe
+if errorlevel 1 goto failed
+
+REM Benchmarks
+cl %CXXFLAGS% /Isrc /Fe:bin\bench_pool.exe bench\bench_pool.cpp obj\marquee_core.lib
+if errorlevel 1 goto failed
+cl %CXXFLAGS% /Isrc /Fe:bin\bench_runtime.exe bench\bench_runtime.cpp obj\marquee_core.lib
+if errorlevel 1 goto failed
 
 echo.
-echo Build succeeded: bin\app.exe
+echo Build succeeded: bin\app.exe, bin\marquee_tests.exe (passed), bin\bench_pool.exe, bin\bench_runtime.exe
 exit /b 0
+
+:failed
+echo.
+echo Build failed.
+exit /b 1
@@ -8,20 +8,74 @@ CXX=${CXX:-clang++}
 command -v "$CXX" >/dev/null 2>&1 || CXX=${CXX_FALLBACK:-g++}
 
 CXXFLAGS="-std=c++20 -O2 -Wall -Wextra -Wpedantic -pthread -DNOMINMAX"
+# PROFILE_LOCKS=1 scripts/build.sh instruments the console's mutexes ("locks" command)
+if [ "${PROFILE_LOCKS:-0}" = "1" ]; then CXXFLAGS="$CXXFLAGS -DMARQUEE_PROFILE_LOCKS"; fi
 
-# Compile each source into obj/*.obj (keeps same extension across OSes)
+# Engine library (marquee_core): compile into obj/*.obj (keeps same extension across OSes)
+$CXX $CXXFLAGS -c src/os_agnostic/Broadcast.cpp             -o obj/Broadcast.obj
+$CXX $CXXFLAGS -c src/os_agnostic/CommandProcessor.cpp      -o obj/CommandProcessor.obj
+$CXX $CXXFLAGS -c src/os_agnostic/CoroRuntime.cpp           -o obj/CoroRuntime.obj
+$CXX $CXXFLAGS -c src/os_agnostic/HeadlessRunner.cpp        -o obj/HeadlessRunner.obj
+$CXX $CXXFLAGS -c src/os_agnostic/LaneTimeline.cpp          -o obj/LaneTimeline.obj
+$CXX $CXXFLAGS -c src/os_agnostic/MarqueeEngine.cpp         -o obj/MarqueeEngine.obj
+$CXX $CXXFLAGS -c src/os_agnostic/MarqueeFarm.cpp           -o obj/MarqueeFarm.obj
+$CXX $CXXFLAGS -c src/os_agnostic/PreparedText.cpp          -o obj/PreparedText.obj
+$CXX $CXXFLAGS -c src/os_agnostic/ProfiledMutex.cpp         -o obj/ProfiledMutex.obj
+$CXX $CXXFLAGS -c src/os_agnostic/Recorder.cpp              -o obj/Recorder.obj
+$CXX $CXXFLAGS -c src/os_agnostic/RenderPool.cpp            -o obj/RenderPool.obj
+$CXX $CXXFLAGS -c src/os_agnostic/TextRope.cpp              -o obj/TextRope.obj
+$CXX $CXXFLAGS -c src/os_dependent/FrameTimer_posix.cpp     -o obj/FrameTimer_posix.obj
+$CXX $CXXFLAGS -c src/os_dependent/ProcessUsage_posix.cpp   -o obj/ProcessUsage_posix.obj
+$CXX $CXXFLAGS -c src/os_dependent/SinkFile_posix.cpp       -o obj/SinkFile_posix.obj
+
+rm -f obj/libmarquee_core.a
+ar rcs obj/libmarquee_core.a \
+  obj/Broadcast.obj obj/CommandProcessor.obj obj/CoroRuntime.obj obj/HeadlessRunner.obj obj/LaneTimeline.obj \
+  obj/MarqueeEngine.obj obj/MarqueeFarm.obj obj/PreparedText.obj obj/ProfiledMutex.obj obj/Recorder.obj obj/RenderPool.obj obj/TextRope.obj \
+  obj/FrameTimer_posix.obj obj/ProcessUsage_posix.obj obj/SinkFile_posix.obj
+
+# Interactive front end
 $CXX $CXXFLAGS -c src/main.cpp                              -o obj/main.obj
 $CXX $CXXFLAGS -c src/os_agnostic/CommandHandler.cpp        -o obj/CommandHandler.obj
 $CXX $CXXFLAGS -c src/os_agnostic/DisplayHandler.cpp        -o obj/DisplayHandler.obj
+$CXX $CXXFLAGS -c src/os_agnostic/FollowCommands.cpp        -o obj/FollowCommands.obj
+$CXX $CXXFLAGS -c src/os_agnostic/FollowHandler.cpp         -o obj/FollowHandler.obj
+$CXX $CXXFLAGS -c src/os_agnostic/FrameScheduler.cpp        -o obj/FrameScheduler.obj
+$CXX $CXXFLAGS -c src/os_agnostic/HandlerRegistry.cpp       -o obj/HandlerRegistry.obj
+$CXX $CXXFLAGS -c src/os_agnostic/JitterCommands.cpp        -o obj/JitterCommands.obj
 $CXX $CXXFLAGS -c src/os_agnostic/KeyboardHandler.cpp       -o obj/KeyboardHandler.obj
+$CXX $CXXFLAGS -c src/os_agnostic/LockCommands.cpp          -o obj/LockCommands.obj
 $CXX $CXXFLAGS -c src/os_agnostic/MarqueeConsole.cpp        -o obj/MarqueeConsole.obj
+$CXX $CXXFLAGS -c src/os_agnostic/PlaylistCommands.cpp      -o obj/PlaylistCommands.obj
+$CXX $CXXFLAGS -c src/os_agnostic/PlaylistHandler.cpp       -o obj/PlaylistHandler.obj
+$CXX $CXXFLAGS -c src/os_agnostic/RecordCommands.cpp        -o obj/RecordCommands.obj
+$CXX $CXXFLAGS -c src/os_agnostic/SinkCommands.cpp          -o obj/SinkCommands.obj
+$CXX $CXXFLAGS -c src/os_agnostic/StatsCommands.cpp         -o obj/StatsCommands.obj
+$CXX $CXXFLAGS -c src/os_agnostic/StatusLine.cpp            -o obj/StatusLine.obj
+$CXX $CXXFLAGS -c src/os_agnostic/TimerCommands.cpp         -o obj/TimerCommands.obj
+$CXX $CXXFLAGS -c src/os_agnostic/TimerHandler.cpp          -o obj/TimerHandler.obj
+$CXX $CXXFLAGS -c src/os_dependent/FileFollower_posix.cpp   -o obj/FileFollower_posix.obj
 $CXX $CXXFLAGS -c src/os_dependent/Scanner_posix.cpp        -o obj/Scanner_posix.obj
+$CXX $CXXFLAGS -c src/os_dependent/Terminal_posix.cpp       -o obj/Terminal_posix.obj
+$CXX $CXXFLAGS -c src/os_dependent/ThreadTuning_posix.cpp   -o obj/ThreadTuning_posix.obj
 
 # Link
 $CXX $CXXFLAGS \
-  obj/main.obj obj/CommandHandler.obj obj/DisplayHandler.obj \
-  obj/KeyboardHandler.obj obj/MarqueeConsole.obj obj/Scanner_posix.obj \
+  obj/main.obj obj/CommandHandler.obj obj/DisplayHandler.obj obj/FollowCommands.obj obj/FollowHandler.obj obj/FrameScheduler.obj \
+  obj/HandlerRegistry.obj obj/JitterCommands.obj obj/KeyboardHandler.obj obj/LockCommands.obj obj/MarqueeConsole.obj \
+  obj/PlaylistCommands.obj obj/PlaylistHandler.obj obj/RecordCommands.obj obj/SinkCommands.obj obj/StatsCommands.obj \
+  obj/StatusLine.obj obj/TimerCommands.obj obj/TimerHandler.obj \
+  obj/FileFollower_posix.obj obj/Scanner_posix.obj obj/Terminal_posix.obj obj/ThreadTuning_posix.obj \
+  obj/libmarquee_core.a \
   -o bin/app
 
+# Checks on the engine library (what ctest runs): a failed check fails the build
+$CXX $CXXFLAGS tests/marquee_tests.cpp -Isrc obj/libmarquee_core.a -o bin/marquee_tests
+bin/marquee_tests
+
+# Benchmarks
+$CXX $CXXFLAGS bench/bench_pool.cpp -Isrc obj/libmarquee_core.a -o bin/bench_pool
+$CXX $CXXFLAGS bench/bench_runtime.cpp -Isrc obj/libmarquee_core.a -o bin/bench_runtime
+
 echo
-echo "Build succeeded: bin/app"
+echo "Build succeeded: bin/app, bin/marquee_tests (passed), bin/bench_pool, bin/bench_runtime"
@@ -1,14 +1,183 @@
 /**
  * Entry point.
+ *
+ * Without arguments the interactive console runs (--runtime picks threads
+ * or coroutines; --display-cpu, --render-cpu and --realtime tune the
+ * display threads). --headless runs the render engine alone and prints
+ * throughput (see printUsage()).
  */
 
+#include "os_agnostic/CommandProcessor.hpp"
+#include "os_agnostic/HeadlessRunner.hpp"
 #include "os_agnostic/MarqueeConsole.hpp"
+#include "os_agnostic/ProfiledMutex.hpp"
+#include <charconv>
+#include <chrono>
 #include <iostream>
+#include <string_view>
+#include <system_error>
 
-int main() {
+/**
+ * @brief Parse a whole argument value as a number.
+ * @return true if s was a number and nothing else.
+ */
+template <typename T>
+static bool parseValue(std::string_view s, T& out) {
+  if (s.empty()) return false;
+  auto [end, ec] = std::from_chars(s.data(), s.data() + s.size(), out);
+  return ec == std::errc{} && end == s.data() + s.size();
+}
+
+static void printUsage() {
+  std::cerr << "Usage: app [--runtime=threads|coro] [--display-cpu=N] [--render-cpu=N] [--realtime]\n"
+               "       app [--headless[=memory|null] [--frames=N] [--fps=HZ] [--clock=virtual|real]\n"
+               "            [--runtime=inline|threads|coro] [--text=TEXT]... [--velocity=COLS_PER_S]\n"
+               "            [--mode=left|right|bounce|vertical] [--record=FILE.cast] [--command=MARQUEE_COMMAND]...]\n";
+}
+
+/**
+ * @brief Run the engine without a terminal and print what it measured.
+ * @return Process exit code.
+ */
+static int runHeadless(int argc, char** argv) {
+  HeadlessOptions opts;
+  std::vector<std::string_view> texts;
+  std::vector<std::string_view> commands;
+  double velocity = 5.0;
+  ScrollMode mode = ScrollMode::Left;
+
+  for (int i = 1; i < argc; ++i) {
+    const std::string_view arg = argv[i];
+    const auto eq = arg.find('=');
+    const std::string_view key = arg.substr(0, eq);
+    const std::string_view value = eq == std::string_view::npos ? std::string_view{} : arg.substr(eq + 1);
+
+    bool ok = true;
+    if (key == "--headless") {
+      if (value == "null") opts.output = HeadlessOptions::Output::Null;
+      else ok = value.empty() || value == "memory";
+    } else if (key == "--clock") {
+      if (value == "real") opts.timing = HeadlessOptions::Timing::Real;
+      else ok = value == "virtual";
+    } else if (key == "--runtime") {
+      if (value == "threads") opts.runtime = HeadlessOptions::Runtime::Threads;
+      else if (value == "coro") opts.runtime = HeadlessOptions::Runtime::Coro;
+      else ok = value == "inline";
+    } else if (key == "--frames") {
+      ok = parseValue(value, opts.frames);
+    } else if (key == "--fps") {
+      ok = parseValue(value, opts.fps) && opts.fps > 0;
+    } else if (key == "--velocity") {
+      ok = parseValue(value, velocity) && velocity >= 0;
+    } else if (key == "--mode") {
+      ok = parseScrollMode(value, mode);
+    } else if (key == "--record") {
+      opts.record.assign(value);
+      ok = !value.empty();
+    } else if (key == "--command") {
+      commands.push_back(value);
+    } else if (key == "--text") {
+      texts.push_back(value);
+    } else {
+      ok = false;
+    }
+    if (!ok) {
+      std::cerr << "Bad argument: " << arg << "\n";
+      printUsage();
+      return 2;
+    }
+  }
+
+  if (texts.empty()) texts.push_back("Welcome to Marquee Console! ");
+  std::vector<MarqueeLane> lanes;
+  for (std::string_view t : texts) {
+    lanes.push_back(MarqueeLane{std::make_shared<const PreparedText>(t), velocity, mode});
+  }
+
+  HeadlessRunner runner(std::move(lanes), opts);
+
+  // Marquee commands (set_effect, lane add, ...) go through the engine's own processor.
+  const CommandProcessor processor(runner.state());
+  for (std::string_view command : commands) {
+    const CommandResult r = processor.execute(command);
+    if (r.status != CommandResult::Status::Done) {
+      std::cerr << "Bad command: " << command << "\n"
+                << (r.handled() ? std::string_view{r.feedback} : std::string_view{"Not a marquee command.\n"});
+      return 2;
+    }
+  }
+
+  std::string error;
+  const HeadlessReport r = runner.run(error);
+  if (!error.empty()) {
+    std::cerr << "Headless run failed: " << error << "\n";
+    return 1;
+  }
+
+  const std::size_t laneCount = runner.state().getLanes()->size();
+  std::cout << "Headless: " << r.frames << " frames of " << laneCount << (laneCount == 1 ? " lane" : " lanes")
+            << " (" << (opts.output == HeadlessOptions::Output::Null ? "null" : "memory") << " output, "
+            << (opts.timing == HeadlessOptions::Timing::Real ? "real" : "virtual") << " clock, "
+            << (opts.runtime == HeadlessOptions::Runtime::Threads ? "threads"
+                : opts.runtime == HeadlessOptions::Runtime::Coro  ? "coro" : "inline") << " runtime, "
+            << 1e9 / static_cast<double>(runner.state().frameInterval().count()) << " fps timeline)\n"
+            << "  " << static_cast<std::uint64_t>(r.framesPerSecond()) << " frames/s, "
+            << static_cast<std::uint64_t>(r.nsPerFrame()) << " ns/frame, "
+            << (r.frames ? r.bytes / r.frames : 0) << " bytes/frame ("
+            << (r.frames ? r.sgrBytes / r.frames : 0) << " SGR)\n"
+            << "  " << r.seconds * 1000 << " ms wall, " << r.timelineSeconds << " s of marquee time";
+  if (opts.timing == HeadlessOptions::Timing::Real) std::cout << ", " << r.late << " late";
+  std::cout << "\n";
+  if (opts.timing == HeadlessOptions::Timing::Real) {
+    std::cout << "  written " << static_cast<std::uint64_t>(r.lateNsAverage()) << " ns avg, " << r.lateNsMax
+              << " ns max after due; CPU " << r.cpuSeconds * 1000 << " ms, " << r.contextSwitches
+              << " context switches, " << r.wakeups << " wakeups\n";
+  }
+  if (!opts.record.empty()) {
+    const RecorderStats& rs = r.recording;
+    std::cout << "  recorded " << rs.events << " frames to " << opts.record << " (" << rs.fileBytes << " bytes in "
+              << rs.writes << " writes, " << rs.dropped << " dropped), capture "
+              << (rs.events ? rs.captureNsTotal / rs.events : 0) << " ns avg, " << rs.captureNsMax << " ns max\n";
+  }
+  return 0;
+}
+
+int main(int argc, char** argv) {
   std::ios::sync_with_stdio(false);
   std::cin.tie(nullptr);
 
+  if (argc > 1 && std::string_view{argv[1]}.substr(0, 10) == "--headless") return runHeadless(argc, argv);
+
+  ConsoleRuntime runtime = ConsoleRuntime::Threads;
+  ThreadTuning display;
+  ThreadTuning render;
+  bool realtime = false;
+  for (int i = 1; i < argc; ++i) {
+    const std::string_view arg = argv[i];
+    bool ok = true;
+    if (arg == "--runtime=threads") {
+      runtime = ConsoleRuntime::Threads;
+    } else if (arg == "--runtime=coro") {
+      runtime = ConsoleRuntime::Coroutines;
+    } else if (arg.substr(0, 14) == "--display-cpu=") {
+      ok = parseValue(arg.substr(14), display.core) && display.core >= 0;
+    } else if (arg.substr(0, 13) == "--render-cpu=") {
+      ok = parseValue(arg.substr(13), render.core) && render.core >= 0;
+    } else if (arg == "--realtime") {
+      realtime = true;
+    } else {
+      ok = false;
+    }
+    if (!ok) {
+      std::cerr << "Bad argument: " << arg << "\n";
+      printUsage();
+      return 2;
+    }
+  }
+  // --realtime raises the display thread, and the render thread only if it was given a core too.
+  display.realtime = realtime;
+  render.realtime = realtime && render.core >= 0;
+
   // Welcome banner
   std::cout << "\n\n***********************************************\n\n"
             << "Welcome to the Marquee Console!\n\n"
@@ -21,9 +190,20 @@ int main() {
             << "\n***********************************************\n"
             << std::flush;
 
-  MarqueeConsole console;
-  console.run();
+  std::chrono::steady_clock::time_point exitTime;
+  {
+    MarqueeConsole console;
+    console.tuneThreads(display, render);
+    console.run(runtime);
+    exitTime = console.exitTime();
+  }
+
+  // From the exit request to here: every handler stopped, output drained, console torn down.
+  const auto shutdown = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - exitTime);
+  std::cout << "Finished Execution! (shut down in " << shutdown.count() << " ms, limit "
+            << MarqueeConsole::kShutdownLimit.count() << " ms)\n";
 
-  std::cout << "Finished Execution!\n";
+  // Profiles outlive their locks, so this covers the whole session.
+  if (ProfiledMutex::kEnabled) std::cout << "\nLock profiles:\n" << ProfiledMutex::report();
   return 0;
 }
@@ -0,0 +1,211 @@
+/**
+ * @file Broadcast.cpp
+ * @brief Bounded per-sink queues drained by one fan-out thread.
+ */
+
+#include "Broadcast.hpp"
+#include <algorithm>
+
+/**
+ * @brief Stop the fan-out thread; unwritten chunks are discarded.
+ */
+Broadcast::~Broadcast() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_one();
+    if (writer.joinable()) writer.join();
+}
+
+/**
+ * @brief Open spec and start mirroring to it.
+ */
+std::uint32_t Broadcast::add(std::string_view spec, std::string_view preamble, std::string& error) {
+    SinkFile::Kind kind;
+    std::string_view path;
+    if (spec.substr(0, 5) == "fifo:") {
+        kind = SinkFile::Kind::Fifo;
+        path = spec.substr(5);
+    } else if (spec.substr(0, 5) == "file:") {
+        kind = SinkFile::Kind::File;
+        path = spec.substr(5);
+    } else {
+        error = "expected fifo:<path> or file:<path>";
+        return 0;
+    }
+    if (path.empty()) {
+        error = "missing path";
+        return 0;
+    }
+
+    auto sink = std::make_shared<Sink>();
+    sink->spec.assign(spec);
+    if (!sink->file.open(kind, std::string{path}, error)) return 0;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (sinks.size() >= kMaxSinks) {
+        error = "too many sinks";
+        return 0;
+    }
+    sink->id = nextId++;
+    sink->preamble.assign(preamble);
+    if (!preamble.empty()) {
+        Buffer buf = acquire();
+        buf->assign(preamble);
+        sink->queue.push_back(std::move(buf));
+    }
+    sinks.push_back(sink);
+    sinkCount.store(sinks.size(), std::memory_order_relaxed);
+
+    if (!writer.joinable()) writer = std::thread([this] { drain(); });
+    wake.notify_one();
+    return sink->id;
+}
+
+/**
+ * @brief Unregister id. The fan-out thread may still be finishing a write
+ * to it; the file is closed once that write returns.
+ */
+bool Broadcast::remove(std::uint32_t id) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = std::find_if(sinks.begin(), sinks.end(), [id](const auto& s) { return s->id == id; });
+    if (it == sinks.end()) return false;
+    sinks.erase(it);
+    sinkCount.store(sinks.size(), std::memory_order_relaxed);
+    return true;
+}
+
+/**
+ * @brief Snapshot of the registered sinks.
+ */
+std::vector<SinkInfo> Broadcast::list(std::uint64_t& droppedOut) {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::vector<SinkInfo> out;
+    out.reserve(sinks.size());
+    for (const auto& s : sinks) out.push_back(SinkInfo{s->id, s->spec, s->bytes, s->skipped, s->queue.size()});
+    droppedOut = dropped;
+    return out;
+}
+
+/**
+ * @brief Reuse a pooled buffer that no queue holds any more, else allocate.
+ *
+ * A use count of one means only the pool refers to it; nobody else can get
+ * a new reference without the lock, so the count cannot go back up.
+ */
+Broadcast::Buffer Broadcast::acquire() {
+    for (const Buffer& b : pool) {
+        if (b.use_count() == 1) {
+            b->clear();
+            return b;
+        }
+    }
+    Buffer b = std::make_shared<std::string>();
+    if (pool.size() < kPoolSize) pool.push_back(b);
+    return b;
+}
+
+/**
+ * @brief Copy parts once and queue the copy for every sink.
+ */
+void Broadcast::publish(std::initializer_list<std::string_view> parts, bool guaranteed) {
+    if (!active()) return;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (sinks.empty()) return;
+
+    Buffer buf = acquire();
+    for (std::string_view p : parts) buf->append(p);
+
+    for (const auto& sink : sinks) {
+        Sink& s = *sink;
+        if (s.queue.size() < kQueueDepth) {
+            s.queue.push_back(buf);
+        } else {
+            ++s.skipped;                          // a later frame redraws everything...
+            s.resync = s.resync || guaranteed;    // ...onto a fresh preamble, if the stream lost more
+        }
+    }
+    wake.notify_one();
+}
+
+/**
+ * @brief Hand the sink's queued chunks to one writev and retire what was taken.
+ *
+ * The lock is released around the write. The chunks stay alive because
+ * only this thread ever pops them, even if the sink is removed meanwhile.
+ *
+ * @return false if the sink is still full (retry later).
+ */
+bool Broadcast::writeSink(std::unique_lock<std::mutex>& lock, const std::shared_ptr<Sink>& sink) {
+    std::string_view parts[SinkFile::kMaxParts];
+    std::size_t count = 0;
+    for (const Buffer& b : sink->queue) {
+        if (count == SinkFile::kMaxParts) break;
+        parts[count] = std::string_view{*b}.substr(count == 0 ? sink->offset : 0);
+        ++count;
+    }
+
+    lock.unlock();
+    long long n = sink->file.writeSome(parts, count);
+    lock.lock();
+
+    if (n < 0) {
+        // The disk is full, or the file or pipe is broken: stop mirroring to it.
+        auto it = std::find(sinks.begin(), sinks.end(), sink);
+        if (it != sinks.end()) {
+            sinks.erase(it);
+            sinkCount.store(sinks.size(), std::memory_order_relaxed);
+            ++dropped;
+        }
+        return true;
+    }
+
+    sink->bytes += static_cast<std::uint64_t>(n);
+    while (n > 0) {
+        const std::size_t left = sink->queue.front()->size() - sink->offset;
+        if (static_cast<std::size_t>(n) < left) {
+            sink->offset += static_cast<std::size_t>(n);
+            break;
+        }
+        n -= static_cast<long long>(left);
+        sink->queue.pop_front();
+        sink->offset = 0;
+    }
+    if (sink->queue.empty() && sink->resync) {
+        // Caught up after losing output: lay the rows out again for the next frame.
+        sink->resync = false;
+        Buffer buf = acquire();
+        buf->assign(sink->preamble);
+        sink->queue.push_back(std::move(buf));
+        return false;
+    }
+    return sink->queue.empty();
+}
+
+/**
+ * @brief Fan-out loop: write every sink that has something queued, then sleep.
+ *
+ * Sleeps until the next publish, or for kRetry while some sink is full.
+ */
+void Broadcast::drain() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (!stopping) {
+        draining.assign(sinks.begin(), sinks.end());
+        bool full = false;
+        for (const auto& sink : draining) {
+            if (!sink->queue.empty() && !writeSink(lock, sink)) full = true;
+        }
+        draining.clear();  // removed sinks close here
+
+        const auto pending = [this] {
+            return stopping || std::any_of(sinks.begin(), sinks.end(), [](const auto& s) { return !s->queue.empty(); });
+        };
+        if (full) {
+            wake.wait_for(lock, kRetry);
+        } else {
+            wake.wait(lock, pending);
+        }
+    }
+}
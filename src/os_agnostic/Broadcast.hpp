@@ -0,0 +1,133 @@
+/**
+ * @file Broadcast.hpp
+ * @brief Fans the composed console stream out to extra output sinks (FIFOs, log files).
+ */
+
+#pragma once
+
+#include "../os_dependent/SinkFile.hpp"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <initializer_list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+/** @brief One sink as shown by "sink list". */
+struct SinkInfo {
+    std::uint32_t id{0};
+    std::string spec;           // as given to add(), e.g. "fifo:/tmp/m1"
+    std::uint64_t bytes{0};     // written so far
+    std::uint64_t skipped{0};   // chunks left out because its queue was full
+    std::size_t queued{0};      // chunks waiting
+};
+
+/**
+ * @brief Render once, write to many.
+ *
+ * Every chunk the console writes (composed frames, echoes, feedback) is
+ * copied once into a refcounted buffer and a reference is queued for each
+ * sink. A background thread drains the queues with one writev per sink per
+ * wake-up, so the display thread never waits on a sink.
+ *
+ * Each sink's queue is bounded (kQueueDepth). When a sink's queue is full,
+ * chunks are skipped for that sink only. A skipped marquee frame costs
+ * nothing (the next frame redraws everything anyway). A skipped chunk that
+ * the stream depends on, such as a command echo, marks the sink for a
+ * resync: once its queue has drained, the preamble is sent again and the
+ * next frame redraws onto it. A FIFO with no reader (it is held open
+ * read-write, see SinkFile) simply stays full and skipped until a reader
+ * attaches. Only a sink whose writes fail is dropped. The other sinks and
+ * the terminal never notice either way.
+ *
+ * Buffers are recycled once every sink is done with them, so a steady
+ * stream allocates nothing.
+ */
+class Broadcast {
+public:
+    using Buffer = std::shared_ptr<std::string>;
+
+    /** @brief Chunks a sink may have waiting before it is skipped. */
+    static constexpr std::size_t kQueueDepth = 64;
+
+    /** @brief Most sinks at once. */
+    static constexpr std::size_t kMaxSinks = 16;
+
+    /** @brief How often a full sink is retried. */
+    static constexpr std::chrono::milliseconds kRetry{5};
+
+    Broadcast() = default;
+    ~Broadcast();
+
+    Broadcast(const Broadcast&) = delete;
+    Broadcast& operator=(const Broadcast&) = delete;
+
+    /**
+     * @brief Open and register a sink.
+     * @param spec "fifo:<path>" or "file:<path>".
+     * @param preamble Written to the new sink first (lays out the rows the stream draws into).
+     * @param error Receives a short reason on failure.
+     * @return The sink's id, or 0 on failure.
+     */
+    std::uint32_t add(std::string_view spec, std::string_view preamble, std::string& error);
+
+    /** @brief Unregister a sink; anything still queued for it is discarded. */
+    bool remove(std::uint32_t id);
+
+    /** @brief The registered sinks, plus how many were dropped because a write to them failed. */
+    std::vector<SinkInfo> list(std::uint64_t& dropped);
+
+    /** @brief Whether any sink is registered (cheap; checked before composing a copy). */
+    bool active() const { return sinkCount.load(std::memory_order_relaxed) != 0; }
+
+    /**
+     * @brief Queue parts, joined into one buffer, for every sink.
+     * @param parts Bytes exactly as written to the terminal.
+     * @param guaranteed false for a frame that may be skipped; true for output that may not.
+     */
+    void publish(std::initializer_list<std::string_view> parts, bool guaranteed);
+
+private:
+    struct Sink {
+        std::uint32_t id{0};
+        std::string spec;
+        SinkFile file;
+        std::deque<Buffer> queue;   // chunks not yet fully written
+        std::size_t offset{0};      // bytes of queue.front() already written
+        std::uint64_t bytes{0};
+        std::uint64_t skipped{0};
+        std::string preamble;       // sent first, and again after a resync
+        bool resync{false};         // output it depends on was skipped: re-send the preamble once drained
+    };
+
+    /** @brief A recycled buffer no sink refers to any more, or a new one (lock held). */
+    Buffer acquire();
+
+    /** @brief Fan-out thread body: writev every sink's queue until stopped. */
+    void drain();
+
+    /** @brief Buffers kept for reuse (two queues' worth; a full queue of a slow sink pins its share). */
+    static constexpr std::size_t kPoolSize = kQueueDepth * 2;
+
+    /** @brief Write what sink will take now (lock held; released around the write). */
+    bool writeSink(std::unique_lock<std::mutex>& lock, const std::shared_ptr<Sink>& sink);
+
+    std::mutex mutex;                            // guards everything below
+    std::condition_variable wake;                // publish/add/remove -> fan-out thread
+    std::vector<std::shared_ptr<Sink>> sinks;
+    std::vector<Buffer> pool;                    // buffers for reuse (at most kPoolSize)
+    std::vector<std::shared_ptr<Sink>> draining; // fan-out thread's copy of sinks (capacity reused)
+    std::uint32_t nextId{1};
+    std::uint64_t dropped{0};
+    bool stopping{false};
+    std::thread writer;                          // started with the first sink
+
+    std::atomic<std::size_t> sinkCount{0};
+};
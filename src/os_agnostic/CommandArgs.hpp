@@ -0,0 +1,207 @@
+/**
+ * @file CommandArgs.hpp
+ * @brief Small parsing and formatting helpers shared by the command front ends and the writers they drive.
+ */
+
+#pragma once
+
+#include <cctype>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <system_error>
+
+/**
+ * @brief Strip spaces and tabs from both ends of a view.
+ * @param s View to trim.
+ * @return The trimmed sub-view (empty if s is all blanks).
+ */
+inline std::string_view trimView(std::string_view s) {
+    auto l = s.find_first_not_of(" \t");
+    auto r = s.find_last_not_of(" \t");
+    if (l == std::string_view::npos) return {};
+    return s.substr(l, r - l + 1);
+}
+
+/**
+ * @brief Split the leading word off args.
+ * @param args Remaining arguments; the word (and the blanks after it) are removed.
+ * @return The word (empty when args is blank).
+ */
+inline std::string_view takeWord(std::string_view& args) {
+    args = trimView(args);
+    const auto space = args.find_first_of(" \t");
+    const std::string_view word = args.substr(0, space);
+    args = space == std::string_view::npos ? std::string_view{} : trimView(args.substr(space));
+    return word;
+}
+
+/**
+ * @brief Safely lowercase a string (manages signed characters).
+ * @param s Any std::basic_string of char, modified in place.
+ */
+template <typename String>
+void toLowerInPlace(String& s) {
+    for (auto& ch : s) {
+        ch = static_cast<char>(std::tolower(static_cast<unsigned char>(ch)));
+    }
+}
+
+/**
+ * @brief Parse a whole argument as a count or index (lane number, instances, frames).
+ * @param arg Trimmed argument.
+ * @param n Receives the number on success.
+ * @return true if arg was a non-negative integer and nothing else.
+ */
+inline bool parseCount(std::string_view arg, std::size_t& n) {
+    if (arg.empty()) return false;
+    auto [end, ec] = std::from_chars(arg.data(), arg.data() + arg.size(), n);
+    return ec == std::errc{} && end == arg.data() + arg.size();
+}
+
+/**
+ * @brief Parse a whole argument as a real number (a leading '+' is allowed).
+ * @param arg Trimmed argument.
+ * @param v Receives the value on success.
+ * @return true if arg was a number and nothing else.
+ */
+inline bool parseReal(std::string_view arg, double& v) {
+    if (!arg.empty() && arg.front() == '+') arg.remove_prefix(1);
+    if (arg.empty()) return false;
+    auto [end, ec] = std::from_chars(arg.data(), arg.data() + arg.size(), v);
+    return ec == std::errc{} && end == arg.data() + arg.size();
+}
+
+/**
+ * @brief Parse a duration such as "500ms", "1.5s", "10m" or "2h" (no unit: seconds).
+ * @param arg Trimmed argument.
+ * @param d Receives the duration on success.
+ * @return true if arg was a non-negative number with an optional unit, under a year.
+ */
+inline bool parseDuration(std::string_view arg, std::chrono::nanoseconds& d) {
+    double scale = 1e9;
+    auto hasUnit = [&arg](std::string_view unit) {
+        if (arg.size() <= unit.size() || arg.substr(arg.size() - unit.size()) != unit) return false;
+        arg.remove_suffix(unit.size());
+        return true;
+    };
+    if (hasUnit("ms")) scale = 1e6;
+    else if (hasUnit("s")) scale = 1e9;
+    else if (hasUnit("m")) scale = 60e9;
+    else if (hasUnit("h")) scale = 3600e9;
+    double v = 0;
+    if (!parseReal(arg, v) || !(v >= 0) || v * scale > 365 * 86400e9) return false;
+    d = std::chrono::nanoseconds{static_cast<std::int64_t>(v * scale)};
+    return true;
+}
+
+/**
+ * @brief Turn a quoted or bare argument into text, without the gap set_text adds.
+ *
+ * Surrounding quotes are removed (so the text may start or end with
+ * blanks) and a literal "\n" starts a new row.
+ *
+ * @param txt Receives the text (a string of any allocator).
+ * @param arg The raw argument.
+ */
+template <typename Out>
+void appendEscapedText(Out& txt, std::string_view arg) {
+    arg = trimView(arg);
+    if (arg.size() >= 2 && ((arg.front()=='"' && arg.back()=='"') ||
+                            (arg.front()=='\'' && arg.back()=='\''))) {
+        arg = arg.substr(1, arg.size()-2);
+    }
+
+    for (std::size_t i = 0; i < arg.size(); ++i) {
+        if (arg[i] == '\\' && i + 1 < arg.size() && arg[i + 1] == 'n') {
+            txt += '\n';
+            ++i;
+        } else {
+            txt += arg[i];
+        }
+    }
+}
+
+/**
+ * @brief Turn a set_text style argument into marquee text.
+ *
+ * As appendEscapedText, then a gap is added after the text.
+ *
+ * @param txt Receives the text (a string of any allocator).
+ * @param arg The raw argument.
+ */
+template <typename Out>
+void appendMarqueeText(Out& txt, std::string_view arg) {
+    appendEscapedText(txt, arg);
+
+    // Add a gap at the end of the marquee text
+    constexpr int GAP = 1; // can be adjusted by dev
+    txt.append(GAP, ' ');
+}
+
+/**
+ * @brief Append a non-negative integer in decimal.
+ * @param out Any string-like sink with append(std::string_view).
+ * @param v Value to print.
+ */
+template <typename Out>
+void appendNumber(Out& out, std::uint64_t v) {
+    char buf[24];
+    char* end = std::to_chars(buf, buf + sizeof buf, v).ptr;
+    out.append(std::string_view{buf, static_cast<std::size_t>(end - buf)});
+}
+
+/**
+ * @brief Append a real number in its shortest round-trip form (e.g. "2.5").
+ * @param out Any string-like sink with append(std::string_view).
+ * @param v Value to print.
+ */
+template <typename Out>
+void appendReal(Out& out, double v) {
+    char buf[32];
+    char* end = std::to_chars(buf, buf + sizeof buf, v).ptr;
+    out.append(std::string_view{buf, static_cast<std::size_t>(end - buf)});
+}
+
+/**
+ * @brief Append a real number with a fixed number of decimal places (e.g. "59.9").
+ * @param out Any string-like sink with append(std::string_view).
+ * @param v Value to print.
+ * @param digits Decimal places.
+ */
+template <typename Out>
+void appendFixed(Out& out, double v, int digits) {
+    char buf[32];
+    char* end = std::to_chars(buf, buf + sizeof buf, v, std::chars_format::fixed, digits).ptr;
+    out.append(std::string_view{buf, static_cast<std::size_t>(end - buf)});
+}
+
+/**
+ * @brief Append a duration rounded to the unit that reads best ("250 ms", "1.5 s", "12 m").
+ * @param out Any string-like sink with append(std::string_view).
+ * @param d Duration to print.
+ */
+template <typename Out>
+void appendDuration(Out& out, std::chrono::nanoseconds d) {
+    const double ms = std::chrono::duration<double, std::milli>(d).count();
+    if (ms < 1000)            { appendNumber(out, static_cast<std::uint64_t>(ms));            out.append(" ms"); }
+    else if (ms < 60000)      { appendReal(out, std::round(ms / 100) / 10);                   out.append(" s"); }
+    else if (ms < 3600000)    { appendReal(out, std::round(ms / 6000) / 10);                  out.append(" m"); }
+    else                      { appendReal(out, std::round(ms / 360000) / 10);                out.append(" h"); }
+}
+
+/**
+ * @brief Append a short wait or hold time in whole ns, us or ms ("950 ns", "12 us", "3 ms").
+ * @param out Any string-like sink with append(std::string_view).
+ * @param ns Nanoseconds to print.
+ */
+template <typename Out>
+void appendShortDuration(Out& out, std::uint64_t ns) {
+    if (ns < 10000)           { appendNumber(out, ns);                                         out.append(" ns"); }
+    else if (ns < 10000000)   { appendNumber(out, ns / 1000);                                  out.append(" us"); }
+    else                      { appendNumber(out, ns / 1000000);                               out.append(" ms"); }
+}
@@ -0,0 +1,63 @@
+/**
+ * @file CommandFeedback.hpp
+ * @brief Painting a command's echo and feedback above the prompt (shared by the *Commands.cpp files).
+ */
+
+#pragma once
+
+#include "Context.hpp"
+#include "FrameScheduler.hpp"
+#include <memory_resource>
+#include <string>
+#include <string_view>
+
+/**
+ * @brief Paint one console update so that lines are displayed in the correct order.
+ *
+ * The feedback is composed in scratch memory and handed to the frame
+ * scheduler, which folds it into its next composed write:
+ * - remove the previous status and marquee lines above the prompt (leaving one blank line),
+ * - echo the command line (>...),
+ * - print feedback (up to several lines may be printed by the writer),
+ * - print the status line and one marquee line (a snapshot or a blank one),
+ * - save a new anchor and print a new prompt.
+ *
+ * The feedback writer is a template parameter rather than a std::function so
+ * that capturing lambdas never need to be boxed on the heap. Feedback is
+ * never dropped, even when the terminal is lagging.
+ *
+ * @param ctx Shared context (shared state and sync).
+ * @param mr Scratch memory for the composed feedback (the per-command arena).
+ * @param enteredLine The typed command (which we echo).
+ * @param feedbackWriter Callable that appends comments to a std::pmr::string.
+ */
+template <typename FeedbackWriter>
+void paintEchoFeedbackMarqueePrompt(
+    MarqueeContext& ctx,
+    std::pmr::memory_resource* mr,
+    std::string_view enteredLine,
+    FeedbackWriter&& feedbackWriter)
+{
+  std::pmr::string out{mr};
+  out.reserve(512);
+
+  // Comments (may be more than one line). Lines should be ended with '\n'.
+  feedbackWriter(out);
+
+  ctx.screen->submitFeedback(enteredLine, out);
+}
+
+/**
+ * @brief Use the paint sequence to print a single feedback line.
+ * @param ctx The shared context.
+ * @param mr Scratch memory for the paint helper.
+ * @param enteredLine The command that we are responding to.
+ * @param msg One-line message; we include the newline at the end.
+ */
+inline void paintMessage(MarqueeContext& ctx, std::pmr::memory_resource* mr,
+                        std::string_view enteredLine, std::string_view msg) {
+  paintEchoFeedbackMarqueePrompt(ctx, mr, enteredLine, [&](std::pmr::string& out){
+    out += msg;
+    out += "\n";
+  });
+}
@@ -5,8 +5,8 @@
  *
  *
  * Maintains a consistent console layout to prevent lines from interleaving with the
- * marquee. By locking the cout mutex, the program ensures to print one line at a time.
- * Before drawing, it always jumps back to a saved spot of the prompt.
+ * marquee. Feedback is handed to the FrameScheduler, which writes it together with
+ * the next marquee frame. Drawing always starts from the saved spot of the prompt.
  *
  * The format of the printed output is as follows:
  *
@@ -15,299 +15,233 @@
  *
  * > current_command
  * Current feedback message
+ * [status] (one line; refreshed by the display thread)
  * marquee (one line; this is updated above the prompt by the display thread)
  * > new_prompt (to be entered)
  *
  * We consistently:
  * 1) return to the prompt anchor,
- * 2) remove the previous marquee line, which is located directly above the prompt.
+ * 2) remove the previous status and marquee lines, which are located directly above the prompt.
  * 3) echo the command that was entered,
  * 4) Print the comments,
- * 5) Print a new marquee line (snapshot or blank).
+ * 5) Print the last status line and a new marquee line (snapshot or blank).
  * 6) Save a new anchor and print a fresh prompt.
+ *
+ * This file is the queue and the dispatch; each family of console commands
+ * (sinks, recording, jitter, timers, playlist, follow, locks, stats) is
+ * parsed and reported in its own *Commands.cpp.
  */
 
 #include "CommandHandler.hpp"
-#include <sstream>
-#include <iostream>
-#include <algorithm>
-#include <iomanip>
-#include <functional>
-#include <cctype>
-
-/**
- * @brief Safely lowercase a string (manages signed characters).
- * @param s String for in-place modification.
- */
-static void toLowerInPlace(std::string& s) {
-  for (auto& ch : s) {
-    ch = static_cast<char>(std::tolower(static_cast<unsigned char>(ch)));
-  }
-}
+#include "CommandArgs.hpp"
+#include "CommandFeedback.hpp"
+#include "PlaylistHandler.hpp"
 
 /**
  * @brief Add a command to the consumer loop's queue.
  * @param cmd Enqueue command line.
  */
-void CommandHandler::enqueue(std::string cmd) {
+void CommandHandler::enqueue(std::string_view cmd) {
+  if (channel) {  // coroutine runtime: same thread, no lock
+    channel->push(std::string{cmd});
+    return;
+  }
   {
-    std::lock_guard<std::mutex> lk(queueMutex);
-    commandQueue.push(std::move(cmd));
+    std::lock_guard<ProfiledMutex> lk(queueMutex);
+    commandQueue.emplace(cmd);  // the deque hands queuePool to the new string
+    ctx.metrics.queueDepth.store(commandQueue.size(), std::memory_order_relaxed);
   }
   queueCv.notify_one();
 }
 
 /**
  * @brief The help menu consists of the available commands and their descriptions.
- * @param os Output stream (often std::cout).
- */
-static void writeHelpUnlocked(std::ostream& os) {
-  os << "Commands:\n"
-     << "  help                              - shows the commands and their descriptions\n"
-     << "  start_marquee                     - starts the animation of the marquee\n"
-     << "  stop_marquee                      - stops the animation of the marquee\n"
-     << "  set_text <text>                   - sets the text of the marquee\n"
-     << "  set_speed <ms>                    - sets the refresh rate in milliseconds\n"
-     << "  exit                              - exits the program\n"
-     << "  (aliases) mqa=start_marquee, mqo=stop_marquee, mqt=set_text, mqs=set_speed\n";
-
-}
-
-/**
- * @brief Paint one console update so that lines are displayed in the correct order.
- *
- * Procedures (all with ctx.coutMutex held):
- * - remove the previous marquee line, which is one row above the prompt.
- * - echo the command line (>...),
- * - print feedback (up to several lines may be printed by the writer),
- * - print one marquee line (a snapshot or a blank one),
- * - save a new anchor and print a new prompt.
- *
- * @param ctx Shared context (shared state and sync).
- * @param enteredLine The typed command (which we echo).
- * @param feedbackWriter Function that adds comments to the stream (may be empty).
+ * @param out Any string-like sink with append(std::string_view).
  */
-static void paintEchoFeedbackMarqueePrompt(
-    MarqueeContext& ctx,
-    const std::string& enteredLine,
-    const std::function<void(std::ostream&)>& feedbackWriter)
-{
-  // Grab a snapshot of the current text on the marquee (short lock to avoid blocking long prints).
-  std::string marqueeNow;
-  {
-    std::lock_guard<std::mutex> g(ctx.textMutex);
-    marqueeNow = ctx.marqueeText;
-  }
-  const bool showMarquee = ctx.isMarqueeActive();
-
-  // Ensure that nothing interferes with the display output.
-  std::lock_guard<std::mutex> lock(ctx.coutMutex);
-
-  // Always follows the prompt anchor that has been saved.
-  std::cout << "\x1b[u";                       // back to prompt anchor
-
-  // >>> DISPLAY SEQUENCE
-
-  // (1) Removes the previous marquee line, which is located directly above the prompt.
-  std::cout << "\x1b[1F"                       // go up 1 row
-            << "\r\x1b[2K";                    // clear the row
-
-  // (2) The command that was entered is echoed on the prompt line.
-  std::cout << "\x1b[u"                        // back to prompt
-            << "\r\x1b[2K> " << enteredLine    // print "> command"
-            << "\n";
-
-  // (3) Comments (may be more than one line). Lines should be ended with '\n'.
-  if (feedbackWriter) feedbackWriter(std::cout);
-
-  // (4) New marquee line. To maintain consistency in layout, leave it blank if it's not running.
-  if (showMarquee) {
-    std::cout << "\x1b[2K" << marqueeNow << "\n";
-  } else {
-    std::cout << "\x1b[2K" << "\n";
-  }
-
-  // (5) Create a new prompt and save a new anchor so that it can be targeted by the keyboard or display.
-  std::cout << "\x1b[2K> "
-            << "\x1b[s"                        // save new prompt anchor
-            << std::flush;
-
-  ctx.setHasPromptLine(true);
-}
-
-/**
- * @brief Use the paint sequence to print a single feedback line.
- * @param ctx The shared context.
- * @param enteredLine The command that we are responding to.
- * @param msg One-line message; we include the newline at the end.
- */ 
-static void paintMessage(MarqueeContext& ctx, const std::string& enteredLine, const std::string& msg) {
-  paintEchoFeedbackMarqueePrompt(ctx, enteredLine, [&](std::ostream& os){
-    os << msg << "\n";
-  });
+template <typename Out>
+static void writeHelpUnlocked(Out& out) {
+  out.append("Commands:\n"
+             "  help                              - shows the commands and their descriptions\n"
+             "  start_marquee                     - starts the animation of the marquee\n"
+             "  stop_marquee                      - stops the animation of the marquee\n"
+             "  set_text <text>                   - sets the text of the marquee (\\n starts a new row)\n"
+             "  append_text <text>                - adds text at the end, without restarting the scroll\n"
+             "  insert_text <pos> <text>          - inserts text at byte pos\n"
+             "  delete_range <a> <b>              - deletes bytes a to b (b not included)\n"
+             "  replace_range <a> <b> <text>      - replaces bytes a to b with text\n"
+             "                                      (each edit: O(log n) plus at most 64 KiB of plain rows rebuilt;\n"
+             "                                       a styled text rebuilds the edited rows, or all if the width changes)\n"
+             "  set_speed <ms>                    - sets the refresh rate in milliseconds (one column per frame)\n"
+             "  set_fps <hz>                      - sets the refresh rate only (up to 1000 fps)\n"
+             "  set_velocity <cols/s>             - sets the scroll velocity only, in columns per second\n"
+             "  set_mode <motion>                 - scrolls left, right, bounce or vertical\n"
+             "  set_effect <effect> [word]        - none, rainbow, gradient, words or highlight <word>\n"
+             "  lane add <text>                   - adds a lane under the marquee (up to 8 lanes)\n"
+             "  lane set_text|set_speed|set_mode <n> <value> - changes lane n (0 is the main marquee)\n"
+             "  lane remove <n> | lane list       - removes lane n, or lists the lanes\n"
+             "  sink add <fifo:path|file:path>    - mirrors the console to a FIFO or file\n"
+             "  sink remove <id> | sink list      - stops a mirror, or lists them\n"
+             "  record <file> | record stop       - records the session as an asciicast v2 file\n"
+             "  stats                             - shows output counters (frames, drops, stalls) and CPU use\n"
+             "  jitter [reset]                    - shows how late the display thread wakes (histogram)\n"
+             "  locks [name|reset]                - shows lock contention per thread (profiling builds)\n"
+             "  at <HH:MM[:SS]|+delay> <command>  - runs a command at a local time or after a delay (e.g. +90s)\n"
+             "  every <interval> <command>        - runs a command repeatedly (e.g. 500ms, 10s, 5m, 1h)\n"
+             "  timers | cancel <id|all>          - lists the scheduled commands, or cancels them\n"
+             "  playlist add <text> | add_file <path> - prepares a text or art file for the playlist\n"
+             "  playlist rotate <cycles|interval> - rotates after N full cycles (e.g. 3) or a time (e.g. 30s)\n"
+             "  playlist start|stop|next|list|clear - runs, pauses, skips, shows or empties the playlist\n"
+             "  follow <path> | follow stop       - appends what is written to a file to the marquee, or stops\n"
+             "  follow                            - shows the followed file, bytes read and update latency\n"
+             "  exit                              - exits the program\n"
+             "  (aliases) mqa=start_marquee, mqo=stop_marquee, mqt=set_text, mqs=set_speed\n");
 }
 
 /**
  * @brief Print the thread-safe help menu whenever needed.
  */
 void CommandHandler::printHelp() {
-  std::lock_guard<std::mutex> lock(ctx.coutMutex);
-  writeHelpUnlocked(std::cout);
-  std::cout.flush();
+  commandArena.reset();
+  std::pmr::string out{commandArena.resource()};
+  writeHelpUnlocked(out);
+  ctx.screen->emitNow({out});
 }
 
 /**
  * @brief Call the appropriate operation after parsing one line.
  *
  * Flow:
- * - divide the command keyword from the argument/s next to it (if any),
- * - lowercase the command (to allow case insensitivity),
- * - find the appropriate action associated with the command.
+ * - let the CommandProcessor split, lowercase and expand the line, and run
+ *   it if it is a marquee command (its feedback is painted as-is),
+ * - otherwise find the console command (help, exit, sink, record, stats, ...).
  * To ensure that outputs (e.g., feedback) do not interfere with the
  * marquee's animation/placement, it draw the outputs using the atomic paint helper func.
  *
+ * Everything temporary lives in commandArena, which operator() rewinds
+ * before each command.
+ *
  * @param line The user's entire input line.
 */
-void CommandHandler::handleCommand(const std::string& line) {
-  // Split "cmd args"
-  auto first_space = line.find_first_of(" \t");
-  std::string cmd  = (first_space == std::string::npos) ? line : line.substr(0, first_space);
-  std::string rest = (first_space == std::string::npos) ? std::string{} : line.substr(first_space + 1);
-  toLowerInPlace(cmd);
+void CommandHandler::handleCommand(std::string_view line) {
+  std::pmr::memory_resource* mr = commandArena.resource();
+
+  // The marquee commands themselves live in the engine's CommandProcessor.
+  const CommandResult r = processor.execute(line, mr);
+  const std::string_view cmd = r.command;
+  const std::string_view rest = r.args;
+  line = r.echo;
+
+  if (r.handled()) {
+    if (cmd == "set_effect" && r.status == CommandResult::Status::Done) {
+      ctx.metrics.framesPresented.store(0, std::memory_order_relaxed);  // report the new effect on its own
+      ctx.metrics.frameBytes.store(0, std::memory_order_relaxed);
+      ctx.metrics.sgrBytes.store(0, std::memory_order_relaxed);
+      ctx.playlist->effectChanged(ctx.getPrepared()->effect());  // its items are prepared again ahead of their turn
+    }
+    ctx.screen->submitFeedback(line, r.feedback);
+    return;
+  }
 
   // >>> HELP
   if (cmd == "help") {
-    paintEchoFeedbackMarqueePrompt(ctx, line, [&](std::ostream& os){
-      writeHelpUnlocked(os);
+    paintEchoFeedbackMarqueePrompt(ctx, mr, line, [](std::pmr::string& out){
+      writeHelpUnlocked(out);
     });
     return;
   }
 
   // >>> EXIT (after this, we don’t print a new prompt)
   if (cmd == "exit") {
-    {
-      std::lock_guard<std::mutex> lock(ctx.coutMutex);
-      std::cout << "\x1b[u"
-                << "\r\x1b[2K> " << line << "\n"
-                << "Exiting...\n"
-                << std::flush;
-    }
-    ctx.exitRequested.store(true);
-    queueCv.notify_all();
+    ctx.screen->emitNow({"\x1b[u\r\x1b[2K> ", line, "\n", "Exiting...\n"});
+    ctx.requestExit();  // the console stops every handler from here
     return;
   }
 
-  // >>> START
-  if (cmd == "start_marquee") {
-    if (display) display->start();
-    ctx.runHandler();
-    paintMessage(ctx, line, "Marquee started.");
+  // >>> MIRROR SINKS
+  if (cmd == "sink") {
+    handleSink(line, rest);
     return;
   }
 
-  // >>> STOP
-  if (cmd == "stop_marquee") {
-    if (display) display->stop();
-    ctx.pauseHandler();
-    paintMessage(ctx, line, "Marquee stopped.");
+  // >>> SESSION RECORDING
+  if (cmd == "record") {
+    handleRecord(line, rest);
     return;
   }
 
-  // >>> SET SPEED
-  if (cmd == "set_speed") {
-    auto trim = [](std::string s){
-      auto l = s.find_first_not_of(" \t");
-      auto r = s.find_last_not_of(" \t");
-      if (l == std::string::npos) return std::string{};
-      return s.substr(l, r - l + 1);
-    };
-    std::string arg = trim(rest);
-    int ms = -1;
-    if (!arg.empty()) {
-      std::istringstream iss(arg);
-      iss >> ms;
-    }
-    if (ms >= 0) {
-      if (ms < 10) ms = 10;
-      ctx.speedMs.store(ms);
-      paintMessage(ctx, line, "Speed set to " + std::to_string(ms) + " ms.");
-    } else {
-      paintMessage(ctx, line, "Usage: set_speed <ms>");
-    }
+  // >>> WAKEUP JITTER
+  if (cmd == "jitter") {
+    handleJitter(line, rest);
     return;
   }
 
-  // SET TEXT
-  if (cmd == "set_text") {
-    auto trimQuotes = [](std::string s) {
-      auto l = s.find_first_not_of(" \t");
-      auto r = s.find_last_not_of(" \t");
-      if (l == std::string::npos) return std::string{};
-      s = s.substr(l, r - l + 1);
-      if (s.size() >= 2 && ((s.front()=='"' && s.back()=='"') ||
-                            (s.front()=='\'' && s.back()=='\''))) {
-        s = s.substr(1, s.size()-2);
-      }
-      return s;
-    };
-
-    std::string txt = trimQuotes(rest);
-
-    // Add a gap at the end of the marquee text
-    constexpr int GAP = 1; // can be adjusted by dev
-    txt += std::string(GAP, ' ');
-
-    ctx.setText(txt);
-    paintMessage(ctx, line, "Text updated.");
+  // >>> SCHEDULED COMMANDS
+  if (cmd == "at" || cmd == "every" || cmd == "timers" || cmd == "cancel") {
+    handleTimer(line, cmd, rest);
     return;
   }
 
-
-
-  // >>> ALIASES
-
-  // e = enable, d = disable, t = text, s = speed
-  if (cmd == "mqa") {                            // start_marquee
-    return handleCommand("start_marquee");
+  // >>> PLAYLIST
+  if (cmd == "playlist") {
+    handlePlaylist(line, rest);
+    return;
   }
-  if (cmd == "mqo") {                            // stop_marquee
-    return handleCommand("stop_marquee");
+
+  // >>> FILE FEED
+  if (cmd == "follow") {
+    handleFollow(line, rest);
+    return;
   }
-  if (cmd == "mqt") {                            // set_text <text>
-    return handleCommand("set_text " + rest);
+
+  // >>> LOCK PROFILES
+  if (cmd == "locks") {
+    handleLocks(line, rest);
+    return;
   }
-  if (cmd == "mqs") {                            // set_speed <ms>
-    return handleCommand("set_speed " + rest);
+
+  // >>> OUTPUT STATS
+  if (cmd == "stats") {
+    handleStats(line);
+    return;
   }
 
   // Unknown command
-  paintMessage(ctx, line, "Unknown command. Type 'help'.");
+  paintMessage(ctx, mr, line, "Unknown command. Type 'help'.");
 }
 
 /**
- * @brief Waits for commands and runs them until we’re told to exit.
+ * @brief Waits for commands and runs them until we’re told to stop.
  *
  * Waiting logic:
  *  - If the queue is empty, we wait on queueCv.
- *  - Wakes up when someone enqueues a command or when exit is requested.
+ *  - Wakes up when someone enqueues a command or when stop is requested.
  *  - Pops one command at a time and pass it to handleCommand().
  */
-void CommandHandler::operator()() {
-
-  // >>> JOIN INIT PHASE
-  ctx.phase_barrier.arrive_and_wait();
-
-  while (!ctx.exitRequested.load()) {
-    std::string command;
+void CommandHandler::operator()(std::stop_token stop) {
+  while (!stop.stop_requested()) {
+    std::pmr::string command{&queuePool};
     {
-      std::unique_lock<std::mutex> lock(queueMutex);
-      queueCv.wait(lock, [&]{ return !commandQueue.empty() || ctx.exitRequested.load(); });
-      if (ctx.exitRequested.load()) break;
+      std::unique_lock<ProfiledMutex> lock(queueMutex);
+      if (!queueCv.wait(lock, stop, [&]{ return !commandQueue.empty(); })) break;  // stop requested
       command = std::move(commandQueue.front());
       commandQueue.pop();
+      ctx.metrics.queueDepth.store(commandQueue.size(), std::memory_order_relaxed);
     }
+    commandArena.reset();
     handleCommand(command);
   }
+}
 
-  ctx.stop_latch.count_down();
+/**
+ * @brief Runs commands from the event loop's channel until we're told to exit.
+ */
+CoroTask CommandHandler::runCoroutine(EventLoop& loop) {
+  channel.emplace(loop);
+  while (!ctx.exitRequested.load()) {
+    std::optional<std::string> command = co_await channel->pop();
+    if (!command) break;  // loop is stopping
+    ctx.metrics.queueDepth.store(channel->size(), std::memory_order_relaxed);
+    commandArena.reset();
+    handleCommand(*command);
+  }
 }
@@ -3,8 +3,8 @@
  * @brief Simple command runner for the marquee console.
  *
  * This class reads command strings from a queue (usually pushed by the keyboard
- * thread) and runs them. It communicates with the display handler (for starting/stopping
- * the marquee).
+ * thread) and runs them. The marquee commands go to a CommandProcessor over the
+ * shared state; the console's own commands (help, exit, stats, ...) are handled here.
  *
  * Commands from the spec:
  *   - help
@@ -13,17 +13,36 @@
  *   - stop_marquee
  *   - set_speed <ms>
  *   - set_text <text>
+ *
+ * Extras:
+ *   - set_fps <hz>, set_velocity <cols/s> (refresh rate and scroll velocity, independently)
+ *   - set_mode <left|right|bounce|vertical> (scroll policy)
+ *   - set_effect <none|rainbow|gradient|words|highlight <word>> (colour effects)
+ *   - lane add|list|remove|set_text|set_speed|set_mode (stacked marquee lanes)
+ *   - sink add|remove|list (mirror the console to FIFOs and files)
+ *   - record <file> | record stop (asciicast v2 session recording)
+ *   - at <HH:MM[:SS]|+delay> <command>, every <interval> <command>, timers, cancel <id|all> (scheduled commands)
+ *   - playlist add|add_file|rotate|start|stop|next|list|clear (texts prepared ahead, shown in turn)
+ *   - follow <path> | follow stop | follow (feed the marquee from a file as it grows)
+ *   - stats (terminal output counters)
  */
 
 #pragma once
 
+#include "CommandProcessor.hpp"
 #include "Context.hpp"
-#include "DisplayHandler.hpp"
+#include "CoroRuntime.hpp"
+#include "FrameArena.hpp"
 
 #include <condition_variable>
+#include <deque>
+#include <memory_resource>
 #include <mutex>
+#include <optional>
 #include <queue>
+#include <stop_token>
 #include <string>
+#include <string_view>
 #include <thread>
 #include <vector>
 
@@ -33,9 +52,11 @@
  *
  * Usage:
  *  - Construct with a shared MarqueeContext.
- *  - Hook up the DisplayHandler.
- *  - Run operator() on its own thread; blocks on a condition variable when idle.
+ *  - Run operator() on its own thread; blocks on a condition variable when idle,
+ *    and a stop request wakes it.
  *  - Call enqueue() from any producer (like the keyboard thread).
+ *  - Or, under the coroutine runtime, run runCoroutine() on the event loop;
+ *    enqueue() then feeds its channel (from the loop's thread only).
  */
 class CommandHandler : public Handler {
 public:
@@ -44,53 +65,109 @@ public:
      * @param c Shared MarqueeContext with all the shared flags, locks, etc.
      */
     explicit CommandHandler(MarqueeContext& c) 
-        : Handler(c), display(nullptr) {
+        : Handler(c), processor(c) {
     }
 
     /**
      * @brief Main loop that waits for commands and executes them.
      *
      * Blocks on a condition variable when the queue is empty. Exits when
-     * ctx.exitRequested becomes true.
+     * stop is requested, even in the middle of that wait.
      */
-    void operator()(); // consumer loop
+    void operator()(std::stop_token stop); // consumer loop
 
     /**
-     * @brief Provide a pointer to the display handler so we can start/stop the marquee.
-     * @param d DisplayHandler to use (can be nullptr to detach).
+     * @brief The consumer loop as a coroutine for the single-threaded runtime.
+     *
+     * Pops lines from its channel until the loop stops or exit is
+     * requested. A command runs to completion on the loop, so a long one
+     * (a large playlist add_file) holds the marquee still while it runs.
+     *
+     * @param loop The loop to wait on.
      */
-    void addDisplayHandler(DisplayHandler* d) {
-        display = d;  // nothing fancy here
-    }
+    CoroTask runCoroutine(EventLoop& loop);
 
     /**
      * @brief Push a new command line into the queue.
      *
-     * Thread-safe. Multiple threads can call this at the same time.
+     * Thread-safe. Multiple threads can call this at the same time
+     * (under the coroutine runtime, only coroutines of the loop).
+     * The line is copied into pooled storage, so the caller keeps its buffer.
      *
      * @param cmd Raw command, e.g. "set_speed 120".
      */
-    void enqueue(std::string cmd);
+    void enqueue(std::string_view cmd);
 
 private:
 
     // >>> QUEUE STATE
 
-    std::mutex queueMutex;                  // Protects access to the queue.
-    std::condition_variable queueCv;        // Signals the consumer that there is work to do (or we are exiting)
-    std::queue<std::string> commandQueue;   // Ensure command strings follow FIFO
+    ProfiledMutex queueMutex{"queueMutex"}; // Protects access to the queue.
+    std::condition_variable_any queueCv;    // Signals the consumer that there is work to do (stop requests wake it too)
+    std::pmr::synchronized_pool_resource queuePool;    // Recycles the storage of queued command strings
+    std::queue<std::pmr::string, std::pmr::deque<std::pmr::string>> commandQueue{
+        std::pmr::deque<std::pmr::string>{&queuePool}};  // Ensure command strings follow FIFO
+    std::optional<CoroChannel<std::string>> channel;   // Replaces the queue under the coroutine runtime
+
+    // >>> LIMITS
+
+    static constexpr std::size_t kMaxArtFileBytes = std::size_t{1} << 20;  // playlist add_file limit
+
+    // >>> SCRATCH
+
+    FrameArena<2048> commandArena;          // Per-command scratch, rewound before each command
+
+    // >>> MARQUEE COMMANDS
 
-    // >>> POINTERS TO BE CALLED
+    CommandProcessor processor;       // Runs the commands that change the marquee state
 
-    DisplayHandler* display;          // Display handler used to start/stop marquee
+    // >>> HELPERS (each family of console commands is in its own *Commands.cpp)
 
-    // >>> HELPERS
-    
     /**
      * @brief Parse one command line and do the action.
      * @param line Full command line including any arguments.
      */
-    void handleCommand(const std::string& line);  // Note: might split this up later
+    void handleCommand(std::string_view line);
+
+    /**
+     * @brief Parse and run a "sink ..." command.
+     */
+    void handleSink(std::string_view line, std::string_view rest);
+
+    /**
+     * @brief Parse and run a "record ..." command.
+     */
+    void handleRecord(std::string_view line, std::string_view rest);
+
+    /**
+     * @brief Parse and run a "jitter ..." command.
+     */
+    void handleJitter(std::string_view line, std::string_view rest);
+
+    /**
+     * @brief Parse and run an "at", "every", "timers" or "cancel" command.
+     */
+    void handleTimer(std::string_view line, std::string_view cmd, std::string_view rest);
+
+    /**
+     * @brief Parse and run a "playlist ..." command.
+     */
+    void handlePlaylist(std::string_view line, std::string_view rest);
+
+    /**
+     * @brief Parse and run a "follow ..." command.
+     */
+    void handleFollow(std::string_view line, std::string_view rest);
+
+    /**
+     * @brief Parse and run a "locks ..." command.
+     */
+    void handleLocks(std::string_view line, std::string_view rest);
+
+    /**
+     * @brief Run the "stats" command.
+     */
+    void handleStats(std::string_view line);
 
     /**
      * @brief Print the help text with the supported commands.
@@ -0,0 +1,338 @@
+/**
+ * @file CommandProcessor.cpp
+ * @brief The marquee commands, applied to a MarqueeState.
+ */
+
+#include "CommandProcessor.hpp"
+#include "CommandArgs.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+
+/**
+ * @brief Set the outcome and a one-line message.
+ */
+static void reply(CommandResult& r, CommandResult::Status status, std::string_view msg) {
+    r.status = status;
+    r.feedback += msg;
+    r.feedback += "\n";
+}
+
+/**
+ * @brief Split the keyword off, expand aliases, then find the command.
+ */
+CommandResult CommandProcessor::execute(std::string_view line, std::pmr::memory_resource* mr) const {
+    using Status = CommandResult::Status;
+    CommandResult r{mr};
+
+    // Split "cmd args"
+    const auto first_space = line.find_first_of(" \t");
+    r.command.assign(line.substr(0, first_space));
+    r.args = (first_space == std::string_view::npos) ? std::string_view{} : line.substr(first_space + 1);
+    toLowerInPlace(r.command);
+    r.echo.assign(line);
+
+    // >>> ALIASES
+
+    // Aliases are rewritten to their full command and echoed that way.
+    auto expand = [&](std::string_view full) {
+        r.command.assign(full);
+        r.echo.assign(full);
+        if (!r.args.empty()) {
+            r.echo += ' ';
+            r.echo += r.args;
+        }
+    };
+    if (r.command == "mqa") expand("start_marquee");
+    else if (r.command == "mqo") expand("stop_marquee");
+    else if (r.command == "mqt") expand("set_text");
+    else if (r.command == "mqs") expand("set_speed");
+
+    const std::string_view cmd = r.command;
+    const std::string_view rest = r.args;
+
+    // >>> START
+    if (cmd == "start_marquee") {
+        st.startMarquee();
+        reply(r, Status::Done, "Marquee started.");
+        return r;
+    }
+
+    // >>> STOP
+    if (cmd == "stop_marquee") {
+        st.stopMarquee();
+        reply(r, Status::Done, "Marquee stopped.");
+        return r;
+    }
+
+    // >>> SET SPEED (one column per frame, as before: sets both refresh rate and velocity)
+    if (cmd == "set_speed") {
+        std::string_view arg = trimView(rest);
+        if (!arg.empty() && arg.front() == '+') arg.remove_prefix(1);
+        int ms = -1;
+        if (!arg.empty()) {
+            std::from_chars(arg.data(), arg.data() + arg.size(), ms);
+        }
+        if (ms < 0) {
+            reply(r, Status::Usage, "Usage: set_speed <ms>");
+            return r;
+        }
+        if (ms < 1) ms = 1;
+        st.setFrameInterval(std::chrono::milliseconds(ms));
+        st.setVelocity(1000.0 / ms);
+        r.status = Status::Done;
+        r.feedback += "Speed set to ";
+        appendNumber(r.feedback, static_cast<std::uint64_t>(ms));
+        r.feedback += " ms.\n";
+        return r;
+    }
+
+    // >>> SET FPS (refresh rate only; the text keeps its velocity)
+    if (cmd == "set_fps") {
+        double fps = 0;
+        if (!parseReal(trimView(rest), fps) || !(fps > 0)) {
+            reply(r, Status::Usage, "Usage: set_fps <frames per second>");
+            return r;
+        }
+        fps = std::min(fps, kMaxFps);
+        st.setFrameInterval(std::chrono::nanoseconds(static_cast<std::int64_t>(1e9 / fps)));
+        r.status = Status::Done;
+        r.feedback += "Refresh rate set to ";
+        appendReal(r.feedback, fps);
+        r.feedback += " fps.\n";
+        return r;
+    }
+
+    // >>> SET VELOCITY (columns per second, independent of the refresh rate)
+    if (cmd == "set_velocity") {
+        double cps = -1;
+        if (!parseReal(trimView(rest), cps) || !(cps >= 0)) {
+            reply(r, Status::Usage, "Usage: set_velocity <columns per second>");
+            return r;
+        }
+        cps = std::min(cps, kMaxVelocity);
+        st.setVelocity(cps);
+        r.status = Status::Done;
+        r.feedback += "Velocity set to ";
+        appendReal(r.feedback, cps);
+        r.feedback += " columns/s.\n";
+        return r;
+    }
+
+    // >>> SET MODE
+    if (cmd == "set_mode") {
+        std::pmr::string name{trimView(rest), mr};
+        toLowerInPlace(name);
+        ScrollMode mode{};
+        if (!parseScrollMode(name, mode)) {
+            r.status = Status::Usage;
+            r.feedback += "Usage: set_mode <";
+            for (std::size_t i = 0; i < kScrollModeCount; ++i) {
+                if (i) r.feedback += '|';
+                r.feedback += kScrollModeNames[i];
+            }
+            r.feedback += ">\n";
+            return r;
+        }
+        st.setScrollMode(mode);
+        r.status = Status::Done;
+        r.feedback += "Scroll mode set to ";
+        r.feedback += kScrollModeNames[static_cast<std::size_t>(mode)];
+        r.feedback += ".\n";
+        return r;
+    }
+
+    // >>> SET EFFECT
+    if (cmd == "set_effect") {
+        std::string_view args = rest;
+        std::pmr::string name{takeWord(args), mr};
+        toLowerInPlace(name);
+
+        TextEffect effect;
+        bool known = false;
+        for (std::size_t i = 0; i < kTextEffectCount; ++i) {
+            if (name == kTextEffectNames[i]) {
+                effect.kind = static_cast<TextEffectKind>(i);
+                known = true;
+            }
+        }
+        if (!known || (effect.kind == TextEffectKind::Highlight && args.empty())) {
+            reply(r, Status::Usage, "Usage: set_effect <none|rainbow|gradient|words|highlight <word>>");
+            return r;
+        }
+        effect.word.assign(args);
+
+        st.setEffect(effect);
+        r.status = Status::Done;
+        r.feedback += "Effect set to ";
+        r.feedback += kTextEffectNames[static_cast<std::size_t>(effect.kind)];
+        r.feedback += " (at most ";
+        appendNumber(r.feedback, st.getPrepared()->sgrBound());
+        r.feedback += " extra bytes per frame).\n";
+        return r;
+    }
+
+    // SET TEXT
+    if (cmd == "set_text") {
+        std::pmr::string txt{mr};
+        appendMarqueeText(txt, rest);
+        st.setText(txt);
+        reply(r, Status::Done, "Text updated.");
+        return r;
+    }
+
+    // >>> TEXT EDITS (the text scrolls on from where it is)
+    if (cmd == "append_text" || cmd == "insert_text" || cmd == "delete_range" || cmd == "replace_range") {
+        executeEdit(cmd, rest, r);
+        return r;
+    }
+
+    // >>> LANES
+    if (cmd == "lane") {
+        executeLane(rest, r);
+        return r;
+    }
+
+    return r;  // Status::Unknown: not ours
+}
+
+/**
+ * @brief Run one append_text, insert_text, delete_range or replace_range line on the main marquee.
+ *
+ * Positions are byte offsets into the text as set_text stored it ("\n"
+ * counts as one byte); ranges are half-open, [a, b). append_text adds
+ * before the gap set_text leaves at the end.
+ *
+ * @param cmd The keyword (one of the four).
+ * @param rest Everything after it.
+ * @param r Receives the outcome.
+ */
+void CommandProcessor::executeEdit(std::string_view cmd, std::string_view rest, CommandResult& r) const {
+    using Status = CommandResult::Status;
+    std::pmr::memory_resource* mr = r.feedback.get_allocator().resource();
+    const auto text = st.getPrepared();
+    const std::size_t size = text->rope().size();
+
+    std::size_t a = size;
+    bool parsed = true;
+    if (cmd == "append_text") {
+        text->rope().forEachPiece(size ? size - 1 : 0, 1, [&a](std::string_view last) {
+            if (last == " ") --a;  // before the gap
+        });
+    } else {
+        parsed = parseCount(takeWord(rest), a);
+    }
+    std::size_t b = a;
+    if (cmd == "delete_range" || cmd == "replace_range") parsed = parsed && parseCount(takeWord(rest), b);
+
+    std::pmr::string insert{mr};
+    if (cmd != "delete_range") appendEscapedText(insert, rest);
+    const bool needsText = cmd == "append_text" || cmd == "insert_text";
+    if (!parsed || (needsText && insert.empty()) || (cmd == "delete_range" && !trimView(rest).empty())) {
+        if (cmd == "append_text") reply(r, Status::Usage, "Usage: append_text <text>");
+        else if (cmd == "insert_text") reply(r, Status::Usage, "Usage: insert_text <pos> <text>");
+        else if (cmd == "delete_range") reply(r, Status::Usage, "Usage: delete_range <a> <b>");
+        else reply(r, Status::Usage, "Usage: replace_range <a> <b> <text>");
+        return;
+    }
+    if (a > b || b > size) {
+        r.status = Status::Failed;
+        r.feedback += "Range outside the text (";
+        appendNumber(r.feedback, size);
+        r.feedback += " bytes).\n";
+        return;
+    }
+
+    st.spliceLaneText(0, a, b - a, insert);
+    r.status = Status::Done;
+    r.feedback += "Text updated (";
+    appendNumber(r.feedback, st.getPrepared()->rope().size());
+    r.feedback += " bytes).\n";
+}
+
+/**
+ * @brief Run one "lane <subcommand> ..." line.
+ *
+ * Lane 0 is the main marquee (the set_* commands act on it); added lanes
+ * are stacked under it.
+ *
+ * @param rest Everything after "lane".
+ * @param r Receives the outcome.
+ */
+void CommandProcessor::executeLane(std::string_view rest, CommandResult& r) const {
+    using Status = CommandResult::Status;
+    std::pmr::memory_resource* mr = r.feedback.get_allocator().resource();
+    std::pmr::string sub{takeWord(rest), mr};
+    toLowerInPlace(sub);
+
+    // >>> LANE ADD
+    if (sub == "add") {
+        std::pmr::string txt{mr};
+        appendMarqueeText(txt, rest);
+        const double velocity = st.getLanes()->front().velocity;  // starts at the main marquee's pace
+        if (!st.addLane(txt, velocity)) {
+            reply(r, Status::Failed, "All lanes are in use.");
+            return;
+        }
+        r.status = Status::Done;
+        r.feedback += "Lane ";
+        appendNumber(r.feedback, st.getLanes()->size() - 1);
+        r.feedback += " added.\n";
+        return;
+    }
+
+    // >>> LANE LIST
+    if (sub == "list") {
+        const auto lanes = st.getLanes();
+        r.status = Status::Done;
+        for (std::size_t i = 0; i < lanes->size(); ++i) {
+            const MarqueeLane& lane = (*lanes)[i];
+            r.feedback += "Lane ";          appendNumber(r.feedback, i);
+            r.feedback += ": ";             appendReal(r.feedback, lane.velocity);
+            r.feedback += " columns/s, ";   r.feedback += kScrollModeNames[static_cast<std::size_t>(lane.mode)];
+            r.feedback += ", \"";
+            for (char ch : lane.text->source()) {
+                if (ch == '\n') r.feedback += "\\n"; else r.feedback += ch;
+            }
+            r.feedback += "\"\n";
+        }
+        return;
+    }
+
+    // The rest take a lane number.
+    std::size_t lane = 0;
+    const bool numbered = parseCount(takeWord(rest), lane);
+
+    bool done = false;
+    if (numbered && sub == "remove") {
+        done = st.removeLane(lane);
+    } else if (numbered && sub == "set_text") {
+        std::pmr::string txt{mr};
+        appendMarqueeText(txt, rest);
+        done = st.setLaneText(lane, txt);
+    } else if (numbered && sub == "set_speed") {
+        double cps = -1;
+        done = parseReal(rest, cps) && cps >= 0
+            && st.setLaneVelocity(lane, std::min(cps, kMaxVelocity));
+    } else if (numbered && sub == "set_mode") {
+        std::pmr::string name{rest, mr};
+        toLowerInPlace(name);
+        ScrollMode mode{};
+        done = parseScrollMode(name, mode) && st.setLaneMode(lane, mode);
+    } else {
+        reply(r, Status::Usage,
+              "Usage: lane add <text> | lane list | lane remove <n> | lane set_text <n> <text>"
+              " | lane set_speed <n> <cols/s> | lane set_mode <n> <motion>");
+        return;
+    }
+
+    if (!done) {
+        reply(r, Status::Failed, sub == "remove" ? "No such lane (lane 0 cannot be removed)."
+                                                 : "No such lane, or invalid value.");
+        return;
+    }
+    r.status = Status::Done;
+    r.feedback += "Lane ";
+    appendNumber(r.feedback, lane);
+    r.feedback += sub == "remove" ? " removed.\n" : " updated.\n";
+}
@@ -0,0 +1,72 @@
+/**
+ * @file CommandProcessor.hpp
+ * @brief Parses marquee command lines and applies them to a MarqueeState (no threads, no terminal).
+ */
+
+#pragma once
+
+#include "MarqueeState.hpp"
+#include <memory_resource>
+#include <string>
+#include <string_view>
+
+/** @brief What one command line did. */
+struct CommandResult {
+    enum class Status {
+        Done,     // applied to the state
+        Usage,    // malformed arguments; feedback holds the usage line
+        Failed,   // well-formed but refused (no such lane, all lanes in use)
+        Unknown,  // not a marquee command; the state is untouched
+    };
+
+    explicit CommandResult(std::pmr::memory_resource* mr = std::pmr::get_default_resource())
+        : command(mr), echo(mr), feedback(mr) {}
+
+    Status status{Status::Unknown};
+    std::pmr::string command;   // keyword, lowercased, aliases expanded
+    std::string_view args;      // everything after the keyword (a view into the line)
+    std::pmr::string echo;      // the line as it should be echoed (aliases expanded)
+    std::pmr::string feedback;  // lines for the user, each ending with '\n'
+
+    bool handled() const { return status != Status::Unknown; }
+};
+
+/**
+ * @brief The marquee command language over a MarqueeState.
+ *
+ * Covers everything that changes what the marquee shows:
+ * start_marquee, stop_marquee, set_text, append_text, insert_text,
+ * delete_range, replace_range, set_speed, set_fps, set_velocity,
+ * set_mode, set_effect, lane ... and the mqa/mqo/mqt/mqs aliases.
+ *
+ * Other keywords come back as Status::Unknown with the keyword and
+ * arguments split out, so a front end layers its own commands (help,
+ * stats, exit, ...) on top. Nothing is printed; the feedback text is
+ * returned instead.
+ *
+ * Holds no state of its own; any thread may call execute().
+ */
+class CommandProcessor {
+public:
+    static constexpr double kMaxFps = 1000.0;         // set_fps ceiling (1 ms frames)
+    static constexpr double kMaxVelocity = 10000.0;   // set_velocity ceiling, columns per second
+
+    explicit CommandProcessor(MarqueeState& state) : st(state) {}
+
+    /**
+     * @brief Run one command line.
+     * @param line Full command line including any arguments.
+     * @param mr Memory for the result's strings (e.g. a per-command arena).
+     */
+    CommandResult execute(std::string_view line,
+                          std::pmr::memory_resource* mr = std::pmr::get_default_resource()) const;
+
+private:
+    /** @brief Run an in-place text edit (append_text, insert_text, delete_range, replace_range). */
+    void executeEdit(std::string_view cmd, std::string_view rest, CommandResult& r) const;
+
+    /** @brief Run a "lane ..." line. */
+    void executeLane(std::string_view rest, CommandResult& r) const;
+
+    MarqueeState& st;
+};
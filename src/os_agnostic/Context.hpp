@@ -5,115 +5,188 @@
 
 #pragma once
 
+#include <algorithm>
+#include <array>
 #include <atomic>
-#include <barrier>
-#include <latch>
+#include <chrono>
 #include <mutex>
 #include <string>
+#include <string_view>
 #include <thread>
 #include <condition_variable>
+#include <cstddef>
+#include <cstdint>
 #include <functional>
 #include <iostream>
+#include <memory>
+#include <vector>
+
+#include "JitterHistogram.hpp"
+#include "MarqueeState.hpp"
+#include "ProfiledMutex.hpp"
+#include "../os_dependent/ProcessUsage.hpp"
+#include "../os_dependent/Terminal.hpp"
+#include "../os_dependent/ThreadTuning.hpp"
+
+class FrameScheduler;  // owns screen composition (FrameScheduler.hpp)
+class EventLoop;       // runs the handlers as coroutines (CoroRuntime.hpp)
+class HandlerRegistry; // starts and stops the handlers (HandlerRegistry.hpp)
+class TimerHandler;    // runs scheduled commands (TimerHandler.hpp)
+class PlaylistHandler; // rotates prepared texts (PlaylistHandler.hpp)
+class FollowHandler;   // feeds the marquee from a file (FollowHandler.hpp)
 
-// >>> GLOBAL PARTICIPANT COUNT
-#define NUM_MARQUEE_HANDLERS 4  // Can be increased when more threads are added.
+/**
+ * @brief The console output lock, which turns into a no-op when the console runs on one thread.
+ *
+ * Meets the Lockable requirements, so std::lock_guard and std::unique_lock
+ * work as with std::mutex. setSingleThreaded() must be called before any
+ * handler starts and is never undone.
+ */
+class ConsoleMutex {
+public:
+    void lock() { if (!single) m.lock(); }
+    void unlock() { if (!single) m.unlock(); }
+    bool try_lock() { return single || m.try_lock(); }
+
+    /** @brief Every holder runs on the calling thread from now on (coroutine runtime). */
+    void setSingleThreaded() { single = true; }
 
-// >>> BARRIER COMPLETION (kept noexcept for MSVC compatibility)
-struct PhaseCompletion {
-    void operator()() noexcept {}
+private:
+    ProfiledMutex m{"coutMutex"};
+    bool single{false};
+};
+
+/**
+ * @brief Live counters shown on the status row.
+ *
+ * Each counter is written by the thread that owns the measured activity and
+ * only read by the display thread, so relaxed atomics are enough. Each
+ * writer's group starts a cache line, so a keystroke does not evict the
+ * line the display thread is counting frames in.
+ */
+struct LiveMetrics {
+    alignas(kCacheLine) std::atomic<std::uint64_t> echoNsTotal{0};  // keystroke-to-echo time, summed (keyboard thread)
+    std::atomic<std::uint64_t> echoCount{0};    // keystrokes echoed (keyboard thread)
+    alignas(kCacheLine) std::atomic<std::size_t> queueDepth{0};     // commands waiting in CommandHandler's queue
+    alignas(kCacheLine) std::atomic<std::uint64_t> framesPresented{0}; // marquee frames handed to the screen (display thread)
+    std::atomic<std::uint64_t> frameBytes{0};      // their bytes, escape sequences included
+    std::atomic<std::uint64_t> sgrBytes{0};        // of which colour/attribute (SGR) sequences
+    std::atomic<std::uint64_t> lateFrames{0};      // frames timed below (reset on its own by record)
+    std::atomic<std::uint64_t> lateNsTotal{0};     // frame written minus frame due, summed (display thread)
+    std::atomic<std::uint64_t> lateNsMax{0};       // worst of those
+    JitterHistogram wakeJitter;                    // display tick wake minus tick deadline (display thread)
+
+    /** @brief Start the frame lateness figures over. */
+    void resetLateness() {
+        lateFrames.store(0, std::memory_order_relaxed);
+        lateNsTotal.store(0, std::memory_order_relaxed);
+        lateNsMax.store(0, std::memory_order_relaxed);
+    }
 };
 
 /**
  * @brief All marquee handlers share a thread-safe context.
  *
- * Holds console-related information, shared state flags, and synchronization primitives.
+ * Adds the console-related information, shared flags and synchronization
+ * primitives of the interactive front end to the MarqueeState it is built on.
  * CommandHandler, DisplayHandler, and possibly other components use it.
  */
-struct MarqueeContext {
+struct MarqueeContext : MarqueeState {
 public:
 
-    // >>> PHASE & SHUTDOWN SYNC
+    // >>> CONSOLE OUTPUT GUARD
+    
+    ConsoleMutex coutMutex; // Mutex to stop console writes in parallel (a no-op under the coroutine runtime).
+    Terminal terminal;    // All console output goes through here (guarded by coutMutex); never blocks on a stalled tty.
+    std::string statusLine; // Last composed [status] row text (guarded by coutMutex), reused by full repaints.
+    FrameScheduler* screen{nullptr}; // Composes every screen update (set up by MarqueeConsole).
+    HandlerRegistry* handlers{nullptr}; // Every registered handler, for on-demand starts and stats (set up by MarqueeConsole).
+    TimerHandler* timers{nullptr}; // Pending "at" and "every" commands (set up by MarqueeConsole).
+    PlaylistHandler* playlist{nullptr}; // Texts shown in turn on the main marquee (set up by MarqueeConsole).
+    FollowHandler* follower{nullptr}; // The file the main marquee follows, if any (set up by MarqueeConsole).
 
-    /** @brief Before beginning, all participating threads are synched with this barrier. */
-    std::barrier<PhaseCompletion> phase_barrier{NUM_MARQUEE_HANDLERS};
+    // >>> LIVE METRICS
 
-    /** @brief Latch (threads call count_down()) to orchestrate smooth shutdown. */
-    std::latch stop_latch{NUM_MARQUEE_HANDLERS};
+    LiveMetrics metrics;  // Fed by the handlers, shown on the status row.
 
-    // >>> RUN/PAUSE STATE (names preserved as requested)
+    // >>> GLOBAL EXIT FLAG
 
-    /** @brief Resume the handler (pause turns to false). */
-    bool pauseHandler() {
-        std::lock_guard<std::mutex> lock{mtx};
-        pause = false;
-        return pause;
-    }
+    std::atomic<bool> exitRequested{false}; // Used to alert all threads to shutdown.
 
-    /** @brief Pause the handler (pause turns to true). */
-    bool runHandler() {
-        std::lock_guard<std::mutex> lock{mtx};
-        pause = true;
-        return pause;
+    /**
+     * @brief Ask the console to shut down (any thread).
+     *
+     * The first call also records when, the start of the shutdown latency.
+     */
+    void requestExit() {
+        std::int64_t none = 0;
+        exitNs.compare_exchange_strong(none, std::chrono::steady_clock::now().time_since_epoch().count());
+        {
+            std::lock_guard<std::mutex> lock{exitMutex};
+            exitRequested.store(true);
+        }
+        exitCv.notify_all();
     }
 
-    /** @brief Verify whether the handler is running at the moment (note: true indicates paused). */
-    bool isRunning() const {
-        return pause;
+    /** @brief Block until requestExit() is called. */
+    void waitForExit() {
+        std::unique_lock<std::mutex> lock{exitMutex};
+        exitCv.wait(lock, [this] { return exitRequested.load(); });
     }
 
-    // >>> CONSOLE OUTPUT GUARD
-    
-    std::mutex coutMutex; // Mutex to stop console writes in parallel.
+    /** @brief When requestExit() was first called (the epoch if it was not). */
+    std::chrono::steady_clock::time_point exitTime() const {
+        return std::chrono::steady_clock::time_point{std::chrono::steady_clock::duration{exitNs.load()}};
+    }
 
-    // >>> GLOBAL EXIT FLAG
+    // >>> RUNTIME
 
-    std::atomic<bool> exitRequested{false}; // Used to alert all threads to shutdown.
+    const char* runtime{"threads"};  // "threads" or "coroutines" (set by MarqueeConsole before anything starts)
+    const EventLoop* loop{nullptr};  // the coroutine runtime's loop, for its counters (null under threads)
+    ProcessUsage startUsage{ProcessUsage::now()};  // baseline for the CPU and context switch rates in stats
+    std::chrono::steady_clock::time_point startTime{std::chrono::steady_clock::now()};
 
-    // >>> PROMPT & VIDEO FLAGS
+    // >>> THREAD SCHEDULING (--display-cpu, --render-cpu, --realtime)
 
-    /** @brief Configure the flag to know whether the prompt is visible. */
-    void setHasPromptLine(bool v) {
-        hasPromptLine.store(v);
-    }
+    ThreadTuning displayTuning;  // applied by the display thread (it issues every terminal write) as it starts
+    ThreadTuning renderTuning;   // applied by the render-ahead thread as it starts
 
-    /** @brief Verify whether the console prompt is visible at the moment. */
-    bool getHasPromptLine() const {
-        return hasPromptLine.load();
+    /** @brief Record what a tuned thread actually got (any thread). */
+    void reportScheduling(std::string_view thread, std::string_view applied) {
+        std::lock_guard<std::mutex> lock{schedulingMutex};
+        if (!scheduling.empty()) scheduling += "; ";
+        scheduling.append(thread).append(": ").append(applied);
     }
 
-    /** @brief Determine if the marquee is in an active display state. */
-    void setMarqueeActive(bool v) {
-        marqueeActive.store(v);
+    /** @brief Every report so far ("default" if no thread was tuned). */
+    std::string schedulingReport() const {
+        std::lock_guard<std::mutex> lock{schedulingMutex};
+        return scheduling.empty() ? std::string{"default"} : scheduling;
     }
 
-    /** @brief Verify whether the marquee is active. */
-    bool isMarqueeActive() const {
-        return marqueeActive.load();
-    }
+    // >>> PROMPT & VIDEO FLAGS
 
-    // >>> MARQUEE STATE
-    
-    std::mutex textMutex; // Lock guards the text buffer's access
-    std::string marqueeText{"Welcome to Marquee Console!"}; // Current marquee text (which may be loaded from a file or set by the user). 
-    std::atomic<int> speedMs{200}; // The marquee scroll's speed in milliseconds.
-
-    /** @brief Change the text on the marquee. */
-    void setText(const std::string &s) {
-        std::lock_guard<std::mutex> lock(textMutex);
-        marqueeText = s;
+    /**
+     * @brief Configure the flag to know whether the prompt is visible.
+     *
+     * It lives in the control block (as Control::anchored), which is only
+     * republished when the flag actually changes.
+     */
+    void setHasPromptLine(bool v) {
+        if (control().anchored != v) updateControl([v](Control& c) { c.anchored = v; });
     }
 
-    /** @brief Get a copy of the text that is currently displayed in the marquee. */
-    std::string getText() {
-        std::lock_guard<std::mutex> lock(textMutex);
-        return marqueeText;
+    /** @brief Verify whether the console prompt is visible at the moment. */
+    bool getHasPromptLine() const {
+        return control().anchored;
     }
 
 private:
-    std::atomic<bool> pause{false};
-    std::atomic<bool> hasPromptLine{false};
-    std::atomic<bool> marqueeActive{false};
-    std::mutex mtx;
+    std::mutex exitMutex;
+    std::condition_variable exitCv;          // signalled by requestExit()
+    std::atomic<std::int64_t> exitNs{0};     // steady clock ticks at the first requestExit()
+    mutable std::mutex schedulingMutex;
+    std::string scheduling;                  // reportScheduling() so far
 };
 
 /**
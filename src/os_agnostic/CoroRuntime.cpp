@@ -0,0 +1,76 @@
+/**
+ * @file CoroRuntime.cpp
+ * @brief The coroutine event loop.
+ */
+
+#include "CoroRuntime.hpp"
+#include <algorithm>
+
+void EventLoop::spawn(CoroTask task) {
+    post(task.handle());
+    tasks.push_back(std::move(task));
+}
+
+/**
+ * @brief Resume everything ready, then sleep until the next event.
+ *
+ * A round resumes only what was ready when it began; whatever those
+ * coroutines wake goes to the next round, after the stop check.
+ */
+void EventLoop::run(const std::function<bool()>& stopRequested) {
+    for (;;) {
+        for (std::size_t n = ready.size(); n > 0; --n) {
+            const std::coroutine_handle<> h = ready.front();
+            ready.pop_front();
+            ++st.resumes;
+            h.resume();
+        }
+
+        if (!stop && stopRequested()) requestStop();
+        tasks.erase(std::remove_if(tasks.begin(), tasks.end(), [](const CoroTask& t) { return t.done(); }),
+                    tasks.end());
+        if (tasks.empty()) break;
+        if (!ready.empty()) continue;
+
+        // >>> SLEEP (nearest deadline, input or notify)
+        auto deadline = Clock::now() + kIdleWait;
+        for (const Sleeper& s : sleepers) deadline = std::min(deadline, s.deadline);
+
+        FrameTimer::Wake wake;
+        if (inputWaiter) {
+            wake = timer.waitForInput(deadline);
+        } else {
+            wake = timer.waitUntil(deadline) ? FrameTimer::Wake::Notified : FrameTimer::Wake::Deadline;
+        }
+        ++st.wakeups;
+
+        if (wake == FrameTimer::Wake::Input) post(std::exchange(inputWaiter, {}));
+
+        // A notify() is for whoever sleeps (the display waiting for its next frame).
+        const auto now = Clock::now();
+        const bool notified = wake == FrameTimer::Wake::Notified;
+        for (std::size_t i = 0; i < sleepers.size();) {
+            if (notified || sleepers[i].deadline <= now) {
+                *sleepers[i].early = notified;
+                post(sleepers[i].h);
+                sleepers[i] = sleepers.back();
+                sleepers.pop_back();
+            } else {
+                ++i;
+            }
+        }
+    }
+}
+
+void EventLoop::requestStop() {
+    stop = true;
+    if (inputWaiter) post(std::exchange(inputWaiter, {}));
+    for (const Sleeper& s : sleepers) {
+        *s.early = true;
+        post(s.h);
+    }
+    sleepers.clear();
+    for (std::coroutine_handle<>* slot : slots) {
+        if (*slot) post(std::exchange(*slot, {}));
+    }
+}
@@ -0,0 +1,209 @@
+/**
+ * @file CoroRuntime.hpp
+ * @brief A single-threaded event loop for C++20 coroutines (the console's --runtime=coro mode).
+ */
+
+#pragma once
+
+#include "../os_dependent/FrameTimer.hpp"
+#include <chrono>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <optional>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief A coroutine run by an EventLoop (a handler's main loop).
+ *
+ * Starts suspended and stays suspended at its end, so the loop decides when
+ * it first runs and can see when it has finished. The frame is destroyed
+ * with the task.
+ */
+class CoroTask {
+public:
+    struct promise_type {
+        CoroTask get_return_object() {
+            return CoroTask{std::coroutine_handle<promise_type>::from_promise(*this)};
+        }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        std::suspend_always final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { std::terminate(); }  // as an exception escaping a handler thread would
+    };
+
+    CoroTask(CoroTask&& other) noexcept : h(std::exchange(other.h, {})) {}
+    CoroTask(const CoroTask&) = delete;
+    CoroTask& operator=(const CoroTask&) = delete;
+    CoroTask& operator=(CoroTask&& other) noexcept {
+        if (this != &other) {
+            if (h) h.destroy();
+            h = std::exchange(other.h, {});
+        }
+        return *this;
+    }
+    ~CoroTask() {
+        if (h) h.destroy();
+    }
+
+    std::coroutine_handle<> handle() const { return h; }
+    bool done() const { return !h || h.done(); }
+
+private:
+    explicit CoroTask(std::coroutine_handle<promise_type> handle) : h(handle) {}
+
+    std::coroutine_handle<promise_type> h;
+};
+
+/** @brief Event loop counters (snapshot). */
+struct LoopStats {
+    std::uint64_t wakeups{0};  // times the loop came back from sleeping in the FrameTimer
+    std::uint64_t resumes{0};  // coroutine resumptions
+};
+
+/**
+ * @brief Runs coroutines on the calling thread, sleeping in a FrameTimer between events.
+ *
+ * Coroutines suspend on three kinds of event:
+ *  - sleepUntil(): a deadline, cut short by FrameTimer::notify(),
+ *  - input(): stdin has something to read (one waiter at a time),
+ *  - CoroChannel::pop(): a value pushed by another coroutine.
+ *
+ * With nothing ready, the loop makes one FrameTimer::waitForInput() call
+ * for the nearest deadline, so an idle console costs one wakeup per frame.
+ *
+ * Not thread-safe: only FrameTimer::notify() may come from other threads.
+ */
+class EventLoop {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    /** @brief Longest sleep with nothing scheduled (stop requests are checked this often). */
+    static constexpr std::chrono::milliseconds kIdleWait{250};
+
+    /** @param timer What the loop sleeps on (shared with the FrameScheduler, so its wake() reaches us). */
+    explicit EventLoop(FrameTimer& timer) : timer(timer) {}
+
+    EventLoop(const EventLoop&) = delete;
+    EventLoop& operator=(const EventLoop&) = delete;
+
+    /** @brief Take ownership of a task; it first runs inside run(). */
+    void spawn(CoroTask task);
+
+    /**
+     * @brief Resume coroutines as their events arrive until every task has finished.
+     * @param stopRequested Checked after each round; once true, requestStop() is called.
+     */
+    void run(const std::function<bool()>& stopRequested);
+
+    /** @brief Resume every waiter now: input() returns false, pop() nothing, sleepUntil() early. */
+    void requestStop();
+
+    /** @brief Whether requestStop() was called. */
+    bool stopping() const { return stop; }
+
+    /** @brief Queue a suspended coroutine to be resumed in the current or next round. */
+    void post(std::coroutine_handle<> h) { ready.push_back(h); }
+
+    /**
+     * @brief Let requestStop() resume whatever coroutine is parked in slot.
+     *
+     * For awaitables that keep their one waiter themselves (CoroChannel).
+     * The slot must outlive run().
+     */
+    void addWaiterSlot(std::coroutine_handle<>& slot) { slots.push_back(&slot); }
+
+    LoopStats stats() const { return st; }
+
+    /** @brief co_await: sleep until deadline; true if cut short by FrameTimer::notify() (or stop). */
+    auto sleepUntil(Clock::time_point deadline) {
+        struct Awaiter {
+            EventLoop& loop;
+            Clock::time_point deadline;
+            bool early{false};
+
+            bool await_ready() const { return loop.stop || deadline <= Clock::now(); }
+            void await_suspend(std::coroutine_handle<> h) { loop.sleepers.push_back({deadline, h, &early}); }
+            bool await_resume() const { return early; }
+        };
+        return Awaiter{*this, deadline};
+    }
+
+    /** @brief co_await: wait until stdin has input; false if the loop is stopping instead. */
+    auto input() {
+        struct Awaiter {
+            EventLoop& loop;
+
+            bool await_ready() const { return loop.stop; }
+            void await_suspend(std::coroutine_handle<> h) { loop.inputWaiter = h; }
+            bool await_resume() const { return !loop.stop; }
+        };
+        return Awaiter{*this};
+    }
+
+private:
+    struct Sleeper {
+        Clock::time_point deadline;
+        std::coroutine_handle<> h;
+        bool* early;  // the awaiter's result, in the suspended coroutine's frame
+    };
+
+    FrameTimer& timer;
+    std::vector<CoroTask> tasks;
+    std::deque<std::coroutine_handle<>> ready;        // resumed in order, one round at a time
+    std::vector<Sleeper> sleepers;                    // a handful at most: scanned, not heaped
+    std::coroutine_handle<> inputWaiter;
+    std::vector<std::coroutine_handle<>*> slots;      // parked waiters of channels
+    bool stop{false};
+    LoopStats st{};
+};
+
+/**
+ * @brief A FIFO between coroutines of one EventLoop (no locks: same thread).
+ *
+ * One consumer; push() never blocks. Once the loop is stopping, pop()
+ * returns nothing even if values are left.
+ */
+template <typename T>
+class CoroChannel {
+public:
+    explicit CoroChannel(EventLoop& l) : loop(l) { loop.addWaiterSlot(waiter); }
+
+    CoroChannel(const CoroChannel&) = delete;
+    CoroChannel& operator=(const CoroChannel&) = delete;
+
+    /** @brief Append a value and wake the consumer if it is waiting. */
+    void push(T value) {
+        items.push_back(std::move(value));
+        if (waiter) loop.post(std::exchange(waiter, {}));
+    }
+
+    /** @brief co_await: the oldest value, or std::nullopt when the loop is stopping. */
+    auto pop() {
+        struct Awaiter {
+            CoroChannel& ch;
+
+            bool await_ready() const { return !ch.items.empty() || ch.loop.stopping(); }
+            void await_suspend(std::coroutine_handle<> h) { ch.waiter = h; }
+            std::optional<T> await_resume() {
+                if (ch.loop.stopping() || ch.items.empty()) return std::nullopt;
+                std::optional<T> value{std::move(ch.items.front())};
+                ch.items.pop_front();
+                return value;
+            }
+        };
+        return Awaiter{*this};
+    }
+
+    /** @brief Values not yet popped. */
+    std::size_t size() const { return items.size(); }
+
+private:
+    EventLoop& loop;
+    std::deque<T> items;
+    std::coroutine_handle<> waiter;
+};
@@ -4,9 +4,10 @@
  */
 
 #include "DisplayHandler.hpp"
+#include "FrameScheduler.hpp"
+#include <algorithm>
 #include <chrono>
 #include <thread>
-#include <iostream>
 
 #if defined(_WIN32)
 #include <windows.h>
@@ -31,64 +32,231 @@ static void enableVirtualTerminal() {}
 #endif
 
 /**
- * @brief wraps the first character to the end and scrolls the marquee text by one character.
- * @param s The marquee string that is currently in use.
- * @return After scrolling, returns the updated string.
+ * @brief Producer loop: render frames ahead of the writer until shutdown.
+ *
+ * Only textMutex is taken (and only when a generation changes, to grab the
+ * new lanes); the console mutex is never touched here.
+ */
+void DisplayHandler::renderAhead(std::stop_token stop) {
+    using Clock = std::chrono::steady_clock;
+
+    bool pending = false;  // a frame must be rendered at the current tick even if no lane moves
+
+    // Both waits below sample their signal before checking the token, so this cannot be missed.
+    std::stop_callback wakeOnStop(stop, [this] {
+        ring.wake();
+        ctx.signalChange();
+    });
+
+    for (;;) {
+        // Sampled before the checks below so a change made after them still wakes the idle wait.
+        const std::uint32_t seen = ctx.changeSignal.load();
+        if (stop.stop_requested()) break;
+
+        if (engine.sync(Clock::now())) pending = true;
+
+        RenderedFrame* slot = ring.acquire();
+        if (!slot) {
+            ring.waitForSpace([&stop] { return stop.stop_requested(); });
+            continue;
+        }
+
+        if (!pending) {
+            if (!engine.next()) {
+                ctx.changeSignal.wait(seen);  // every lane stands still
+                continue;
+            }
+            engine.catchUp(Clock::now());
+        }
+        pending = false;
+
+        engine.render(*slot, ctx.getHasPromptLine());
+        ring.commit();
+    }
+}
+
+/**
+ * @brief Write one tick, counting the frame and how late it reached the terminal.
+ */
+void DisplayHandler::present(const RenderedFrame* frame) {
+    if (!frame) {
+        ctx.screen->flush({}, 0);
+        return;
+    }
+
+    // Above the scroll velocity, consecutive ticks often show the same
+    // steps; those cost nothing to skip.
+    const bool unchanged = frame->generation == shownGeneration && frame->timing == shownTiming
+                        && frame->anchored == shownAnchored && frame->lanes == shownLanes
+                        && std::equal(shownSteps.begin(), shownSteps.begin() + shownLanes, frame->steps.begin());
+    const bool shown = ctx.screen->flush(unchanged ? std::string_view{} : frame->view(), frame->rows);
+    if (!shown) return;
+
+    if (!unchanged) {
+        ctx.metrics.framesPresented.fetch_add(1, std::memory_order_relaxed);
+        ctx.metrics.frameBytes.fetch_add(frame->size, std::memory_order_relaxed);
+        ctx.metrics.sgrBytes.fetch_add(frame->sgrBytes, std::memory_order_relaxed);
+
+        // How long after its due time the frame reached the terminal.
+        const auto written = std::chrono::steady_clock::now();
+        const std::uint64_t lateNs = written > frame->due
+            ? static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(written - frame->due).count())
+            : 0;
+        ctx.metrics.lateFrames.fetch_add(1, std::memory_order_relaxed);
+        ctx.metrics.lateNsTotal.fetch_add(lateNs, std::memory_order_relaxed);
+        if (lateNs > ctx.metrics.lateNsMax.load(std::memory_order_relaxed)) {
+            ctx.metrics.lateNsMax.store(lateNs, std::memory_order_relaxed);
+        }
+    }
+    engine.markShown(*frame);
+    shownGeneration = frame->generation;
+    shownTiming = frame->timing;
+    shownAnchored = frame->anchored;
+    shownLanes = frame->lanes;
+    shownSteps = frame->steps;
+}
+
+/**
+ * @brief Count how late the tick's wait let us through.
+ *
+ * Timer slack plus however long the thread waited for a CPU: what
+ * --display-cpu and --realtime are there to shrink.
  */
-std::string DisplayHandler::scrollOnce(const std::string& s) {
-    if (s.empty()) return s;
-    std::string out = s.substr(1) + s.substr(0, 1);
-    return out;
+void DisplayHandler::recordWake(std::chrono::steady_clock::time_point deadline) {
+    const auto woke = std::chrono::steady_clock::now();
+    if (woke < deadline) return;  // cut short (stop)
+    ctx.metrics.wakeJitter.record(
+        static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(woke - deadline).count()));
 }
 
 /**
  * @brief Main display loop that adds the marquee to the console.
  *
- * Awaits the phase barrier to be crossed by all handlers.
- * After that, it keeps looping, updating the marquee above the console prompt.
- * or, if the prompt hasn't been drawn yet, inline.
+ * Starts once every handler exists (see HandlerRegistry::start).
+ * After that, until stopped, it keeps looping, writing the next pre-rendered frame above
+ * the console prompt (or inline, if the prompt hasn't been drawn yet) once
+ * per tick. Frames rendered for an older text or layout are discarded.
  */
-void DisplayHandler::operator()() {
-    // >>> JOIN INIT PHASE
-    ctx.phase_barrier.arrive_and_wait();
+void DisplayHandler::operator()(std::stop_token stop) {
+    enableVirtualTerminal();
+    if (ctx.displayTuning.requested()) ctx.reportScheduling("display", ctx.displayTuning.applyToCurrentThread());
+
+    std::jthread producer([this](std::stop_token producerStop) {
+        ProfiledMutex::setThreadName("render");
+        if (ctx.renderTuning.requested()) ctx.reportScheduling("render", ctx.renderTuning.applyToCurrentThread());
+        renderAhead(producerStop);
+    });
+
+    // A stop must not wait out the frame interval (set_speed can make it seconds long).
+    std::stop_callback wakeOnStop(stop, [this] { ctx.screen->wake(); });
+
+    auto deadline = std::chrono::steady_clock::now();
+
+    while (!stop.stop_requested()) {
+        const MarqueeState::Control control = ctx.control();  // one consistent snapshot, generations included
+        const std::uint64_t generation = control.textGeneration;
+        const std::uint64_t timing = control.timingGeneration;
+        const bool anchored = control.anchored;
+        const bool active = control.active;
+        const std::chrono::nanoseconds interval{control.frameIntervalNs};
+
+        // Drop frames rendered for an older text, pacing or layout, and (while
+        // scrolling) frames whose moment has passed: the position follows the wall clock.
+        const auto now = std::chrono::steady_clock::now();
+        while (const RenderedFrame* stale = ring.front()) {
+            const RenderedFrame* successor = ring.peek(1);
+            const bool late = active && successor && successor->due <= now;  // already superseded
+            if (stale->generation == generation && stale->timing == timing && stale->anchored == anchored
+                && !late) break;
+            ring.pop();
+        }
+
+        const RenderedFrame* frame = active ? ring.front() : nullptr;
+        if (frame && frame->due > now + interval / 2) frame = nullptr;  // timeline just restarted
+
+        // One composed write per tick: pending echo/feedback, status (when due) and the frame.
+        // A lagging terminal parks a frame-only update (newest wins) instead of blocking here.
+        present(frame);
+        if (frame) ring.pop();
+
+        // Regulate the refresh rate according to the frame interval of the context.
+        // Deadlines are absolute so write time does not stretch the period.
+        deadline += interval;
+        if (const RenderedFrame* next = active ? ring.front() : nullptr) {
+            deadline = std::min(deadline, next->due);  // tick in phase with the frame timeline
+        }
+        const auto after = std::chrono::steady_clock::now();
+        if (deadline < after) deadline = after;  // fell behind: don't try to catch up in a burst
+
+        // Between frames, only wake for echo/feedback that cannot wait for the next one.
+        while (ctx.screen->waitUntil(deadline)) {
+            ctx.screen->flush({}, 0);
+        }
+        if (!stop.stop_requested()) recordWake(deadline);
+    }
+
+    // Its stop callback wakes the producer even if it is parked on a full ring or idle.
+    producer.request_stop();
+    producer.join();
+}
+
+/**
+ * @brief The display loop on the event loop.
+ *
+ * Same ticks and same frames as the threaded writer, but each frame is
+ * rendered just after the previous one is presented, so rendering never
+ * runs late and no ring is needed. Nothing here blocks: waits go through
+ * FrameScheduler::pollWait() and the loop's sleepUntil().
+ */
+CoroTask DisplayHandler::runCoroutine(EventLoop& loop) {
+    using Clock = std::chrono::steady_clock;
 
     enableVirtualTerminal();
+    // Everything shares this thread here, so the tuning covers the whole loop.
+    if (ctx.displayTuning.requested()) ctx.reportScheduling("event loop", ctx.displayTuning.applyToCurrentThread());
 
-    std::string cur = ctx.getText();  // local copy of marquee string
+    auto frame = std::make_unique<RenderedFrame>();  // 16 KiB: kept off the coroutine frame
+    bool held = false;                               // *frame is rendered but not presented yet
+    auto deadline = Clock::now();
 
     while (!ctx.exitRequested.load()) {
-        if (ctx.isMarqueeActive()) {
-            {
-                std::lock_guard<std::mutex> guard(ctx.textMutex);
-                cur = ctx.marqueeText;
-
-                if (!cur.empty()) {
-                    ctx.marqueeText = scrollOnce(cur);  // update shared state
-                    cur = ctx.marqueeText;              // reflect locally
-                }
-            }
+        const MarqueeState::Control control = ctx.control();  // one consistent snapshot
+        const bool anchored = control.anchored;
+        const bool active = control.active;
+        const std::chrono::nanoseconds interval{control.frameIntervalNs};
+        const auto now = Clock::now();
+
+        // New text, pacing or layout: draw the current tick again.
+        if (engine.sync(now) || (held && frame->anchored != anchored)) {
+            engine.render(*frame, anchored);
+            held = true;
+        }
 
-            {
-                std::lock_guard<std::mutex> lock(ctx.coutMutex);
-                if (ctx.getHasPromptLine()) {
-                    // Draw the prompt line above and then move the cursor back to its original position.
-                    std::cout << "\x1b[u"      // restore to prompt anchor
-                              << "\x1b[1F"     // move one line up
-                              << "\r\x1b[2K"   // clear that line
-                              << cur
-                              << "\x1b[u"      // restore to prompt again
-                              << std::flush;
-                } else {
-                    // If no prompt yet, draw directly where we are
-                    std::cout << "\r\x1b[2K" << cur << std::flush;
-                }
+        const bool due = active && held && frame->due <= now + interval / 2;
+        present(due ? frame.get() : nullptr);
+        if (due) {
+            held = false;
+            if (engine.next()) {  // otherwise every lane stands still until the next sync
+                engine.catchUp(Clock::now());
+                engine.render(*frame, anchored);
+                held = true;
             }
         }
 
-        // Short sleep to regulate refresh rate according to the speed setting of the context
-        std::this_thread::sleep_for(std::chrono::milliseconds(ctx.speedMs.load()));
-    }
+        // Regulate the refresh rate according to the frame interval of the context.
+        deadline += interval;
+        if (active && held) deadline = std::min(deadline, frame->due);  // tick in phase with the frame timeline
+        const auto after = Clock::now();
+        if (deadline < after) deadline = after;  // fell behind: don't try to catch up in a burst
 
-    // >>> THREAD EXIT
-    ctx.stop_latch.count_down();  // signal this handler is finished
+        // Between frames, only wake for echo/feedback that cannot wait for the next one.
+        for (;;) {
+            Clock::time_point wakeAt;
+            const FrameScheduler::Wait wait = ctx.screen->pollWait(deadline, wakeAt);
+            if (wait == FrameScheduler::Wait::Deadline) break;
+            if (wait == FrameScheduler::Wait::Flush) ctx.screen->flush({}, 0);
+            else co_await loop.sleepUntil(wakeAt);
+        }
+        if (!ctx.exitRequested.load()) recordWake(deadline);
+    }
 }
@@ -5,14 +5,37 @@
 #pragma once
 
 #include "Context.hpp"
+#include "CoroRuntime.hpp"
+#include "FrameRing.hpp"
+#include "MarqueeEngine.hpp"
+#include <algorithm>
+#include <array>
 #include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stop_token>
 #include <string>
+#include <string_view>
 
 /**
  * @brief in charge of the marquee's live console rendering.
  * This class uses the shared context to update the console.
- * It reacts to control flags such as active and pause and creates new
- * text frames that move around the screen.
+ * It follows the marquee state (MarqueeEngine) and creates new text
+ * frames that move around the screen while the marquee is active.
+ *
+ * Rendering is split in two stages: a producer thread renders upcoming
+ * frames into a FrameRing, and operator() only hands the slot that is due
+ * to the FrameScheduler on each tick, so a slow terminal write never delays
+ * rendering and an expensive frame never delays a write.
+ *
+ * All lanes share the one producer: a min-heap of each lane's next step
+ * change says when the next frame is needed, and that frame draws every
+ * lane at once.
+ *
+ * Under the coroutine runtime there is no producer thread: runCoroutine()
+ * renders each frame one tick ahead into a single buffer.
  */
 class DisplayHandler : public Handler {
 public:
@@ -20,31 +43,65 @@ public:
      * @brief Create a DisplayHandler that is connected to the shared context.
      * @param c Shared MarqueeContext for state access and synchronization.
     */
-    explicit DisplayHandler(MarqueeContext& c) : Handler(c) {}
+    explicit DisplayHandler(MarqueeContext& c) : Handler(c), engine(c) {}
 
     /**
     * @brief The main thread function that manages the rendering of marquees.
     *
     * Loops and draws after waiting for other threads to be ready.
-    * new frames based on the text and marquee state as of right now.
+    * Starts the render-ahead stage and flushes one pre-rendered frame per tick.
+    * Both threads first apply their ctx tuning (core, priority), if any.
+    *
+    * @param stop Ends the loop; requesting it also cuts the frame sleep short.
     */
-    void operator()();
+    void operator()(std::stop_token stop);
 
     /**
-     * @brief initiates scrolling on the marquee display.
+     * @brief The display loop as a coroutine for the single-threaded runtime.
+     *
+     * Renders the next frame right after presenting one, then sleeps on the
+     * event loop until it is due (or deferred echo/feedback needs writing).
+     *
+     * @param loop The loop to sleep on.
      */
-    void start() { ctx.setMarqueeActive(true); }
+    CoroTask runCoroutine(EventLoop& loop);
 
+private:
     /**
-     * @brief halts the animation of the marquee (freeze display).
-    */
-    void stop()  { ctx.setMarqueeActive(false); }
+     * @brief Producer stage: keeps the ring filled with the upcoming frames.
+     *
+     * Each frame is stamped with the time it is due on screen, on a grid of
+     * the frame interval, and each lane's step is its scroll position at that
+     * time (velocity x elapsed), so the refresh rate only changes how smooth
+     * the motion is, not how fast it goes. Frames are only rendered at ticks
+     * where some lane's step changes. Every lane re-anchors at its shown step
+     * whenever either generation in ctx.control() changes; the writer
+     * discards anything rendered for an older generation.
+     *
+     * @param stop Ends the loop, waking it from a full ring or an idle wait.
+     */
+    void renderAhead(std::stop_token stop);
 
-private:
     /**
-     * @brief Move the text to the left by one character.
-     * @param s Current marquee string.
-     * After scrolling, @return New string.
-    */
-    std::string scrollOnce(const std::string& s);  // used internally during render loop
+     * @brief Hand one tick to the screen: frame (nullptr for none) plus whatever else is pending.
+     *
+     * A frame showing the same steps as the last one costs no bytes; its
+     * steps still become the shown ones.
+     */
+    void present(const RenderedFrame* frame);
+
+    /** @brief Add the wakeup for a tick due at deadline to ctx.metrics.wakeJitter. */
+    void recordWake(std::chrono::steady_clock::time_point deadline);
+
+    static constexpr std::size_t kRingSlots = 8;    // frames rendered ahead of the writer
+
+    FrameRing<RenderedFrame, kRingSlots> ring;      // producer -> writer handoff
+    MarqueeEngine engine;                           // producer's timeline over ctx
+
+    // What the last presented frame put on screen.
+    std::uint64_t shownGeneration{~std::uint64_t{0}};
+    std::uint64_t shownTiming{~std::uint64_t{0}};
+    bool shownAnchored{false};
+    std::size_t shownLanes{0};
+    std::array<std::size_t, MarqueeState::kMaxLanes> shownSteps{};
 };
@@ -0,0 +1,81 @@
+/**
+ * @file FollowCommands.cpp
+ * @brief The "follow" commands.
+ */
+
+#include "CommandHandler.hpp"
+#include "CommandArgs.hpp"
+#include "CommandFeedback.hpp"
+#include "FollowHandler.hpp"
+#include "HandlerRegistry.hpp"
+
+/**
+ * @brief Run one "follow <path>", "follow stop" or "follow" line.
+ *
+ * The FollowHandler is started by the first "follow <path>"; from then on
+ * it wakes only when the file changes.
+ *
+ * @param line The whole command line (for the echo).
+ * @param rest Everything after "follow".
+ */
+void CommandHandler::handleFollow(std::string_view line, std::string_view rest) {
+  std::pmr::memory_resource* mr = commandArena.resource();
+  FollowHandler& follower = *ctx.follower;
+  const std::string_view arg = trimView(rest);
+
+  // >>> FOLLOW STOP
+  if (arg == "stop") {
+    paintMessage(ctx, mr, line, follower.stopFollowing() ? "Stopped following." : "Not following a file.");
+    return;
+  }
+
+  // >>> FOLLOW <PATH>
+  if (!arg.empty()) {
+    std::string error;
+    if (!ctx.handlers->ensureStarted("follow")) {
+      paintMessage(ctx, mr, line, "Cannot follow: the console is shutting down.");
+      return;
+    }
+    const bool ok = follower.follow(std::string{arg}, error);
+    const FollowStatus st = follower.status();
+    paintEchoFeedbackMarqueePrompt(ctx, mr, line, [&](std::pmr::string& out){
+      if (!ok) {
+        out += "Cannot follow: ";
+        out += error;
+        out += "\n";
+        return;
+      }
+      out += "Following ";  out += st.path;
+      out += " (";          out += st.backend;
+      out += "), ";         appendNumber(out, st.bytes);
+      out += " bytes of its end shown.\n";
+    });
+    return;
+  }
+
+  // >>> FOLLOW STATUS
+  const FollowStatus st = follower.status();
+  paintEchoFeedbackMarqueePrompt(ctx, mr, line, [&](std::pmr::string& out){
+    if (st.path.empty()) {
+      out += "Not following a file (follow <path>).\n";
+      return;
+    }
+    out += st.following ? "Following " : "Stopped following ";
+    out += st.path;
+    out += " (";          out += st.backend;
+    out += "): ";         appendNumber(out, st.updates);
+    out += " updates, ";  appendNumber(out, st.bytes);
+    out += " bytes read";
+    if (st.updates) {
+      out += ", change to text avg "; appendNumber(out, st.publishNsTotal / st.updates / 1000);
+      out += " us, max ";            appendNumber(out, st.publishNsMax / 1000);
+      out += " us";
+    }
+    out += "\n";
+    if (!st.ended.empty()) {
+      out += "Ended: ";
+      out += st.ended;
+      out += ".\n";
+    }
+  });
+}
@@ -0,0 +1,179 @@
+/**
+ * @file FollowHandler.cpp
+ * @brief Feeds the main marquee from a file another process appends to ("follow").
+ */
+
+#include "FollowHandler.hpp"
+#include <algorithm>
+#include <mutex>
+#include <thread>
+
+void FollowHandler::park(std::unique_lock<ProfiledMutex>& lock) {
+    following = false;
+    follower.cancel();
+    cv.wait(lock, [this] { return !waiting; });
+}
+
+bool FollowHandler::follow(const std::string& path, std::string& error) {
+    std::unique_lock<ProfiledMutex> lock(m);
+    park(lock);
+    if (!follower.open(path, kWindow, error)) return false;
+
+    skipPartialLine = follower.offset() > 0;
+    st = FollowStatus{};
+    st.path = path;
+    st.backend = follower.backend();
+    pull(Clock::now(), true);  // what the file already holds
+    following = true;
+    lock.unlock();
+    cv.notify_all();
+    return true;
+}
+
+bool FollowHandler::stopFollowing() {
+    std::unique_lock<ProfiledMutex> lock(m);
+    const bool was = following;
+    park(lock);
+    follower.close();
+    return was;
+}
+
+FollowStatus FollowHandler::status() const {
+    std::lock_guard<ProfiledMutex> lock(m);
+    FollowStatus out = st;
+    out.following = following;
+    return out;
+}
+
+std::size_t FollowHandler::appendToFeed(std::string_view raw) {
+    static constexpr std::string_view kSeparator = " | ";
+    for (const char ch : raw) {
+        const auto c = static_cast<unsigned char>(ch);
+        if (skipPartialLine) {
+            skipPartialLine = c != '\n';
+            continue;
+        }
+        if (c == '\n') {
+            const bool separated = feed.size() >= kSeparator.size()
+                && std::string_view{feed}.substr(feed.size() - kSeparator.size()) == kSeparator;
+            if (!feed.empty() && !separated) feed += kSeparator;
+        } else if (c == '\t') {
+            feed += ' ';
+        } else if (c >= 0x20 && c != 0x7f) {
+            feed += ch;  // printable ASCII and UTF-8 bytes; other control characters are dropped
+        }
+    }
+    if (feed.size() <= kWindow) return 0;
+
+    // Cut whole characters only: never start on a UTF-8 continuation byte.
+    std::size_t cut = feed.size() - kWindow;
+    while (cut < feed.size() && (static_cast<unsigned char>(feed[cut]) & 0xC0) == 0x80) ++cut;
+    feed.erase(0, cut);
+    return cut;
+}
+
+void FollowHandler::pull(Clock::time_point woke, bool restart) {
+    const std::size_t shown = feed.size();  // lane 0 holds feed + ' ' at feedAt from the last publish
+    bool reset = restart;
+    if (restart) feed.clear();
+    std::size_t dropped = 0;
+    std::size_t total = 0;
+    std::size_t got;
+    do {
+        bool truncated = false;
+        chunk.clear();
+        got = follower.readNew(chunk, kReadChunk, truncated);
+        if (truncated) {  // rewritten from scratch: start the feed over
+            feed.clear();
+            skipPartialLine = false;
+            reset = true;
+            dropped = 0;
+        }
+        dropped += appendToFeed(chunk);
+        total += got;
+    } while (got == kReadChunk);
+    if (!reset && total == 0) return;  // a metadata change, nothing new
+    st.bytes += total;
+    if (!publish(shown, dropped, reset)) return;
+
+    const auto ns = static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - woke).count());
+    ++st.updates;
+    st.publishNsTotal += ns;
+    st.publishNsMax = std::max(st.publishNsMax, ns);
+}
+
+/**
+ * @brief Splice only the difference while lane 0 still shows owned; otherwise start after its text.
+ */
+bool FollowHandler::publish(std::size_t shown, std::size_t dropped, bool reset) {
+    const std::size_t kept = reset ? 0 : shown - std::min(dropped, shown);  // feed bytes already on lane 0
+    if (owned) {
+        std::shared_ptr<const PreparedText> text;
+        if (reset || dropped > shown) {
+            // Everything shown went (truncated, or scrolled out of the window): replace it, keep the gap.
+            const TextSplice edit{feedAt, shown, feed};
+            text = ctx.spliceLaneText(0, {&edit, 1}, owned.get());
+        } else {
+            if (!dropped && kept == feed.size()) return false;  // only dropped control characters
+            // The new end goes in before the gap, then the front is cut: both O(log n).
+            const TextSplice edits[] = {{feedAt + shown, 0, std::string_view{feed}.substr(kept)}, {feedAt, dropped, {}}};
+            text = ctx.spliceLaneText(0, edits, owned.get());
+        }
+        if (text) {
+            owned = std::move(text);
+            return true;
+        }
+    }
+
+    // The first update, or lane 0 was set to something else: leave it and
+    // add what it has not shown yet after it.
+    feed.erase(0, kept);
+    owned.reset();
+    while (!feed.empty() && !owned) {  // retried only if another edit lands in between
+        const std::shared_ptr<const PreparedText> current = ctx.getPrepared();
+        feedAt = current->rope().size();
+        const TextSplice edits[] = {{feedAt, 0, feed}, {feedAt + feed.size(), 0, " "}};  // the gap set_text adds
+        owned = ctx.spliceLaneText(0, edits, current.get());
+    }
+    return owned != nullptr;
+}
+
+void FollowHandler::operator()(std::stop_token stop) {
+    std::stop_callback cancelOnStop(stop, [this] { follower.cancel(); });
+
+    std::unique_lock<ProfiledMutex> lock(m);
+    while (!stop.stop_requested()) {
+        if (!following) {
+            cv.wait(lock, stop, [this] { return following; });
+            continue;
+        }
+
+        waiting = true;
+        lock.unlock();
+        const FileFollower::Event ev = follower.wait();
+        const Clock::time_point woke = Clock::now();
+        lock.lock();
+        waiting = false;
+        cv.notify_all();  // follow() or stopFollowing() may be waiting for us to park
+
+        if (ev == FileFollower::Event::Cancelled || !following) continue;
+        if (ev == FileFollower::Event::Gone) {
+            pull(woke);  // whatever was written before it went
+            following = false;
+            st.ended = "the file was removed or renamed";
+            follower.close();
+            continue;
+        }
+        pull(woke);
+    }
+}
+
+CoroTask FollowHandler::runCoroutine(EventLoop& loop) {
+    std::jthread watcher([this](std::stop_token stop) {
+        ProfiledMutex::setThreadName("follow");
+        (*this)(stop);
+    });
+    while (!loop.stopping() && !ctx.exitRequested.load()) {
+        co_await loop.sleepUntil(Clock::time_point::max());
+    }
+}
@@ -0,0 +1,131 @@
+/**
+ * @file FollowHandler.hpp
+ * @brief Feeds the main marquee from a file another process appends to ("follow").
+ */
+
+#pragma once
+
+#include "Context.hpp"
+#include "CoroRuntime.hpp"
+#include "ProfiledMutex.hpp"
+#include "../os_dependent/FileFollower.hpp"
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stop_token>
+#include <string>
+
+/** @brief What the follower is doing (snapshot). */
+struct FollowStatus {
+    bool following{false};
+    std::string path;             // the file followed (or last followed)
+    std::string ended;            // why following stopped by itself (empty otherwise)
+    const char* backend{""};      // FileFollower::backend()
+    std::uint64_t updates{0};     // marquee updates published
+    std::uint64_t bytes{0};       // bytes read from the file
+    std::uint64_t publishNsTotal{0};  // wakeup to text published, summed over updates
+    std::uint64_t publishNsMax{0};
+};
+
+/**
+ * @brief Waits for a file to grow and appends what was added to lane 0's text.
+ *
+ * Only the new bytes are read (FileFollower::readNew). Lines are joined
+ * with " | " and control characters are dropped, so the feed scrolls as one
+ * row and can never smuggle escape sequences onto the terminal. The feed
+ * goes after whatever lane 0 showed when it started, and keeps its last
+ * kWindow bytes. New bytes are spliced into lane 0's rope and older ones
+ * cut from the feed's front in one change (MarqueeState::spliceLaneText),
+ * and the scroll position moves with them so the text on screen does not
+ * jump. The handler keeps the text it published last: if lane 0 shows
+ * something else by the next update (set_text, an edit, an effect), that
+ * is left alone and the feed starts again after it.
+ *
+ * The text is published as soon as the watcher wakes, which the display
+ * picks up on its next tick. While the file is idle the watcher is blocked
+ * in the kernel (inotify on Linux) and costs nothing.
+ *
+ * follow() and stopFollowing() may be called from any thread.
+ */
+class FollowHandler : public Handler {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr std::size_t kWindow = 2048;          // feed bytes kept on the marquee
+    static constexpr std::size_t kReadChunk = 64 * 1024;  // most read per call (a burst is read in several)
+
+    explicit FollowHandler(MarqueeContext& c) : Handler(c) {}
+
+    /**
+     * @brief Wait for the followed file to change, until stopped.
+     * @param stop Cancels the wait at once.
+     */
+    void operator()(std::stop_token stop);
+
+    /**
+     * @brief The coroutine runtime's version.
+     *
+     * The loop only sleeps on its FrameTimer, so the blocking wait gets a
+     * thread of its own. That thread never writes to the console, which
+     * keeps the loop's no-op console lock sound.
+     *
+     * @param loop The loop that ends it.
+     */
+    CoroTask runCoroutine(EventLoop& loop);
+
+    /**
+     * @brief Follow path from now on (instead of any previous file).
+     *
+     * The end of what the file already holds (up to kWindow bytes, from
+     * its first complete line) is added to the marquee text right away,
+     * in place of the previous file's feed if lane 0 still shows it.
+     *
+     * @param error Receives a short reason on failure.
+     * @return true if the file is followed.
+     */
+    bool follow(const std::string& path, std::string& error);
+
+    /** @brief Stop following (the text on screen stays). @return false if nothing was followed. */
+    bool stopFollowing();
+
+    FollowStatus status() const;
+
+private:
+    /** @brief Leave the watcher parked, outside FileFollower::wait(). Call with m held. */
+    void park(std::unique_lock<ProfiledMutex>& lock);
+
+    /**
+     * @brief Read what was appended and publish it. Call with m held.
+     * @param restart Start the feed over (a new file): what it showed is replaced.
+     */
+    void pull(Clock::time_point woke, bool restart = false);
+
+    /**
+     * @brief Make lane 0 show feed, as one change. Call with m held.
+     * @param shown Feed bytes lane 0 showed (from feedAt) before this update.
+     * @param dropped Bytes cut from the front of feed since.
+     * @param reset Everything in feed is new (truncated or restarted).
+     * @return false if nothing was published.
+     */
+    bool publish(std::size_t shown, std::size_t dropped, bool reset);
+
+    /**
+     * @brief Append raw file bytes to feed, cleaned up for the marquee.
+     * @return Bytes cut from the front of feed to keep it within kWindow.
+     */
+    std::size_t appendToFeed(std::string_view raw);
+
+    mutable ProfiledMutex m{"followMutex"};  // guards everything below
+    std::condition_variable_any cv;          // watcher parked / state changed
+    FileFollower follower;                   // used by whoever holds m while the watcher is parked
+    bool following{false};
+    bool waiting{false};                     // the watcher is inside follower.wait() (without m)
+    bool skipPartialLine{false};             // reading started mid-file: drop up to the first newline
+    std::string feed;                        // the feed on lane 0 (without the trailing gap)
+    std::string chunk;                       // read buffer, kept between updates
+    std::shared_ptr<const PreparedText> owned;  // lane 0's text as last published (null: none yet)
+    std::size_t feedAt{0};                   // where the feed starts in owned
+    FollowStatus st;
+};
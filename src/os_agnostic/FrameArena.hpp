@@ -0,0 +1,40 @@
+/**
+ * @file FrameArena.hpp
+ * @brief Fixed scratch memory that is rewound once per frame or per command.
+ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <memory_resource>
+
+/**
+ * @brief A monotonic pmr arena backed by an inline buffer.
+ *
+ * Hot paths (frame composition, command parsing) build their temporary
+ * strings on resource() and call reset() before the next frame/command, so
+ * once the buffer is large enough nothing touches the global heap.
+ * Anything bigger than the inline buffer spills to new/delete and is
+ * handed back on the next reset().
+ *
+ * @tparam Bytes Size of the inline buffer.
+ */
+template <std::size_t Bytes>
+class FrameArena {
+public:
+    FrameArena() = default;
+    FrameArena(const FrameArena&) = delete;
+    FrameArena& operator=(const FrameArena&) = delete;
+
+    /** @brief Memory resource to hand to std::pmr containers. */
+    std::pmr::memory_resource* resource() { return &pool; }
+
+    /** @brief Forget everything allocated so far (containers using it must be gone). */
+    void reset() { pool.release(); }
+
+private:
+    alignas(std::max_align_t) std::array<std::byte, Bytes> storage{};
+    std::pmr::monotonic_buffer_resource pool{storage.data(), storage.size(),
+                                             std::pmr::new_delete_resource()};
+};
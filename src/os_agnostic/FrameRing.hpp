@@ -0,0 +1,103 @@
+/**
+ * @file FrameRing.hpp
+ * @brief Bounded single-producer/single-consumer ring of fixed-size slots.
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Lock-free SPSC ring used to hand pre-rendered frames to the writer.
+ *
+ * The producer fills the slot returned by acquire() in place and publishes
+ * it with commit(); the consumer reads front() and releases it with pop().
+ * Slots are never reallocated, so a frame costs no heap traffic.
+ *
+ * A producer that finds the ring full parks in waitForSpace() until the
+ * consumer pops a slot or someone calls wake() (e.g. on shutdown).
+ *
+ * @tparam T Slot type (reused in place, so it should be cheap to overwrite).
+ * @tparam N Number of slots.
+ */
+template <typename T, std::size_t N>
+class FrameRing {
+    static_assert(N >= 2, "FrameRing needs at least two slots");
+
+public:
+    // >>> PRODUCER SIDE
+
+    /** @brief Next free slot, or nullptr when the ring is full. */
+    T* acquire() {
+        const std::uint64_t h = head.load(std::memory_order_relaxed);
+        if (h - tail.load(std::memory_order_acquire) == N) return nullptr;
+        return &slots[h % N];
+    }
+
+    /** @brief Publish the slot returned by the last acquire(). */
+    void commit() {
+        head.store(head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    /**
+     * @brief Block while the ring is full.
+     *
+     * Returns early after any pop() or wake(). stop is checked after the
+     * wake-up counter is sampled, so a wake() issued right after setting the
+     * stop condition can never be missed.
+     *
+     * @param stop Predicate that is true when the producer should give up.
+     */
+    template <typename Stop>
+    void waitForSpace(Stop&& stop) {
+        const std::uint32_t seen = signal.load(std::memory_order_acquire);
+        if (head.load(std::memory_order_relaxed) - tail.load(std::memory_order_acquire) < N) return;
+        if (stop()) return;
+        signal.wait(seen, std::memory_order_acquire);
+    }
+
+    // >>> CONSUMER SIDE
+
+    /** @brief Oldest published slot, or nullptr when the ring is empty. */
+    const T* front() const {
+        const std::uint64_t t = tail.load(std::memory_order_relaxed);
+        if (head.load(std::memory_order_acquire) == t) return nullptr;
+        return &slots[t % N];
+    }
+
+    /** @brief The i-th oldest published slot (peek(0) == front()), or nullptr. */
+    const T* peek(std::size_t i) const {
+        const std::uint64_t t = tail.load(std::memory_order_relaxed);
+        if (head.load(std::memory_order_acquire) - t <= i) return nullptr;
+        return &slots[(t + i) % N];
+    }
+
+    /** @brief Release the slot returned by front() and wake a waiting producer. */
+    void pop() {
+        tail.store(tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        wake();
+    }
+
+    // >>> EITHER SIDE
+
+    /** @brief Unblock a producer parked in waitForSpace(). */
+    void wake() {
+        signal.fetch_add(1, std::memory_order_release);
+        signal.notify_one();
+    }
+
+    /** @brief Number of published, unconsumed slots. */
+    std::size_t size() const {
+        return static_cast<std::size_t>(head.load(std::memory_order_acquire) -
+                                        tail.load(std::memory_order_acquire));
+    }
+
+private:
+    std::array<T, N> slots{};
+    alignas(64) std::atomic<std::uint64_t> head{0};    // written by the producer only
+    alignas(64) std::atomic<std::uint64_t> tail{0};    // written by the consumer only
+    alignas(64) std::atomic<std::uint32_t> signal{0};  // bumped to wake the producer
+};
@@ -0,0 +1,319 @@
+/**
+ * @file FrameScheduler.cpp
+ * @brief Merges marquee, status, prompt and feedback updates into composed screen writes.
+ *
+ * Screen layout (rows relative to the saved prompt anchor):
+ *
+ *   [status]            rows + 1 lines up
+ *   lane row(s)         1..rows lines up (lane 0 on top)
+ *   > prompt buffer     anchor saved at the end of the buffer
+ */
+
+#include "FrameScheduler.hpp"
+#include "CommandArgs.hpp"
+#include <algorithm>
+#include <mutex>
+
+/**
+ * @brief Nanoseconds since the steady clock's epoch.
+ */
+static std::uint64_t sinceEpochNs(std::chrono::steady_clock::time_point t) {
+    return static_cast<std::uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(t.time_since_epoch()).count());
+}
+
+/**
+ * @brief Publish a new prompt buffer and schedule its echo.
+ * @param buffer What the user has typed so far.
+ * @param keyTime When the key was read.
+ */
+void FrameScheduler::updatePrompt(std::string_view buffer, Clock::time_point keyTime) {
+    std::lock_guard<ConsoleMutex> lock(ctx.coutMutex);
+    prompt.assign(buffer);
+    promptDirty = true;
+    ++pendingKeys;
+    pendingKeyNs += sinceEpochNs(keyTime);
+    ++st.updates;
+    schedule(Clock::now());
+}
+
+/**
+ * @brief Show the complete submitted line, then forget it without repainting the prompt.
+ */
+void FrameScheduler::submitPrompt() {
+    std::lock_guard<ConsoleMutex> lock(ctx.coutMutex);
+    if (promptDirty) composeAndWrite({}, false, Clock::now());
+    prompt.clear();
+}
+
+/**
+ * @brief Queue one command's echo and feedback.
+ * @param echo The command line to echo.
+ * @param body Feedback lines, each ending with '\n'.
+ */
+void FrameScheduler::submitFeedback(std::string_view echo, std::string_view body) {
+    std::lock_guard<ConsoleMutex> lock(ctx.coutMutex);
+    if (blockCount == blocks.size()) blocks.emplace_back();
+    std::string& block = blocks[blockCount++];
+    block.assign("\r\x1b[2K> ");
+    block.append(echo);
+    block.append("\n");
+    block.append(body);
+    ++st.updates;
+    schedule(Clock::now());
+}
+
+/**
+ * @brief Flush pending state, then write parts unchanged.
+ * @param parts Raw bytes to write after everything pending.
+ */
+void FrameScheduler::emitNow(std::initializer_list<std::string_view> parts) {
+    std::lock_guard<ConsoleMutex> lock(ctx.coutMutex);
+    const auto now = Clock::now();
+    if (promptDirty || blockCount) composeAndWrite({}, false, now);
+    ctx.terminal.emit(parts);
+    fanout.publish(parts, true);
+    rec.capture(parts);
+    lastWrite = now;
+    ++st.writes;
+}
+
+/**
+ * @brief Write now, or leave the update for a write that is coming soon anyway.
+ *
+ * Deferred when the next display tick is within kCoalesceWindow, or when a
+ * write went out less than kCoalesceWindow ago (a burst); in the latter case
+ * the display thread is woken at the end of the window.
+ *
+ * @param now Current time.
+ */
+void FrameScheduler::schedule(Clock::time_point now) {
+    if (nextTick != Clock::time_point::max() && nextTick - now <= kCoalesceWindow) {
+        return;  // rides on the next frame
+    }
+    if (now - lastWrite < kCoalesceWindow) {
+        const auto due = lastWrite + kCoalesceWindow;
+        if (due < flushDue) {
+            flushDue = due;
+            timer.notify();
+        }
+        return;
+    }
+    composeAndWrite({}, false, now);  // immediate path: nothing else is going out soon
+}
+
+/**
+ * @brief Append the status row, wrapped in the moves to its line and back.
+ * @param rows Marquee rows between the status row and the prompt.
+ */
+void FrameScheduler::appendStatusRow(std::size_t rows) {
+    update += "\x1b[u\x1b[";
+    appendNumber(update, rows + 1);
+    update += "F\r\x1b[2K";
+    update += ctx.statusLine;
+    update += "\x1b[u";
+}
+
+/**
+ * @brief Build one update from everything dirty and write it.
+ *
+ * Feedback blocks and prompt changes must reach the screen, so an update
+ * carrying them is emitted; a frame/status-only update is presented and may
+ * be dropped by a lagging terminal.
+ *
+ * @param frame Anchor-relative marquee frame (may be empty).
+ * @param withStatus Whether to redraw the status row.
+ * @param now Current time.
+ */
+void FrameScheduler::composeAndWrite(std::string_view frame, bool withStatus, Clock::time_point now) {
+    update.clear();
+    const bool guaranteed = blockCount || promptDirty;
+
+    if (blockCount) {
+        const std::size_t rows = ctx.layoutRows();
+
+        // Replace the old status and marquee rows with one blank line and the echoes.
+        update += "\x1b[u\x1b[";
+        appendNumber(update, lastRows + 1);
+        update += "F\x1b[J\n";
+        for (std::size_t i = 0; i < blockCount; ++i) update += blocks[i];
+        blockCount = 0;
+
+        // Fresh status row, marquee snapshot (blank when stopped) and prompt.
+        update += "\x1b[2K";
+        update += ctx.statusLine;
+        update += "\n\x1b[2K";
+        if (ctx.isMarqueeActive()) ctx.appendVisibleText(update, "\n\x1b[2K");
+        update += "\n\x1b[2K> ";
+        update += prompt;
+        update += "\x1b[s";
+        lastRows = rows;
+        promptDirty = false;
+        ctx.setHasPromptLine(true);
+    } else if (promptDirty) {
+        update += "\x1b[u\r\x1b[2K> ";
+        update += prompt;
+        update += "\x1b[s";
+        promptDirty = false;
+        ctx.setHasPromptLine(true);
+    }
+
+    if (withStatus) appendStatusRow(lastRows);
+    update += frame;
+
+    if (update.empty()) {
+        ctx.terminal.pump();
+        return;
+    }
+
+    if (guaranteed) {
+        ctx.terminal.emit({update});
+    } else {
+        ctx.terminal.present({update});
+    }
+    fanout.publish({update}, guaranteed);
+    rec.capture({update});
+
+    // Every keystroke folded into this write has now been echoed.
+    if (pendingKeys) {
+        const std::uint64_t written = sinceEpochNs(Clock::now());
+        ctx.metrics.echoNsTotal.fetch_add(written * pendingKeys - pendingKeyNs, std::memory_order_relaxed);
+        ctx.metrics.echoCount.fetch_add(pendingKeys, std::memory_order_relaxed);
+        pendingKeys = 0;
+        pendingKeyNs = 0;
+    }
+    lastWrite = now;
+    flushDue = Clock::time_point::max();
+    ++st.writes;
+}
+
+/**
+ * @brief One display tick: refresh the status when due and write it all at once.
+ * @param frame Pre-rendered marquee frame, or empty.
+ * @param rows Marquee rows the frame draws above the prompt (0 when inline).
+ * @return false if the frame did not fit the rows on screen and was left out.
+ */
+bool FrameScheduler::flush(std::string_view frame, std::size_t rows) {
+    std::lock_guard<ConsoleMutex> lock(ctx.coutMutex);
+    const auto now = Clock::now();
+    // Only a feedback repaint changes how many rows sit above the prompt.
+    const bool fits = rows == 0 || rows == lastRows;
+    if (!fits) frame = {};
+    if (!frame.empty()) ++st.updates;
+
+    const bool withStatus = ctx.getHasPromptLine() && status.due(now);
+    if (withStatus) status.refresh(now, ctx.statusLine, ctx.terminal.stats());
+
+    composeAndWrite(frame, withStatus, now);
+    return fits;
+}
+
+/**
+ * @brief Sleep until the next frame, waking early for deferred updates.
+ * @param deadline When the next frame is due.
+ * @return true if deferred updates are due now (caller should flush()).
+ */
+bool FrameScheduler::waitUntil(Clock::time_point deadline) {
+    for (;;) {
+        Clock::time_point wakeAt;
+        switch (pollWait(deadline, wakeAt)) {
+        case Wait::Flush:    return true;
+        case Wait::Deadline: return false;
+        case Wait::Sleep:    timer.waitUntil(wakeAt); break;
+        }
+    }
+}
+
+/**
+ * @brief Decide what a display waiting for deadline should do next.
+ *
+ * While it sleeps, nextTick stays at deadline so producers know a frame
+ * is coming and can ride on it.
+ *
+ * @param deadline When the next frame is due.
+ * @param wakeAt Receives when to look again (Wait::Sleep only).
+ */
+FrameScheduler::Wait FrameScheduler::pollWait(Clock::time_point deadline, Clock::time_point& wakeAt) {
+    std::lock_guard<ConsoleMutex> lock(ctx.coutMutex);
+    nextTick = Clock::time_point::max();
+    if (ctx.exitRequested.load()) return Wait::Deadline;
+
+    const auto now = Clock::now();
+    if (flushDue <= now) {
+        if (promptDirty || blockCount) return Wait::Flush;
+        flushDue = Clock::time_point::max();  // already went out with another write
+    }
+    if (now >= deadline) return Wait::Deadline;
+
+    nextTick = deadline;
+    wakeAt = std::min(deadline, flushDue);
+    return Wait::Sleep;
+}
+
+/**
+ * @brief Blank lines for the status and marquee rows, then the prompt with its anchor.
+ *
+ * A mirror or recording that starts with this lets the anchor-relative
+ * updates that follow land where they do on the terminal.
+ */
+void FrameScheduler::composePreamble() {
+    update.assign(lastRows + 1, '\n');
+    update += "> ";
+    update += prompt;
+    update += "\x1b[s";
+}
+
+/**
+ * @brief Start mirroring the console to spec.
+ * @param spec "fifo:<path>" or "file:<path>".
+ * @param error Receives a short reason on failure.
+ * @return The sink's id, or 0 on failure.
+ */
+std::uint32_t FrameScheduler::addSink(std::string_view spec, std::string& error) {
+    std::lock_guard<ConsoleMutex> lock(ctx.coutMutex);
+    composePreamble();
+    return fanout.add(spec, update, error);
+}
+
+/**
+ * @brief Start an asciicast recording sized like the terminal, beginning with the preamble.
+ * @param path File to create (truncated if it exists).
+ * @param error Receives a short reason on failure.
+ */
+bool FrameScheduler::startRecording(const std::string& path, std::string& error) {
+    std::lock_guard<ConsoleMutex> lock(ctx.coutMutex);
+    unsigned cols = 0, rows = 0;
+    ctx.terminal.size(cols, rows);
+    if (!rec.start(path, cols, rows, error)) return false;
+    composePreamble();
+    rec.capture({update});
+    return true;
+}
+
+/**
+ * @brief Stop capturing; the writer thread finishes the file before this returns.
+ *
+ * Runs without coutMutex so the display never waits for the final file
+ * write. A capture() racing with the stop only fills ring space nobody
+ * reads, and the next start() resets the ring under the lock.
+ */
+RecorderStats FrameScheduler::stopRecording() {
+    return rec.stop();
+}
+
+/**
+ * @brief Wake the display thread (used on exit).
+ */
+void FrameScheduler::wake() {
+    timer.notify();
+}
+
+/**
+ * @brief Snapshot of the write counters.
+ */
+SchedulerStats FrameScheduler::stats() {
+    std::lock_guard<ConsoleMutex> lock(ctx.coutMutex);
+    SchedulerStats out = st;
+    out.timer = timer.backend();
+    return out;
+}
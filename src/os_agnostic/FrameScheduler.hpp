@@ -0,0 +1,190 @@
+/**
+ * @file FrameScheduler.hpp
+ * @brief Merges marquee, status, prompt and feedback updates into composed screen writes.
+ */
+
+#pragma once
+
+#include "Broadcast.hpp"
+#include "Context.hpp"
+#include "Recorder.hpp"
+#include "StatusLine.hpp"
+#include "../os_dependent/FrameTimer.hpp"
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/** @brief Write counters (snapshot). */
+struct SchedulerStats {
+    std::uint64_t updates{0};  // prompt/feedback/frame updates handed in by producers
+    std::uint64_t writes{0};   // composed terminal writes actually issued
+    const char* timer{""};     // pacing mechanism (FrameTimer backend)
+};
+
+/**
+ * @brief The single owner of screen output.
+ *
+ * Producers no longer write to the terminal themselves; they mark what
+ * changed:
+ *  - the keyboard publishes the prompt buffer (updatePrompt),
+ *  - the command thread queues echo + feedback blocks (submitFeedback),
+ *  - the display thread hands in a marquee frame once per tick (flush).
+ *
+ * Everything dirty is composed into at most one write per tick. An update
+ * that would otherwise wait too long (a keystroke while the next tick is far
+ * away) takes the immediate path instead, so echo latency stays bounded by
+ * kCoalesceWindow while bursts of keys and frames share writes.
+ *
+ * The display thread sleeps on a FrameTimer (timerfd on Linux), so ticks
+ * land on absolute deadlines well above 100 Hz. Under the coroutine
+ * runtime the event loop sleeps on that same timer.
+ *
+ * Every write is also published, as is, to the Broadcast sinks, and captured
+ * by the Recorder while a recording runs.
+ *
+ * All state is guarded by ctx.coutMutex (a no-op when everything runs on one thread).
+ */
+class FrameScheduler {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    /** @brief Longest a prompt/feedback update may wait to share a write. */
+    static constexpr std::chrono::milliseconds kCoalesceWindow{8};
+
+    explicit FrameScheduler(MarqueeContext& c) : ctx(c), status(c) {}
+
+    // >>> PRODUCERS (any thread)
+
+    /**
+     * @brief The prompt buffer changed.
+     * @param buffer What the user has typed so far (copied).
+     * @param keyTime When the key that caused the change was read (for the echo latency metric).
+     */
+    void updatePrompt(std::string_view buffer, Clock::time_point keyTime);
+
+    /**
+     * @brief The prompt line was submitted; the typed text stays on screen until the
+     *        command's feedback repaints below it with an empty prompt.
+     */
+    void submitPrompt();
+
+    /**
+     * @brief Queue a command echo and its feedback lines; never dropped.
+     *
+     * When flushed, the previous status/marquee rows are replaced by the echo,
+     * the feedback, a fresh status row, the marquee and a new prompt.
+     *
+     * @param echo The command line as it should be echoed after "> ".
+     * @param body Feedback lines, each ending with '\n'.
+     */
+    void submitFeedback(std::string_view echo, std::string_view body);
+
+    /**
+     * @brief Flush anything pending, then write parts as-is (banners, exit messages).
+     */
+    void emitNow(std::initializer_list<std::string_view> parts);
+
+    // >>> DISPLAY THREAD
+
+    /**
+     * @brief Compose one screen update: pending feedback, prompt, status (when due) and frame.
+     * @param frame Pre-rendered marquee frame (anchor-relative), or empty for none.
+     * @param rows Marquee rows the frame draws above the prompt (0 for an inline frame).
+     * @return false if the frame was dropped because it was laid out for a different
+     *         number of rows than the screen has (lanes changed and the repaint is pending).
+     */
+    bool flush(std::string_view frame, std::size_t rows);
+
+    /**
+     * @brief Sleep until deadline (the next frame) or until deferred updates fall due.
+     * @return true if woken because deferred updates need flushing now.
+     */
+    bool waitUntil(Clock::time_point deadline);
+
+    /** @brief What a display waiting for its next frame should do (see pollWait). */
+    enum class Wait {
+        Flush,     // deferred updates are due: flush(), then wait again
+        Deadline,  // the frame is due (or exit was requested)
+        Sleep,     // nothing to do before wakeAt
+    };
+
+    /**
+     * @brief One step of waitUntil() for a display that does its own sleeping.
+     *
+     * The coroutine runtime sleeps in its event loop instead of in the timer;
+     * pacer() is the timer that loop must wait on, so wake() and deferred
+     * updates still cut the sleep short.
+     *
+     * @param deadline When the next frame is due.
+     * @param wakeAt Receives when to call again if the answer is Wait::Sleep.
+     */
+    Wait pollWait(Clock::time_point deadline, Clock::time_point& wakeAt);
+
+    /** @brief The timer the display sleeps on (waited on directly by the coroutine runtime). */
+    FrameTimer& pacer() { return timer; }
+
+    // >>> MIRRORS
+
+    /**
+     * @brief Mirror everything written from now on to a FIFO or file (see Broadcast).
+     * @return The sink's id, or 0 on failure (reason in error).
+     */
+    std::uint32_t addSink(std::string_view spec, std::string& error);
+
+    /** @brief The registered mirrors (remove and list go straight through). */
+    Broadcast& sinks() { return fanout; }
+
+    /**
+     * @brief Record everything written from now on to an asciicast v2 file (see Recorder).
+     * @return false if a recording is already running or path cannot be created.
+     */
+    bool startRecording(const std::string& path, std::string& error);
+
+    /** @brief Finish the recording and close its file (no-op when not recording; one thread at a time with startRecording). */
+    RecorderStats stopRecording();
+
+    /** @brief The recorder (for status and counters). */
+    const Recorder& recorder() const { return rec; }
+
+    /** @brief Wake a display thread blocked in waitUntil (e.g. on exit). */
+    void wake();
+
+    SchedulerStats stats();
+
+private:
+    /** @brief Decide between writing now and deferring (lock held). */
+    void schedule(Clock::time_point now);
+
+    /** @brief Compose and write everything pending plus an optional frame (lock held). */
+    void composeAndWrite(std::string_view frame, bool withStatus, Clock::time_point now);
+
+    /** @brief Append the [status] row with its cursor moves (lock held). */
+    void appendStatusRow(std::size_t rows);
+
+    /** @brief Put blank status/marquee rows and the anchored prompt in update (lock held). */
+    void composePreamble();
+
+    MarqueeContext& ctx;
+    StatusLine status;                  // [status] contents, refreshed at a low fixed rate
+    FrameTimer timer;                   // display sleeps here between ticks
+    Broadcast fanout;                   // extra sinks that receive every write (thread-safe on its own)
+    Recorder rec;                       // asciicast capture of every write
+
+    std::string prompt;                 // current prompt buffer
+    bool promptDirty{false};
+    std::uint64_t pendingKeys{0};       // keystrokes not yet echoed
+    std::uint64_t pendingKeyNs{0};      // sum of their read times (ns since clock epoch)
+    std::vector<std::string> blocks;    // pending echo+feedback blocks (strings reused)
+    std::size_t blockCount{0};
+
+    std::size_t lastRows{1};            // marquee rows under the status row
+    std::string update;                 // composed write (capacity reused)
+    Clock::time_point lastWrite{};      // time of the last composed write
+    Clock::time_point nextTick{Clock::time_point::max()};
+    Clock::time_point flushDue{Clock::time_point::max()};
+    SchedulerStats st{};
+};
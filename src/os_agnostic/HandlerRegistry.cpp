@@ -0,0 +1,94 @@
+/**
+ * @file HandlerRegistry.cpp
+ * @brief Starting and stopping the registered handlers.
+ */
+
+#include "HandlerRegistry.hpp"
+#include "ProfiledMutex.hpp"
+#include <algorithm>
+
+void HandlerRegistry::add(HandlerSpec spec) {
+    std::lock_guard<std::mutex> lock(m);
+    entries.push_back(Entry{std::move(spec), {}, false, false});
+}
+
+bool HandlerRegistry::coroutineOnly() const {
+    std::lock_guard<std::mutex> lock(m);
+    return std::all_of(entries.begin(), entries.end(), [](const Entry& e) { return bool(e.spec.coroutine); });
+}
+
+void HandlerRegistry::launch(Entry& e, bool meetAtBarrier) {
+    e.running = true;
+    if (loop && e.spec.coroutine) {
+        e.onLoop = true;
+        loop->spawn(e.spec.coroutine(*loop));
+        return;
+    }
+    std::barrier<>* ready = meetAtBarrier ? startBarrier.get() : nullptr;
+    e.thread = std::jthread([&body = e.spec.thread, &name = e.spec.name, ready](std::stop_token stop) {
+        ProfiledMutex::setThreadName(name);  // how the lock profiles tell handler threads apart
+
+        // >>> JOIN INIT PHASE
+        if (ready) ready->arrive_and_wait();
+        body(stop);
+    });
+}
+
+void HandlerRegistry::start(EventLoop* runtimeLoop) {
+    std::unique_lock<std::mutex> lock(m);
+    loop = runtimeLoop;
+
+    std::ptrdiff_t threads = 0;
+    for (const Entry& e : entries) {
+        if (!e.spec.onDemand && !(loop && e.spec.coroutine)) ++threads;
+    }
+    startBarrier = std::make_unique<std::barrier<>>(threads + 1);  // + the calling thread
+
+    for (Entry& e : entries) {
+        if (!e.spec.onDemand) launch(e, true);
+    }
+    lock.unlock();
+
+    startBarrier->arrive_and_wait();
+}
+
+bool HandlerRegistry::ensureStarted(std::string_view name) {
+    std::lock_guard<std::mutex> lock(m);
+    if (stopping) return false;
+    for (Entry& e : entries) {
+        if (e.spec.name != name) continue;
+        if (!e.running) launch(e, false);
+        return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Stop all thread handlers together, then join them.
+ *
+ * Joining happens without the lock, so a handler that calls
+ * ensureStarted() on its way out is refused instead of deadlocking.
+ * Coroutine handlers are stopped by their loop.
+ */
+void HandlerRegistry::stop() {
+    std::vector<std::jthread*> running;
+    {
+        std::lock_guard<std::mutex> lock(m);
+        stopping = true;
+        for (Entry& e : entries) {
+            if (e.thread.joinable()) {
+                e.thread.request_stop();
+                running.push_back(&e.thread);
+            }
+        }
+    }
+    for (std::jthread* t : running) t->join();
+}
+
+std::vector<HandlerInfo> HandlerRegistry::list() const {
+    std::lock_guard<std::mutex> lock(m);
+    std::vector<HandlerInfo> out;
+    out.reserve(entries.size());
+    for (const Entry& e : entries) out.push_back({e.spec.name, e.spec.onDemand, e.running, e.onLoop});
+    return out;
+}
@@ -0,0 +1,102 @@
+/**
+ * @file HandlerRegistry.hpp
+ * @brief The console's workers, registered at run time and started and stopped as a group.
+ */
+
+#pragma once
+
+#include "CoroRuntime.hpp"
+#include <barrier>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stop_token>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+/** @brief How one handler runs and when it starts. */
+struct HandlerSpec {
+    std::string name;                                // shown by stats ("display", "keyboard", ...)
+    std::function<void(std::stop_token)> thread;     // body on its own jthread
+    std::function<CoroTask(EventLoop&)> coroutine;   // body under the coroutine runtime (empty: a thread there too)
+    bool onDemand{false};                            // started by ensureStarted(), not by start()
+};
+
+/** @brief One registered handler (snapshot). */
+struct HandlerInfo {
+    std::string name;
+    bool onDemand{false};
+    bool running{false};
+    bool coroutine{false};  // running on the event loop rather than a thread
+};
+
+/**
+ * @brief The handlers of one console, however many there are.
+ *
+ * Components add themselves with add(); start() then sizes the startup
+ * barrier to what was registered and stop() stops whatever is running, so
+ * adding a worker never means touching a count elsewhere.
+ *
+ * On-demand handlers (optional subsystems) cost nothing until the first
+ * ensureStarted(), typically from the command that enables them.
+ *
+ * add(), ensureStarted() and list() may be called from any thread (or,
+ * under the coroutine runtime, from the loop).
+ */
+class HandlerRegistry {
+public:
+    /** @brief Register a handler; on-demand ones may also be added after start(). */
+    void add(HandlerSpec spec);
+
+    /**
+     * @brief Whether every handler has a coroutine body.
+     *
+     * Only then can the coroutine runtime run everything on one thread (and
+     * drop the console output lock).
+     */
+    bool coroutineOnly() const;
+
+    /**
+     * @brief Start every handler that is not on demand; returns once all thread bodies may run.
+     *
+     * Thread handlers meet the calling thread at a barrier sized to their
+     * number, so no body starts before every handler exists. With a loop,
+     * handlers that have a coroutine body are spawned on it instead (they
+     * first run inside EventLoop::run()), and so are on-demand ones later.
+     *
+     * @param loop The coroutine runtime's loop, or nullptr for threads only.
+     */
+    void start(EventLoop* loop = nullptr);
+
+    /**
+     * @brief Start an on-demand handler now (no-op if it is running).
+     * @return false if there is no such handler or the registry is stopping.
+     */
+    bool ensureStarted(std::string_view name);
+
+    /** @brief Request stop on every handler thread at once, then join them all. */
+    void stop();
+
+    std::vector<HandlerInfo> list() const;
+
+private:
+    struct Entry {
+        HandlerSpec spec;
+        std::jthread thread;
+        bool running{false};
+        bool onLoop{false};
+    };
+
+    /** @brief Launch e on its thread or the loop (lock held). */
+    void launch(Entry& e, bool meetAtBarrier);
+
+    mutable std::mutex m;
+    std::deque<Entry> entries;                       // stable addresses for the running bodies
+    std::unique_ptr<std::barrier<>> startBarrier;    // outlives the phase the threads wake from
+    EventLoop* loop{nullptr};
+    bool stopping{false};
+};
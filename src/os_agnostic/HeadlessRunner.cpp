@@ -0,0 +1,186 @@
+/**
+ * @file HeadlessRunner.cpp
+ * @brief Terminal-free render loop for benchmarks and embedding.
+ */
+
+#include "HeadlessRunner.hpp"
+#include "FrameRing.hpp"
+#include "../os_dependent/ProcessUsage.hpp"
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <utility>
+
+HeadlessRunner::HeadlessRunner(std::vector<MarqueeLane> lanes, const HeadlessOptions& options)
+    : opts(options) {
+    if (opts.fps <= 0) opts.fps = 50.0;
+    st.setLanes(std::move(lanes));
+    st.setFrameInterval(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::duration<double>(1.0 / opts.fps)));
+}
+
+/**
+ * @brief Append to the memory buffer (starting over at kMemoryCap), or write to the null device.
+ */
+void HeadlessRunner::write(const RenderedFrame& f) {
+    const std::string_view bytes = f.view();
+    recorder.capture({bytes});
+    if (opts.output == HeadlessOptions::Output::Null) {
+        null.writeSome(&bytes, 1);
+        return;
+    }
+    if (memory.size() + bytes.size() > kMemoryCap) memory.clear();
+    memory.append(bytes);
+}
+
+/**
+ * @brief Render up to opts.frames frames of every lane.
+ *
+ * Ticks where no lane moves are skipped, exactly as on screen. The run ends
+ * early if every lane stands still.
+ */
+HeadlessReport HeadlessRunner::run(std::string& error) {
+    HeadlessReport report;
+    if (opts.output == HeadlessOptions::Output::Null
+        && !null.open(SinkFile::Kind::File, SinkFile::nullDevice(), error)) {
+        return report;
+    }
+    memory.reserve(opts.output == HeadlessOptions::Output::Memory ? kMemoryCap : 0);
+    if (!opts.record.empty() && !recorder.start(opts.record, 80, static_cast<unsigned>(st.layoutRows() + 2), error)) {
+        return report;
+    }
+
+    const bool real = opts.timing == HeadlessOptions::Timing::Real;
+    const ProcessUsage usage = ProcessUsage::now();
+    const auto start = Clock::now();
+    const auto base = real ? start : Clock::time_point{};  // the virtual clock starts at zero
+    engine.sync(base);
+
+    switch (opts.runtime) {
+    case HeadlessOptions::Runtime::Inline:
+        runInline(report, real);
+        break;
+    case HeadlessOptions::Runtime::Threads:
+        runThreads(report, real);
+        break;
+    case HeadlessOptions::Runtime::Coro: {
+        EventLoop loop(timer);
+        loop.spawn(runCoroutine(loop, report, real));
+        loop.run([] { return false; });
+        report.wakeups = loop.stats().wakeups;
+        break;
+    }
+    }
+
+    report.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    report.timelineSeconds = std::chrono::duration<double>(engine.due() - base).count();
+    const ProcessUsage used = ProcessUsage::now();
+    report.cpuSeconds = used.cpuSeconds - usage.cpuSeconds;
+    report.contextSwitches = used.contextSwitches - usage.contextSwitches;
+    if (recorder.active()) report.recording = recorder.stop();
+    return report;
+}
+
+/**
+ * @brief Wait until the tick is due, render and write it, one frame after the other.
+ */
+void HeadlessRunner::runInline(HeadlessReport& report, bool real) {
+    for (std::uint64_t i = 0; i < opts.frames; ++i) {
+        if (i > 0 && !engine.next()) break;  // nothing will move again
+
+        if (real) {
+            while (Clock::now() < engine.due()) {
+                timer.waitUntil(engine.due());
+                ++report.wakeups;
+            }
+            if (engine.catchUp(Clock::now())) ++report.late;
+        }
+
+        engine.render(*frame, true);
+        present(*frame, report, real);
+    }
+}
+
+/**
+ * @brief A render thread fills the ring; this thread writes each frame when it is due.
+ *
+ * With an empty ring the writer waits one frame interval, as the display
+ * does; the render thread's last frame cuts that wait short.
+ */
+void HeadlessRunner::runThreads(HeadlessReport& report, bool real) {
+    auto ring = std::make_unique<FrameRing<RenderedFrame, kRingSlots>>();
+    std::atomic<bool> rendered{false};  // the render thread has committed its last frame
+    std::uint64_t late = 0;
+    std::uint64_t parked = 0;
+
+    std::jthread producer([&](std::stop_token stop) {
+        for (std::uint64_t i = 0; i < opts.frames; ++i) {
+            if (i > 0 && !engine.next()) break;
+            if (real && engine.catchUp(Clock::now())) ++late;
+
+            RenderedFrame* slot;
+            while (!(slot = ring->acquire())) {
+                ring->waitForSpace([&stop] { return stop.stop_requested(); });
+                ++parked;
+                if (stop.stop_requested()) return;
+            }
+            engine.render(*slot, true);
+            ring->commit();
+        }
+        rendered.store(true);
+        timer.notify();
+    });
+
+    const Clock::duration interval = engine.period();
+    for (;;) {
+        const RenderedFrame* next = ring->front();
+        if (!next) {
+            if (rendered.load() && !ring->front()) break;
+            if (real) {
+                timer.waitUntil(Clock::now() + interval);
+                ++report.wakeups;
+            } else {
+                std::this_thread::yield();
+            }
+            continue;
+        }
+        while (real && Clock::now() < next->due) {
+            timer.waitUntil(next->due);
+            ++report.wakeups;
+        }
+        present(*next, report, real);
+        ring->pop();
+    }
+
+    producer.join();
+    report.late += late;
+    report.wakeups += parked;
+}
+
+/**
+ * @brief Render each frame right after the previous one is written, then sleep until it is due.
+ */
+CoroTask HeadlessRunner::runCoroutine(EventLoop& loop, HeadlessReport& report, bool real) {
+    for (std::uint64_t i = 0; i < opts.frames; ++i) {
+        if (i > 0 && !engine.next()) break;
+        if (real && engine.catchUp(Clock::now())) ++report.late;
+
+        engine.render(*frame, true);
+        while (real && Clock::now() < frame->due) co_await loop.sleepUntil(frame->due);
+        present(*frame, report, real);
+    }
+}
+
+void HeadlessRunner::present(const RenderedFrame& f, HeadlessReport& report, bool real) {
+    write(f);
+    ++report.frames;
+    report.bytes += f.size;
+    report.sgrBytes += f.sgrBytes;
+    if (!real) return;
+
+    const auto written = Clock::now();
+    const std::uint64_t lateNs = written > f.due
+        ? static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(written - f.due).count())
+        : 0;
+    report.lateNsTotal += lateNs;
+    report.lateNsMax = std::max(report.lateNsMax, lateNs);
+}
@@ -0,0 +1,130 @@
+/**
+ * @file HeadlessRunner.hpp
+ * @brief Runs the marquee render engine with no terminal, keyboard or command threads.
+ */
+
+#pragma once
+
+#include "CoroRuntime.hpp"
+#include "MarqueeEngine.hpp"
+#include "MarqueeState.hpp"
+#include "Recorder.hpp"
+#include "../os_dependent/FrameTimer.hpp"
+#include "../os_dependent/SinkFile.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/** @brief How a headless run is driven and where its frames go. */
+struct HeadlessOptions {
+    enum class Output { Memory, Null };   // in-memory buffer, or the null device (one write per frame)
+    enum class Timing { Virtual, Real };  // as fast as possible on the frame timeline, or paced by the clock
+    enum class Runtime { Inline, Threads, Coro };  // who renders and writes (see HeadlessRunner)
+
+    Output output{Output::Memory};
+    Timing timing{Timing::Virtual};
+    Runtime runtime{Runtime::Inline};
+    std::uint64_t frames{100000};         // frames to render (fewer if every lane stops)
+    double fps{50.0};                     // timeline refresh rate
+    std::string record;                   // also record every frame to this asciicast file (empty: no)
+};
+
+/** @brief What a headless run measured. */
+struct HeadlessReport {
+    std::uint64_t frames{0};
+    std::uint64_t bytes{0};         // frame bytes written to the output
+    std::uint64_t sgrBytes{0};      // of which colour/attribute sequences
+    std::uint64_t late{0};          // (real timing) frames rendered after their successor was due
+    std::uint64_t lateNsTotal{0};   // (real timing) how long after its due time each frame was written, summed
+    std::uint64_t lateNsMax{0};
+    std::uint64_t wakeups{0};       // returns from a blocking wait (frame timer, full ring, event loop)
+    double cpuSeconds{0};           // CPU time of the whole process during the run
+    std::uint64_t contextSwitches{0}; // of the whole process during the run (0 on Windows)
+    double seconds{0};              // wall-clock time of the run
+    double timelineSeconds{0};      // marquee time the frames covered
+    RecorderStats recording{};      // (with HeadlessOptions::record) what the recorder captured
+
+    double framesPerSecond() const { return seconds > 0 ? static_cast<double>(frames) / seconds : 0; }
+    double nsPerFrame() const { return frames ? seconds * 1e9 / static_cast<double>(frames) : 0; }
+    double lateNsAverage() const { return frames ? static_cast<double>(lateNsTotal) / static_cast<double>(frames) : 0; }
+};
+
+/**
+ * @brief The display's render path without the console around it.
+ *
+ * Frames come from the same MarqueeEngine as the interactive marquee
+ * (anchored layout, all lanes), following a MarqueeState of its own, and go
+ * to an in-memory buffer or the null device instead of the terminal. With Timing::Virtual the timeline
+ * advances one frame at a time with no sleeping, which measures the render
+ * cost alone. Timing::Real sleeps until each frame is due, like the display
+ * thread does.
+ *
+ * HeadlessOptions::runtime picks who does the work, as in the console:
+ *  - Inline: the calling thread waits, renders and writes each frame in turn.
+ *  - Threads: a render thread fills a FrameRing ahead of the calling
+ *    thread, which writes each frame when it is due (the display thread
+ *    and its producer).
+ *  - Coro: one coroutine on an EventLoop renders each frame right after
+ *    writing the previous one and sleeps until it is due (--runtime=coro).
+ * So the two console runtimes can be compared on CPU time, context
+ * switches, wakeups and frame lateness without a terminal.
+ *
+ * With HeadlessOptions::record set, every frame is also captured by a
+ * Recorder, so the cost of recording shows up in the same figures.
+ *
+ * Needs no MarqueeContext, so other programs can embed it as-is; commands
+ * can be applied to state() (e.g. through a CommandProcessor) before run().
+ */
+class HeadlessRunner {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    /** @brief Bytes the in-memory output keeps before starting over. */
+    static constexpr std::size_t kMemoryCap = std::size_t{1} << 20;
+
+    /**
+     * @brief Prepare a run.
+     * @param lanes Lanes to render, in screen order (at most MarqueeState::kMaxLanes).
+     * @param options Output, timing and length of the run (options.fps becomes the state's refresh rate).
+     */
+    HeadlessRunner(std::vector<MarqueeLane> lanes, const HeadlessOptions& options);
+
+    /** @brief The state the run renders (lanes and pacing may be changed before run()). */
+    MarqueeState& state() { return st; }
+
+    /**
+     * @brief Render the frames and measure.
+     * @param error Receives a reason if the output could not be opened.
+     * @return The measurements (zero frames on error).
+     */
+    HeadlessReport run(std::string& error);
+
+    /** @brief The in-memory output since it last started over (Output::Memory). */
+    std::string_view output() const { return memory; }
+
+private:
+    /** @brief Frames the Threads runtime renders ahead of the writer (as the display's ring). */
+    static constexpr std::size_t kRingSlots = 8;
+
+    void runInline(HeadlessReport& report, bool real);
+    void runThreads(HeadlessReport& report, bool real);
+    CoroTask runCoroutine(EventLoop& loop, HeadlessReport& report, bool real);
+
+    /** @brief Write a frame and count it (and, on the real clock, how late it was written). */
+    void present(const RenderedFrame& frame, HeadlessReport& report, bool real);
+
+    /** @brief Hand the current frame to the output. */
+    void write(const RenderedFrame& frame);
+
+    HeadlessOptions opts;
+    MarqueeState st;
+    MarqueeEngine engine{st};
+    std::unique_ptr<RenderedFrame> frame{std::make_unique<RenderedFrame>()};  // 16 KiB: kept off the stack
+    std::string memory;
+    SinkFile null;
+    Recorder recorder;
+    FrameTimer timer;
+};
@@ -0,0 +1,79 @@
+/**
+ * @file JitterCommands.cpp
+ * @brief The "jitter" commands: the display thread's wakeup lateness.
+ */
+
+#include "CommandHandler.hpp"
+#include "CommandArgs.hpp"
+#include "CommandFeedback.hpp"
+
+/**
+ * @brief Run one "jitter" or "jitter reset" line.
+ *
+ * Shows the display thread's wakeup lateness (see JitterHistogram) next
+ * to the scheduling it actually got, so runs with and without
+ * --display-cpu / --realtime can be compared.
+ *
+ * @param line The whole command line (for the echo).
+ * @param rest Everything after "jitter".
+ */
+void CommandHandler::handleJitter(std::string_view line, std::string_view rest) {
+  std::pmr::memory_resource* mr = commandArena.resource();
+  const std::string_view sub = trimView(rest);
+
+  // >>> JITTER RESET
+  if (sub == "reset") {
+    ctx.metrics.wakeJitter.reset();
+    paintMessage(ctx, mr, line, "Jitter histogram cleared.");
+    return;
+  }
+  if (!sub.empty()) {
+    paintMessage(ctx, mr, line, "Usage: jitter [reset]");
+    return;
+  }
+
+  // >>> JITTER HISTOGRAM
+  constexpr std::size_t kBarWidth = 40;
+  const JitterHistogram::Snapshot h = ctx.metrics.wakeJitter.snapshot();
+  const std::string scheduling = ctx.schedulingReport();
+
+  paintEchoFeedbackMarqueePrompt(ctx, mr, line, [&](std::pmr::string& out){
+    out += "Display wakeups: ";  appendNumber(out, h.samples);
+    out += " (scheduling: ";     out += scheduling;
+    out += ")\n";
+    if (h.samples == 0) return;
+
+    std::size_t first = 0;
+    std::size_t last = JitterHistogram::kBuckets - 1;
+    while (h.counts[first] == 0) ++first;
+    while (h.counts[last] == 0) --last;
+    const std::uint64_t peak = *std::max_element(h.counts.begin(), h.counts.end());
+
+    for (std::size_t i = first; i <= last; ++i) {
+      // Label "   < 64 us", right-aligned; the last bucket is open-ended.
+      std::pmr::string label{mr};
+      if (i + 1 == JitterHistogram::kBuckets) {
+        label += ">= ";  appendNumber(label, JitterHistogram::bucketLimitUs(i - 1));
+      } else {
+        label += "< ";   appendNumber(label, JitterHistogram::bucketLimitUs(i));
+      }
+      label += " us";
+      out.append(label.size() < 12 ? 12 - label.size() : 0, ' ');
+      out += label;
+      out += "  ";
+      std::pmr::string count{mr};
+      appendNumber(count, h.counts[i]);
+      out.append(count.size() < 8 ? 8 - count.size() : 0, ' ');
+      out += count;
+      out += "  ";
+      const std::size_t bar = static_cast<std::size_t>((h.counts[i] * kBarWidth + peak - 1) / peak);
+      out.append(bar, '#');
+      out += "\n";
+    }
+    out += "avg ";       appendNumber(out, h.nsTotal / h.samples / 1000);
+    out += " us, p50 < "; appendNumber(out, h.quantileUs(0.5));
+    out += " us, p99 < "; appendNumber(out, h.quantileUs(0.99));
+    out += " us, max ";  appendNumber(out, h.nsMax / 1000);
+    out += " us\n";
+  });
+}
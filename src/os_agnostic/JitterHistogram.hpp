@@ -0,0 +1,81 @@
+/**
+ * @file JitterHistogram.hpp
+ * @brief Log2 histogram of how late a timed wait let its thread through.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Wakeup lateness (actual wake minus deadline), in power-of-two microsecond buckets.
+ *
+ * Bucket 0 counts wakes under 1 us, bucket i those in [2^(i-1), 2^i) us,
+ * and the last bucket everything from 2^(kBuckets-2) us (65 ms) up.
+ *
+ * One thread records, any thread reads: relaxed atomics, so a snapshot
+ * taken during a record may be off by that one sample.
+ */
+class JitterHistogram {
+public:
+    static constexpr std::size_t kBuckets = 18;
+
+    /** @brief Counts at one moment. */
+    struct Snapshot {
+        std::array<std::uint64_t, kBuckets> counts{};
+        std::uint64_t samples{0};
+        std::uint64_t nsTotal{0};
+        std::uint64_t nsMax{0};
+
+        /** @brief Upper bound, in us, of the bucket holding the p-quantile (0 < p <= 1). */
+        std::uint64_t quantileUs(double p) const {
+            const auto rank = static_cast<std::uint64_t>(p * static_cast<double>(samples) + 0.5);
+            std::uint64_t seen = 0;
+            for (std::size_t i = 0; i < kBuckets; ++i) {
+                seen += counts[i];
+                if (seen >= std::max<std::uint64_t>(rank, 1)) return bucketLimitUs(i);
+            }
+            return bucketLimitUs(kBuckets - 1);
+        }
+    };
+
+    /** @brief Exclusive upper bound of bucket i, in us (the last bucket has none: its lower bound x 2). */
+    static constexpr std::uint64_t bucketLimitUs(std::size_t i) { return std::uint64_t{1} << i; }
+
+    /** @brief Count one wake that came lateNs after its deadline (recording thread only). */
+    void record(std::uint64_t lateNs) {
+        const std::size_t bucket = std::min<std::size_t>(std::bit_width(lateNs / 1000), kBuckets - 1);
+        counts[bucket].fetch_add(1, std::memory_order_relaxed);
+        samples.fetch_add(1, std::memory_order_relaxed);
+        nsTotal.fetch_add(lateNs, std::memory_order_relaxed);
+        if (lateNs > nsMax.load(std::memory_order_relaxed)) nsMax.store(lateNs, std::memory_order_relaxed);
+    }
+
+    Snapshot snapshot() const {
+        Snapshot s;
+        for (std::size_t i = 0; i < kBuckets; ++i) s.counts[i] = counts[i].load(std::memory_order_relaxed);
+        s.samples = samples.load(std::memory_order_relaxed);
+        s.nsTotal = nsTotal.load(std::memory_order_relaxed);
+        s.nsMax = nsMax.load(std::memory_order_relaxed);
+        return s;
+    }
+
+    /** @brief Start over (any thread; a record racing with it may survive). */
+    void reset() {
+        for (auto& c : counts) c.store(0, std::memory_order_relaxed);
+        samples.store(0, std::memory_order_relaxed);
+        nsTotal.store(0, std::memory_order_relaxed);
+        nsMax.store(0, std::memory_order_relaxed);
+    }
+
+private:
+    std::array<std::atomic<std::uint64_t>, kBuckets> counts{};
+    std::atomic<std::uint64_t> samples{0};
+    std::atomic<std::uint64_t> nsTotal{0};
+    std::atomic<std::uint64_t> nsMax{0};
+};
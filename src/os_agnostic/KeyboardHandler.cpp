@@ -4,7 +4,8 @@
  */
 
 #include "KeyboardHandler.hpp"
-#include <iostream>
+#include "FrameScheduler.hpp"
+#include <chrono>
 
 /**
 * @brief Makes sure the cursor anchor and prompt line are displayed on the console.
@@ -16,36 +17,51 @@
 */
 static void ensurePromptAnchor(MarqueeContext& ctx) {
     if (!ctx.getHasPromptLine()) {
-        std::lock_guard<std::mutex> lock(ctx.coutMutex);
-
-        std::cout << "\n\n"     // allocate [status] + [marquee] lines
-                  << "> "       // print prompt
-                  << "\x1b[s"   // save anchor at end of prompt
-                  << std::flush;
+        ctx.screen->emitNow({"\n\n",     // allocate [status] + [marquee] lines
+                             "> ",       // print prompt
+                             "\x1b[s"}); // save anchor at end of prompt
 
         ctx.setHasPromptLine(true);
     }
 }
 
 /**
- * @brief Redraws the buffer text at the anchor position and the current prompt line.
- *
- * Always clears the line, moves the cursor to the prompt anchor (line beneath the marquee),
- * resaves the anchor and prints the prompt character and buffer.
- *
- * @param ctx Shared context with prompt state and cursor lock.
- * @param buf The input buffer that the user is currently typing.
-*/
-static void redrawPrompt(MarqueeContext& ctx, const std::string& buf) {
-    std::lock_guard<std::mutex> lock(ctx.coutMutex);
+ * @brief Buffer printable keys, edit on Backspace, deliver the line on Enter.
+ */
+bool KeyboardHandler::onKey(int ch, std::chrono::steady_clock::time_point keyTime) {
+    if (ch == '\n') {
+        // 1) The next repaint (the command's feedback) shows an empty prompt.
+        ctx.screen->submitPrompt();
+
+        // 2) Deliver the command to the person who has signed up to receive it.
+        //    The sink copies what it needs, so the buffer is lent rather than copied.
+        if (deliver) deliver(buffer);
+
+        // 3) The buffer disappears when the prompt line is cleared (capacity is kept).
+        buffer.clear();
+
+    } else if (ch == 3) {  // Ctrl+C pressed
+        ctx.requestExit();
+        return false;
+
+    } else if (ch == 127 || ch == 8) {  // Backspace
+        if (!buffer.empty()) {
+            buffer.pop_back();
+            ctx.screen->updatePrompt(buffer, keyTime);
+        }
+
+    } else if (ch >= 32 && ch < 127) {  // Printable ASCII
+        buffer.push_back(static_cast<char>(ch));
+        ctx.screen->updatePrompt(buffer, keyTime);
+    }
+    return true;
+}
 
-    std::cout << "\x1b[u"         // restore to prompt anchor
-              << "\r\x1b[2K> "    // clear prompt line and print prompt symbol
-              << buf              // show buffer
-              << "\x1b[s"         // re-save anchor at end-of-line
-              << std::flush;
+void KeyboardHandler::clearPrompt() {
+    ctx.screen->emitNow({"\x1b[u",      // return to prompt anchor
+                         "\r\x1b[2K"}); // clear that line
 
-    ctx.setHasPromptLine(true);
+    ctx.setHasPromptLine(false);
 }
 
 /**
@@ -56,17 +72,13 @@ static void redrawPrompt(MarqueeContext& ctx, const std::string& buf) {
  * Manually press the special keys (Ctrl+C, Backspace).
 */
 
-void KeyboardHandler::operator()() {
-    // >>> JOIN INIT PHASE
-    ctx.phase_barrier.arrive_and_wait();
-
+void KeyboardHandler::operator()(std::stop_token stop) {
     Scanner scan;
-    std::string buffer;
 
     // Verify that the cursor anchor and prompt are prepared.
     ensurePromptAnchor(ctx);
 
-    while (!ctx.exitRequested.load()) {
+    while (!stop.stop_requested()) {
         // If something else cleared the prompt, re-anchor
         if (!ctx.getHasPromptLine()) {
             ensurePromptAnchor(ctx);
@@ -74,42 +86,30 @@ void KeyboardHandler::operator()() {
 
         int ch = scan.poll();  // non-blocking input
         if (ch < 0) continue;  // no input yet
+        if (!onKey(ch, std::chrono::steady_clock::now())) break;
+    }
 
-        if (ch == '\n') {
-            // 1) The buffer disappears when the prompt line is cleared.
-            const std::string submitted = buffer;
-            buffer.clear();
-            // redrawPrompt(ctx, buffer); // optional prompt clear (commented out for now)
-
-            // 2) Deliver the command to the person who has signed up to receive it.
-            if (deliver) deliver(submitted);
-
-        } else if (ch == 3) {  // Ctrl+C pressed
-            ctx.exitRequested.store(true);
-            break;
+    // Clear prompt line on exit
+    clearPrompt();
+}
 
-        } else if (ch == 127 || ch == 8) {  // Backspace
-            if (!buffer.empty()) {
-                buffer.pop_back();
-                redrawPrompt(ctx, buffer);
-            }
+/**
+ * @brief The keyboard loop on the event loop: no polling, one key per input wakeup.
+ */
+CoroTask KeyboardHandler::runCoroutine(EventLoop& loop) {
+    Scanner scan;
+    ensurePromptAnchor(ctx);
 
-        } else if (ch >= 32 && ch < 127) {  // Printable ASCII
-            buffer.push_back(static_cast<char>(ch));
-            redrawPrompt(ctx, buffer);
+    while (!ctx.exitRequested.load()) {
+        if (!ctx.getHasPromptLine()) {
+            ensurePromptAnchor(ctx);
         }
-    }
 
-    // Clear prompt line on exit
-    {
-        std::lock_guard<std::mutex> lock(ctx.coutMutex);
-        std::cout << "\x1b[u"     // return to prompt anchor
-                  << "\r\x1b[2K"  // clear that line
-                  << std::flush;
+        if (!co_await loop.input()) break;  // loop is stopping
+        const int ch = scan.poll();         // returns at once: stdin is readable
+        if (ch < 0) continue;               // end of input or a non-key event
+        if (!onKey(ch, std::chrono::steady_clock::now())) break;
     }
 
-    ctx.setHasPromptLine(false);
-
-    // >>> THREAD EXIT
-    ctx.stop_latch.count_down();
+    clearPrompt();
 }
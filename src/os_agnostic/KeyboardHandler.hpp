@@ -6,8 +6,12 @@
 #pragma once
 
 #include "Context.hpp"
+#include "CoroRuntime.hpp"
 #include "../os_dependent/Scanner.hpp"
+#include <chrono>
+#include <stop_token>
 #include <string>
+#include <string_view>
 #include <functional>
 
 /**
@@ -32,17 +36,41 @@ public:
      * Responds to user input and manages per-keystroke actions such as
      * Newline, character typing, and backspace. Moreover, it leaves cleanly.
      * on Ctrl+C.
+     *
+     * @param stop Ends the loop within one scanner poll (10 ms).
+     */
+    void operator()(std::stop_token stop);
+
+    /**
+     * @brief The same loop as a coroutine for the single-threaded runtime.
+     *
+     * Suspends until stdin is readable instead of polling it, and reads one
+     * key per wakeup.
+     *
+     * @param loop The loop to wait on.
      */
-    void operator()();
+    CoroTask runCoroutine(EventLoop& loop);
 
     /**
      * @brief Configures the function to execute upon entering a complete command.
-     * @param sink A function that takes a line of completed input.
+     * @param sink A function that takes a line of completed input (only valid during the call).
      */
-    void setSink(std::function<void(std::string)> sink) {
+    void setSink(std::function<void(std::string_view)> sink) {
         deliver = std::move(sink);  // injection point to deliver commands to command processor
     }
 
 private:
-    std::function<void(std::string)> deliver;  // holds the command sink callback
+    /**
+     * @brief Act on one key.
+     * @param ch The key as returned by Scanner::poll().
+     * @param keyTime When it was read (for the echo latency metric).
+     * @return false if the key asks to quit (Ctrl+C).
+     */
+    bool onKey(int ch, std::chrono::steady_clock::time_point keyTime);
+
+    /** @brief Clear the prompt line on the way out. */
+    void clearPrompt();
+
+    std::function<void(std::string_view)> deliver;  // holds the command sink callback
+    std::string buffer;                             // the line being typed
 };
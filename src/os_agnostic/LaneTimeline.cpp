@@ -0,0 +1,165 @@
+/**
+ * @file LaneTimeline.cpp
+ * @brief Lane scroll timeline and frame composition.
+ */
+
+#include "LaneTimeline.hpp"
+#include <charconv>
+#include <cmath>
+#include <iterator>
+
+/**
+ * @brief Render one lane as Policy places it, each row wrapped in the cursor moves to its line.
+ *
+ * The text itself is never rotated; each row is a contiguous slice of the
+ * rotation cache when the text has one. Lane rows are stacked under the
+ * lanes above: layout row g of totalRows is drawn totalRows - g lines above
+ * the prompt anchor. Without an anchor only the first row is drawn inline.
+ * The caller restores the anchor once after the last lane.
+ *
+ * @param slot Ring slot being filled.
+ * @param text The lane's prepared text.
+ * @param at Rotation and row shift to show.
+ * @param firstRow Layout row of the lane's first row.
+ * @param totalRows Rows of all lanes together.
+ * @param anchored Whether to draw relative to the saved prompt anchor.
+ */
+template <typename Policy>
+void LaneTimeline::renderFrame(RenderedFrame& slot, const PreparedText& text, const ScrollFrame& at,
+                                 std::size_t firstRow, std::size_t totalRows, bool anchored) {
+    // Empty text still clears its row.
+    const std::size_t rows = anchored ? std::max<std::size_t>(text.rows(), 1) : 1;
+
+    for (std::size_t r = 0; r < rows; ++r) {
+        const std::size_t row = firstRow + r;
+        if (anchored) {
+            // Move from the prompt anchor to the row's line.
+            char up[32];
+            char* end = std::to_chars(up, up + sizeof up, totalRows - row).ptr;
+            slot.append("\x1b[u");                           // restore to prompt anchor
+            slot.append("\x1b[");                            // move (totalRows - row) lines up
+            slot.append(std::string_view{up, static_cast<std::size_t>(end - up)});
+            slot.append("F");
+        }
+        slot.append("\r\x1b[2K");                            // clear that line
+
+        if (text.rows() == 0) continue;
+        const std::size_t src = Policy::sourceRow(r, at, text.rows());
+        if (src >= text.rows()) continue;                    // blank row between repeats
+
+        // Reserve room for the moves of the rows below, the trailing restore and the
+        // worst-case styling so a clipped frame still lands back on the prompt with
+        // no escape cut in half.
+        const std::size_t tail = (anchored ? 3 + kRowMoveBytes * (totalRows - row - 1) : 0) + text.sgrBound();
+        const std::size_t used = slot.size + tail;
+        const std::size_t room = used < RenderedFrame::kCapacity ? RenderedFrame::kCapacity - used : 0;
+        slot.sgrBytes += text.appendRow(slot, src, at.offset, std::min(text.width(), room));
+    }
+}
+
+/**
+ * @brief Wrap step into Policy's period and render it.
+ * @return The wrapped step.
+ */
+template <typename Policy>
+std::size_t LaneTimeline::renderWith(RenderedFrame& slot, const PreparedText& text, std::uint64_t step,
+                                       std::size_t firstRow, std::size_t totalRows, bool anchored) {
+    const std::size_t wrapped = static_cast<std::size_t>(step % Policy::period(text));
+    renderFrame<Policy>(slot, text, Policy::at(wrapped, text), firstRow, totalRows, anchored);
+    return wrapped;
+}
+
+/**
+ * @brief Every pipeline is instantiated here once, indexed by ScrollMode.
+ */
+LaneTimeline::Pipeline LaneTimeline::pipelineFor(ScrollMode mode) {
+    static constexpr Pipeline kPipelines[] = {
+        &LaneTimeline::renderWith<ScrollLeft>,
+        &LaneTimeline::renderWith<ScrollRight>,
+        &LaneTimeline::renderWith<ScrollBounce>,
+        &LaneTimeline::renderWith<ScrollVertical>,
+    };
+    static_assert(std::size(kPipelines) == kScrollModeCount, "one pipeline per ScrollMode");
+    static_assert(ScrollLeft::mode == ScrollMode{0} && ScrollRight::mode == ScrollMode{1}
+                  && ScrollBounce::mode == ScrollMode{2} && ScrollVertical::mode == ScrollMode{3},
+                  "kPipelines is indexed by ScrollMode");
+    return kPipelines[static_cast<std::size_t>(mode) % kScrollModeCount];
+}
+
+/**
+ * @brief Start at tick 0 with every lane at its start step.
+ */
+void LaneTimeline::reset(const std::vector<MarqueeLane>& lanes, std::span<const std::size_t> startSteps,
+                         Clock::time_point start, Clock::duration period) {
+    base = start;
+    interval = period;
+    k = 0;
+
+    clocks.resize(lanes.size());
+    totalRows = 0;
+    for (std::size_t i = 0; i < lanes.size(); ++i) {
+        const MarqueeLane& lane = lanes[i];
+        const double from = i < startSteps.size() ? static_cast<double>(startSteps[i]) : 0.0;
+        clocks[i] = LaneClock{lane.text, pipelineFor(lane.mode), from, lane.velocity, 0, totalRows};
+        totalRows += std::max<std::size_t>(lane.text->rows(), 1);
+    }
+    seek(base);
+}
+
+/**
+ * @brief Bring lane i's step to time t and queue when it next changes (never, when it stands still).
+ */
+void LaneTimeline::advance(std::size_t i, Clock::time_point t) {
+    LaneClock& lane = clocks[i];
+    const double elapsed = std::chrono::duration<double>(t - base).count();
+    lane.step = static_cast<std::uint64_t>(std::max(0.0, std::floor(lane.basePosition + lane.velocity * elapsed)));
+    if (lane.velocity <= 0) return;
+
+    const double after = (static_cast<double>(lane.step) + 1 - lane.basePosition) / lane.velocity;
+    if (after > kMaxLaneWaitSeconds) return;  // effectively stopped
+    auto at = base + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(after));
+    if (at <= t) at = t + Clock::duration{1};  // rounding: look again on the next tick
+    heap.emplace(at, i);
+}
+
+/**
+ * @brief The next tick is the first one at or after the earliest step change.
+ */
+bool LaneTimeline::next() {
+    if (heap.empty()) return false;
+
+    const auto soonest = heap.top().first - base;
+    k = std::max<std::uint64_t>(k + 1, static_cast<std::uint64_t>((soonest + interval - Clock::duration{1}) / interval));
+    const auto at = due();
+    while (!heap.empty() && heap.top().first <= at) {
+        const std::size_t lane = heap.top().second;
+        heap.pop();
+        advance(lane, at);
+    }
+    return true;
+}
+
+/**
+ * @brief Re-evaluate every lane at the tick containing t (timeline start, or after falling behind).
+ */
+void LaneTimeline::seek(Clock::time_point t) {
+    k = t > base ? static_cast<std::uint64_t>((t - base) / interval) : 0;
+    while (!heap.empty()) heap.pop();  // keeps its storage: re-seeking never allocates
+    for (std::size_t i = 0; i < clocks.size(); ++i) advance(i, due());
+}
+
+/**
+ * @brief Draw every lane (inline, before the prompt exists, only lane 0's first row).
+ */
+void LaneTimeline::compose(RenderedFrame& slot, bool anchored) const {
+    slot.size = 0;
+    slot.sgrBytes = 0;
+    slot.anchored = anchored;
+    slot.rows = anchored ? totalRows : 0;
+    slot.lanes = anchored ? clocks.size() : std::min<std::size_t>(clocks.size(), 1);
+    for (std::size_t i = 0; i < slot.lanes; ++i) {
+        const LaneClock& lane = clocks[i];
+        slot.steps[i] = lane.render(slot, *lane.text, lane.step, lane.firstRow, totalRows, anchored);
+    }
+    if (anchored) slot.append("\x1b[u");                 // restore to prompt again
+}
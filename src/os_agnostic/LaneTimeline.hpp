@@ -0,0 +1,154 @@
+/**
+ * @file LaneTimeline.hpp
+ * @brief Scroll timeline of the marquee lanes and the frame they compose (no threads, no terminal).
+ */
+
+#pragma once
+
+#include "MarqueeState.hpp"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <queue>
+#include <span>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief One marquee frame rendered ahead of time, escape sequences included.
+ *
+ * Lives inside a FrameRing slot and is overwritten in place. One frame draws
+ * every lane. Frames larger than the slot are clipped (a terminal row never
+ * needs that much anyway).
+ */
+struct RenderedFrame {
+    static constexpr std::size_t kCapacity = 16384;
+
+    std::array<char, kCapacity> bytes{};
+    std::size_t size{0};
+    std::uint64_t generation{0};  // MarqueeState::Control::textGeneration the frame was rendered from
+    std::uint64_t timing{0};      // MarqueeState::Control::timingGeneration the frame was scheduled under
+    std::chrono::steady_clock::time_point due{};  // when the frame should be on screen
+    std::array<std::size_t, MarqueeState::kMaxLanes> steps{};  // scroll step of each lane drawn (within its policy's period)
+    std::size_t lanes{0};         // lanes drawn (only lane 0 when inline)
+    std::size_t rows{0};          // rows drawn above the prompt (0 when inline)
+    std::size_t sgrBytes{0};      // colour/attribute bytes within size
+    bool anchored{false};         // drawn relative to the prompt anchor
+
+    /** @brief Append raw bytes, clipping at the slot capacity. */
+    void append(std::string_view s) {
+        const std::size_t n = std::min(s.size(), kCapacity - size);
+        s.copy(bytes.data() + size, n);
+        size += n;
+    }
+
+    std::string_view view() const { return {bytes.data(), size}; }
+};
+
+/**
+ * @brief Where every lane is at each tick of a fixed-interval timeline.
+ *
+ * Tick k is at base + k * interval, and each lane shows
+ * basePosition + velocity * (k * interval) there, so the refresh rate only
+ * changes how smooth the motion is, not how fast it goes. A min-heap of
+ * each lane's next step change lets next() skip ticks where nothing moves.
+ *
+ * Time is whatever the caller says it is: the display thread feeds it the
+ * steady clock, the headless runner a virtual one.
+ */
+class LaneTimeline {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     * @brief Start a timeline at tick 0.
+     * @param lanes Lanes in screen order (at most MarqueeState::kMaxLanes).
+     * @param startSteps Step each lane shows at base (missing entries start at 0).
+     * @param base Time of tick 0.
+     * @param interval Time between ticks.
+     */
+    void reset(const std::vector<MarqueeLane>& lanes, std::span<const std::size_t> startSteps,
+               Clock::time_point base, Clock::duration interval);
+
+    /**
+     * @brief Move to the first later tick where some lane's step changes.
+     * @return false (and stay put) when every lane stands still.
+     */
+    bool next();
+
+    /** @brief Jump to the tick at or just before t and re-evaluate every lane. */
+    void seek(Clock::time_point t);
+
+    /** @brief Time of the current tick. */
+    Clock::time_point due() const { return base + k * interval; }
+
+    /** @brief Time between ticks. */
+    Clock::duration period() const { return interval; }
+
+    /** @brief Index of the current tick. */
+    std::uint64_t tick() const { return k; }
+
+    /** @brief Rows of all lanes together (an empty text still takes one). */
+    std::size_t rows() const { return totalRows; }
+
+    /**
+     * @brief Draw every lane at the current tick into slot (overwriting it).
+     *
+     * Anchored frames draw each lane row at its line above the saved prompt
+     * anchor and end on the anchor; inline frames draw only lane 0's first row.
+     *
+     * Fills size, sgrBytes, anchored, rows, lanes and steps; the caller
+     * stamps generation, timing and due.
+     */
+    void compose(RenderedFrame& slot, bool anchored) const;
+
+private:
+    /**
+     * @brief One pre-instantiated render pipeline (a scroll policy baked into the frame loop).
+     * @return The step actually drawn, wrapped to the policy's period.
+     */
+    using Pipeline = std::size_t (*)(RenderedFrame& slot, const PreparedText& text, std::uint64_t step,
+                                     std::size_t firstRow, std::size_t totalRows, bool anchored);
+
+    /** @brief The pipeline for mode (looked up when the mode changes, never per frame). */
+    static Pipeline pipelineFor(ScrollMode mode);
+
+    /** @brief Pipeline body: draw step of Policy into slot. */
+    template <typename Policy>
+    static std::size_t renderWith(RenderedFrame& slot, const PreparedText& text, std::uint64_t step,
+                                  std::size_t firstRow, std::size_t totalRows, bool anchored);
+
+    /** @brief Render one lane's rows into slot, reading rows and columns as Policy says. */
+    template <typename Policy>
+    static void renderFrame(RenderedFrame& slot, const PreparedText& text, const ScrollFrame& at,
+                            std::size_t firstRow, std::size_t totalRows, bool anchored);
+
+    /** @brief Bring lane i's step to time t and queue its next change. */
+    void advance(std::size_t i, Clock::time_point t);
+
+    /** @brief Scroll state of one lane. */
+    struct LaneClock {
+        std::shared_ptr<const PreparedText> text;
+        Pipeline render{nullptr};
+        double basePosition{0};  // step shown at base
+        double velocity{0};      // steps per second
+        std::uint64_t step{0};   // unwrapped step at the current tick
+        std::size_t firstRow{0}; // rows of the lanes above this one
+    };
+
+    using Due = std::pair<Clock::time_point, std::size_t>;  // (next step change, lane)
+
+    static constexpr std::size_t kRowMoveBytes = 16;      // most bytes of one "restore, n lines up, clear" prefix
+    static constexpr double kMaxLaneWaitSeconds = 1e6;    // a lane slower than one step per this is treated as stopped
+
+    std::vector<LaneClock> clocks;
+    std::priority_queue<Due, std::vector<Due>, std::greater<Due>> heap;
+    Clock::time_point base{};
+    Clock::duration interval{1};
+    std::uint64_t k{0};
+    std::size_t totalRows{0};
+};
@@ -0,0 +1,31 @@
+/**
+ * @file LockCommands.cpp
+ * @brief The "locks" commands: lock contention profiles.
+ */
+
+#include "CommandHandler.hpp"
+#include "CommandArgs.hpp"
+#include "CommandFeedback.hpp"
+
+/**
+ * @brief Run one "locks", "locks <name>" or "locks reset" line.
+ *
+ * Profiles are only kept in builds with MARQUEE_PROFILE_LOCKS (see
+ * ProfiledMutex); otherwise the report says so.
+ *
+ * @param line The whole command line (for the echo).
+ * @param rest Everything after "locks".
+ */
+void CommandHandler::handleLocks(std::string_view line, std::string_view rest) {
+  std::pmr::memory_resource* mr = commandArena.resource();
+  const std::string_view sub = trimView(rest);
+  if (sub == "reset") {
+    ProfiledMutex::reset();
+    paintMessage(ctx, mr, line, ProfiledMutex::kEnabled ? "Lock profiles cleared." : "Lock profiling is off.");
+    return;
+  }
+  const std::string report = ProfiledMutex::report(sub);
+  paintEchoFeedbackMarqueePrompt(ctx, mr, line, [&](std::pmr::string& out){
+    out += report;
+  });
+}
@@ -4,6 +4,9 @@
  */
 
 #include "MarqueeConsole.hpp"
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
 #include <iostream>
 #include <chrono>
 
@@ -12,57 +15,128 @@
  *
  * Configures the command, keyboard, and display.
  * and uses callback binding and handler injection to connect them.
+ * Each of them is registered as a handler; other components add theirs
+ * through handlers() before run().
  */
 MarqueeConsole::MarqueeConsole():
     ctx(),
+    scheduler(ctx),
     display(ctx),
     keyboard(ctx),
-    command(ctx)
+    command(ctx),
+    timers(ctx),
+    playlist(ctx),
+    follower(ctx)
 {
-    // Hands off the display to the command processor.
-    command.addDisplayHandler(&display);
+    // Ask the terminal what it supports before the keyboard thread owns stdin;
+    // the chosen output path is fixed from here on.
+    ctx.terminal.setCaps(ctx.terminal.probe(150));
+
+    // Every handler writes to the screen through the scheduler.
+    ctx.screen = &scheduler;
+    ctx.handlers = &registry;
+    ctx.timers = &timers;
+    ctx.playlist = &playlist;
+    ctx.follower = &follower;
 
     // Commands entered by the user are given to the command processor via the keyboard.
-    keyboard.setSink([this](std::string cmd) {
-        command.enqueue(std::move(cmd));
+    keyboard.setSink([this](std::string_view cmd) {
+        command.enqueue(cmd);
+    });
+
+    // Due "at" and "every" commands take the same way in.
+    timers.setSink([this](std::string_view cmd) {
+        command.enqueue(cmd);
     });
+
+    registry.add({"display", std::ref(display), [this](EventLoop& loop) { return display.runCoroutine(loop); }});
+    registry.add({"keyboard", std::ref(keyboard), [this](EventLoop& loop) { return keyboard.runCoroutine(loop); }});
+    registry.add({"command", std::ref(command), [this](EventLoop& loop) { return command.runCoroutine(loop); }});
+    registry.add({"timers", std::ref(timers), [this](EventLoop& loop) { return timers.runCoroutine(loop); }, true});
+    registry.add({"playlist", std::ref(playlist), [this](EventLoop& loop) { return playlist.runCoroutine(loop); }, true});
+    registry.add({"follow", std::ref(follower), [this](EventLoop& loop) { return follower.runCoroutine(loop); }, true});
 }
 
 /**
  * @brief manages the lifecycle until shutdown, launches all worker threads.
  *
- * Launches a supervisor thread along with the handlers for display, keyboard input, and commands.
- * This is idle until shutdown is requested, after waiting for all threads to reach the init barrier.
+ * Starts every registered handler on its own jthread; the calling thread
+ * meets them at the registry's init barrier, then sleeps until exit is
+ * requested: nothing polls for it. On exit every handler gets a stop
+ * request, which also wakes whatever wait it is in, and the whole
+ * shutdown runs under the watchdog (see kShutdownLimit).
  */
-void MarqueeConsole::run() {
-    // Launch core handler threads
-    threads.emplace_back(std::ref(display));
-    threads.emplace_back(std::ref(keyboard));
-    threads.emplace_back(std::ref(command));
-
-    // A fourth participant in the barrier: the supervisor thread
-    threads.emplace_back([this] {
-        // >>> JOIN INIT PHASE
-        ctx.phase_barrier.arrive_and_wait();
-
-        // Supervisor loop: spin until exit is requested
-        while (!ctx.exitRequested.load()) {
-            std::this_thread::sleep_for(std::chrono::milliseconds(50));
-        }
-
-        // Optional user feedback (removed this bc of duplicates)
-        // {
-        //     std::lock_guard<std::mutex> lock(ctx.coutMutex);
-        //     std::cout << "\nExiting..." << std::endl;
-        // }
-
-        // Count down to let others know we're done
-        ctx.stop_latch.count_down();
-    });
+void MarqueeConsole::run(ConsoleRuntime runtime) {
+    if (runtime == ConsoleRuntime::Coroutines) {
+        runCoroutines();
+        return;
+    }
+
+    ProfiledMutex::setThreadName("main");
+    registry.start();
 
-    // Wait until all threads finish gracefully
-    ctx.stop_latch.wait();
-    for (auto& t : threads) {
-        if (t.joinable()) t.join();
+    ctx.waitForExit();
+    startWatchdog();
+
+    // Ask everyone at once, then join: the slowest handler sets the pace, not the sum.
+    registry.stop();
+
+    // Give queued output a bounded chance to reach the terminal.
+    {
+        std::lock_guard<ConsoleMutex> lock(ctx.coutMutex);
+        ctx.terminal.drain(kDrainMs);
     }
 }
+
+/**
+ * @brief Arm the hard shutdown limit, counted from the exit request.
+ *
+ * The watchdog only holds copies, so it is safe while the console is torn
+ * down around it. It is destroyed last (it is the first member), which
+ * stops it once the teardown is complete.
+ */
+void MarqueeConsole::startWatchdog() {
+    watchdog = std::jthread([deadline = ctx.exitTime() + kShutdownLimit](std::stop_token stop) {
+        std::mutex m;
+        std::condition_variable_any cv;
+        std::unique_lock<std::mutex> lock(m);
+        cv.wait_until(lock, stop, deadline, [] { return false; });
+        if (stop.stop_requested()) return;
+
+        // Something is stuck: exiting without cleanup beats being killed by a supervisor.
+        // _Exit skips ~Scanner and ~Terminal, so give the shell its modes back first.
+        Terminal::restoreModes();
+        std::fputs("\nShutdown took too long; exiting anyway.\n", stderr);
+        std::_Exit(1);
+    });
+}
+
+/**
+ * @brief One thread, one event loop: every handler with a coroutine body runs on it.
+ *
+ * The loop sleeps on the scheduler's FrameTimer, so the display's deadline,
+ * a keystroke and a deferred echo all end the same wait. There is no
+ * barrier or supervisor: everything starts on the first round, and once
+ * exit is requested the loop resumes every waiter and returns when the
+ * last coroutine has finished. Handlers without a coroutine body still
+ * get threads, and then the console output lock stays a real lock.
+ */
+void MarqueeConsole::runCoroutines() {
+    if (registry.coroutineOnly()) ctx.coutMutex.setSingleThreaded();
+    ctx.runtime = "coroutines";
+    ProfiledMutex::setThreadName("event loop");
+
+    EventLoop loop(scheduler.pacer());
+    ctx.loop = &loop;
+
+    registry.start(&loop);
+    loop.run([this] {
+        if (!ctx.exitRequested.load()) return false;
+        startWatchdog();
+        return true;
+    });
+    registry.stop();
+    ctx.loop = nullptr;
+
+    ctx.terminal.drain(kDrainMs);
+}
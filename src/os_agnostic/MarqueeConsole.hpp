@@ -7,10 +7,22 @@
 
 #include "Context.hpp"
 #include "DisplayHandler.hpp"
+#include "FollowHandler.hpp"
 #include "KeyboardHandler.hpp"
 #include "CommandHandler.hpp"
+#include "CoroRuntime.hpp"
+#include "FrameScheduler.hpp"
+#include "HandlerRegistry.hpp"
+#include "PlaylistHandler.hpp"
+#include "TimerHandler.hpp"
+#include <chrono>
 #include <thread>
-#include <vector>
+
+/** @brief How the handlers are run. */
+enum class ConsoleRuntime {
+    Threads,     // one thread per handler plus a supervisor (the default)
+    Coroutines,  // every handler a coroutine on one event loop, on the calling thread
+};
 
 /**
  * @brief The top-level console controller that connects everything.
@@ -21,22 +33,70 @@
 */
 class MarqueeConsole {
 public:
-    
+    /**
+     * @brief Longest the console may take from an exit request to the end of its teardown.
+     *
+     * Past it, the watchdog ends the process on the spot. Kept under the
+     * 100 ms a process supervisor allows before it kills us.
+     */
+    static constexpr std::chrono::milliseconds kShutdownLimit{80};
+
+    /** @brief Of which queued output may take this long to reach the terminal. */
+    static constexpr int kDrainMs = 40;
+
+
     // Constructs the console and initializes connections of the handlers.
     MarqueeConsole();
 
     /**
      * @brief starts the console system and keeps it running until it shuts down.
      *
-     * Launches every worker thread, including the supervisor thread that
-     * watches for the exit signal. Joins everything at shutdown.
+     * Threads: launches every worker thread, then waits for the exit request
+     * and stops and joins them all.
+     *
+     * Coroutines: runs the display, keyboard and command loops as coroutines
+     * on this thread; the console output lock becomes a no-op.
+     *
+     * @param runtime Which of the two.
      */
-    void run();
+    void run(ConsoleRuntime runtime = ConsoleRuntime::Threads);
+
+    /**
+     * @brief Pin and/or raise the priority of the display side before run().
+     *
+     * What each thread actually got is shown by stats and jitter.
+     *
+     * @param display For the display thread, which issues every terminal
+     *        write (under --runtime=coro: the event loop thread).
+     * @param render For the render-ahead thread (threads runtime only).
+     */
+    void tuneThreads(const ThreadTuning& display, const ThreadTuning& render) {
+        ctx.displayTuning = display;
+        ctx.renderTuning = render;
+    }
+
+    /** @brief Where handlers are registered; add yours before run(). */
+    HandlerRegistry& handlers() { return registry; }
+
+    /** @brief When exit was requested; the shutdown latency is measured from here. */
+    std::chrono::steady_clock::time_point exitTime() const { return ctx.exitTime(); }
 
 private:
+    /** @brief Run every handler as a coroutine on one EventLoop until exit. */
+    void runCoroutines();
+
+    /** @brief Start the watchdog that enforces kShutdownLimit. */
+    void startWatchdog();
+
+    std::jthread watchdog;                  // first member: outlives the rest of the teardown
+
     MarqueeContext ctx;                     // shared state across all handlers
+    FrameScheduler scheduler;               // composes every screen update (one write per tick)
     DisplayHandler display;                 // renders the animated marquee onto the console
     KeyboardHandler keyboard;               // captures inputs from keystrokes
     CommandHandler command;                 // processes and executes the corresponding actions of commands
-    std::vector<std::thread> threads;       // all handler and supervisor threads
+    TimerHandler timers;                    // feeds scheduled commands to the command handler
+    PlaylistHandler playlist;               // rotates the main marquee through prepared texts
+    FollowHandler follower;                 // appends what another process writes to a file
+    HandlerRegistry registry;               // every handler, started and stopped together
 };
@@ -0,0 +1,60 @@
+/**
+ * @file MarqueeEngine.cpp
+ * @brief Keeps a LaneTimeline in step with a MarqueeState.
+ */
+
+#include "MarqueeEngine.hpp"
+#include <algorithm>
+#include <array>
+#include <mutex>
+
+/**
+ * @brief Rebuild the timeline when a generation moved.
+ */
+bool MarqueeEngine::sync(Clock::time_point now) {
+    const MarqueeState::Control c = st.control();
+    if (c.textGeneration == generation && c.timingGeneration == timing) return false;
+
+    // One snapshot: the steps (a splice's adjusted one included) belong to
+    // these lanes, and the frames are tagged with their generations.
+    std::array<std::size_t, MarqueeState::kMaxLanes> shown{};
+    const auto lanes = st.snapshotLanes(shown, generation, timing);
+    timeline.reset(*lanes, shown, now, std::max<Clock::duration>(st.frameInterval(), Clock::duration{1}));
+    return true;
+}
+
+/**
+ * @brief Never render frames whose moment has already passed.
+ */
+bool MarqueeEngine::catchUp(Clock::time_point now) {
+    if (timeline.due() + timeline.period() >= now) return false;
+    timeline.seek(now);
+    return true;
+}
+
+void MarqueeEngine::render(RenderedFrame& frame, bool anchored) const {
+    timeline.compose(frame, anchored);
+    frame.generation = generation;
+    frame.timing = timing;
+    frame.due = timeline.due();
+}
+
+/**
+ * @brief A step lower than the last one shown on the same timeline means the lane wrapped: one more cycle.
+ *
+ * The generations are checked under textMutex, where every lane edit
+ * bumps them and stores its steps: a frame of lanes that were edited or
+ * removed since it was rendered leaves the new steps alone.
+ */
+void MarqueeEngine::markShown(const RenderedFrame& frame) {
+    std::lock_guard<ProfiledMutex> lock(st.textMutex);
+    const MarqueeState::Control c = st.control();
+    if (frame.generation != c.textGeneration || frame.timing != c.timingGeneration) return;
+    const bool sameTimeline = frame.generation == shownGeneration && frame.timing == shownTiming;
+    for (std::size_t i = 0; i < frame.lanes; ++i) {
+        if (sameTimeline && frame.steps[i] < st.laneSteps[i].load()) st.laneCycles[i].fetch_add(1);
+        st.laneSteps[i].store(frame.steps[i]);
+    }
+    shownGeneration = frame.generation;
+    shownTiming = frame.timing;
+}
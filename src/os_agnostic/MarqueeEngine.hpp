@@ -0,0 +1,85 @@
+/**
+ * @file MarqueeEngine.hpp
+ * @brief Turns a MarqueeState into timed frames (no threads, no terminal).
+ */
+
+#pragma once
+
+#include "LaneTimeline.hpp"
+#include "MarqueeState.hpp"
+#include <chrono>
+#include <cstdint>
+
+/**
+ * @brief The scroll engine: follows a MarqueeState and renders its lanes frame by frame.
+ *
+ * The caller owns the loop and the clock. A render loop looks like
+ *
+ *     if (engine.sync(now)) { render now }            // lanes or pacing changed
+ *     else if (engine.next()) { engine.catchUp(now); render }
+ *     else { wait for state.changeSignal }            // every lane stands still
+ *
+ * where "render" is engine.render(frame, anchored). The display thread
+ * drives it with the steady clock; HeadlessRunner drives it with a virtual
+ * one. Only one thread may drive an engine. The state it follows may be
+ * changed from any thread (through MarqueeState or a CommandProcessor).
+ */
+class MarqueeEngine {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit MarqueeEngine(MarqueeState& state) : st(state) {}
+
+    /** @brief The state this engine follows. */
+    MarqueeState& state() { return st; }
+
+    /**
+     * @brief Re-anchor the timeline if the lanes or the pacing changed since the last call.
+     *
+     * Every lane continues from the step last marked shown (text and mode
+     * setters reset their lane's step).
+     *
+     * @param now Time of the new timeline's first tick.
+     * @return true if it re-anchored: the current tick must be rendered even if nothing moves.
+     */
+    bool sync(Clock::time_point now);
+
+    /**
+     * @brief Move to the next tick where some lane's step changes.
+     * @return false (and stay put) when every lane stands still.
+     */
+    bool next() { return timeline.next(); }
+
+    /**
+     * @brief Skip to now if the current tick is more than a period behind it.
+     * @return true if ticks were skipped.
+     */
+    bool catchUp(Clock::time_point now);
+
+    /** @brief Draw every lane at the current tick and stamp the frame with its generations and due time. */
+    void render(RenderedFrame& frame, bool anchored) const;
+
+    /**
+     * @brief Make the frame's steps the state's shown steps (where the next sync resumes).
+     *
+     * Also counts each lane's completed cycles (MarqueeState::laneCycles).
+     * A frame rendered before the state's current generations is ignored.
+     * Only touches the state, so the thread that presents frames may call
+     * it while another drives the engine.
+     */
+    void markShown(const RenderedFrame& frame);
+
+    /** @brief Time of the current tick. */
+    Clock::time_point due() const { return timeline.due(); }
+
+    /** @brief Time between ticks. */
+    Clock::duration period() const { return timeline.period(); }
+
+private:
+    MarqueeState& st;
+    LaneTimeline timeline;
+    std::uint64_t generation{~std::uint64_t{0}};  // state generations the timeline was built from
+    std::uint64_t timing{~std::uint64_t{0}};
+    std::uint64_t shownGeneration{~std::uint64_t{0}};  // of the last frame markShown() saw (presenting thread)
+    std::uint64_t shownTiming{~std::uint64_t{0}};
+};
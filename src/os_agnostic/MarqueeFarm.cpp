@@ -0,0 +1,81 @@
+/**
+ * @file MarqueeFarm.cpp
+ * @brief Parallel rendering of virtual marquees.
+ */
+
+#include "MarqueeFarm.hpp"
+#include <algorithm>
+#include <cmath>
+
+/**
+ * @brief Render one frame of an instance: every row, separated by '\n', after a line clear.
+ *
+ * Instance frames are self-contained (no prompt anchor), so a sink can be
+ * replayed on any terminal as-is.
+ *
+ * @return The wrapped step.
+ */
+template <typename Policy>
+std::size_t MarqueeFarm::renderWith(MarqueeSink& sink, const PreparedText& text, std::uint64_t step) {
+    const std::size_t wrapped = static_cast<std::size_t>(step % Policy::period(text));
+    const ScrollFrame at = Policy::at(wrapped, text);
+
+    sink.frame.clear();
+    sink.frame += "\r\x1b[2K";
+    for (std::size_t r = 0; r < text.rows(); ++r) {
+        if (r) sink.frame += "\n\r\x1b[2K";
+        const std::size_t src = Policy::sourceRow(r, at, text.rows());
+        if (src < text.rows()) text.appendRow(sink.frame, src, at.offset, text.width());
+    }
+    ++sink.frames;
+    sink.bytes += sink.frame.size();
+    return wrapped;
+}
+
+/**
+ * @brief Add an instance (not while a tick is running).
+ */
+void MarqueeFarm::add(std::shared_ptr<const PreparedText> text, ScrollMode mode, double velocity) {
+    VirtualMarquee m;
+    m.text = std::move(text);
+    m.velocity = velocity;
+    m.render = withScrollPolicy(mode, [](auto policy) -> VirtualMarquee::Render {
+        return &MarqueeFarm::renderWith<decltype(policy)>;
+    });
+    instances.push_back(std::move(m));
+}
+
+/**
+ * @brief Render every instance at elapsed; the pool splits the instances between its workers.
+ */
+void MarqueeFarm::tick(std::chrono::nanoseconds elapsed) {
+    const double seconds = std::chrono::duration<double>(elapsed).count();
+    auto job = [this, seconds](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i) {
+            VirtualMarquee& m = instances[i];
+            const double position = std::max(0.0, std::floor(m.velocity * seconds));
+            m.step = m.render(m.sink, *m.text, static_cast<std::uint64_t>(position));
+        }
+    };
+    pool.run(instances.size(), kGrain, job);
+}
+
+/**
+ * @brief Render ticks frames of every instance back to back and time them.
+ */
+FarmBenchmark MarqueeFarm::benchmark(std::size_t ticks, double hz) {
+    const auto interval = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::duration<double>(1.0 / hz));
+    const std::uint64_t stealsBefore = pool.stats().steals;
+
+    const auto start = Clock::now();
+    for (std::size_t k = 0; k < ticks; ++k) tick(interval * static_cast<std::int64_t>(k));
+    const auto end = Clock::now();
+
+    FarmBenchmark out;
+    out.workers = pool.size();
+    out.instances = instances.size();
+    out.frames = static_cast<std::uint64_t>(ticks) * instances.size();
+    out.seconds = std::chrono::duration<double>(end - start).count();
+    out.steals = pool.stats().steals - stealsBefore;
+    return out;
+}
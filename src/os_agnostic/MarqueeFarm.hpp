@@ -0,0 +1,108 @@
+/**
+ * @file MarqueeFarm.hpp
+ * @brief Many independent virtual marquees rendered in parallel on a RenderPool.
+ */
+
+#pragma once
+
+#include "PreparedText.hpp"
+#include "RenderPool.hpp"
+#include "ScrollPolicy.hpp"
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Output of one virtual marquee: the latest frame plus running totals.
+ *
+ * This is the in-memory sink a downstream display would read from; the
+ * buffer keeps its capacity, so steady-state frames allocate nothing.
+ */
+struct MarqueeSink {
+    std::string frame;          // last frame written
+    std::uint64_t frames{0};
+    std::uint64_t bytes{0};
+};
+
+/**
+ * @brief One ticker of the farm: a text, a motion and a velocity.
+ *
+ * Instances share their prepared texts; an instance itself is only a few
+ * words of state, so thousands of them fit in cache-friendly arrays.
+ */
+struct VirtualMarquee {
+    using Render = std::size_t (*)(MarqueeSink& sink, const PreparedText& text, std::uint64_t step);
+
+    std::shared_ptr<const PreparedText> text;
+    Render render{nullptr};
+    double velocity{5.0};       // columns (rows, when vertical) per second
+    std::size_t step{0};        // step of the last frame (within its policy's period)
+    MarqueeSink sink;
+};
+
+/** @brief Result of one MarqueeFarm::benchmark() run. */
+struct FarmBenchmark {
+    std::size_t workers{0};
+    std::size_t instances{0};
+    std::uint64_t frames{0};    // instance frames rendered
+    double seconds{0};
+    std::uint64_t steals{0};
+    double framesPerSecond() const { return seconds > 0 ? static_cast<double>(frames) / seconds : 0; }
+};
+
+/**
+ * @brief Renders many marquee instances at a common refresh rate using a work-stealing pool.
+ *
+ * Each tick renders every instance once; instances are the pool's tasks
+ * (kGrain per chunk) and each frame goes to the instance's own sink. The
+ * interactive console is untouched: the farm only reads shared prepared
+ * texts.
+ */
+class MarqueeFarm {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    /** @brief Instances per pool task: enough to amortise a steal, few enough to balance. */
+    static constexpr std::size_t kGrain = 64;
+
+    /**
+     * @brief Create a farm with its own pool.
+     * @param workers Worker threads.
+     */
+    explicit MarqueeFarm(std::size_t workers) : pool(workers) {}
+
+    /** @brief Add an instance showing text with the given motion and velocity. */
+    void add(std::shared_ptr<const PreparedText> text, ScrollMode mode, double velocity);
+
+    /**
+     * @brief Render every instance at time elapsed on the farm's timeline.
+     * @param elapsed Time since the farm started scrolling.
+     */
+    void tick(std::chrono::nanoseconds elapsed);
+
+    std::size_t size() const { return instances.size(); }
+    std::size_t workers() const { return pool.size(); }
+    const VirtualMarquee& instance(std::size_t i) const { return instances[i]; }
+    RenderPoolStats poolStats() const { return pool.stats(); }
+
+    /**
+     * @brief Render ticks frames of every instance as fast as possible.
+     *
+     * Frame k uses the timeline position of a refresh rate of hz, so the
+     * output is what a real-time run would produce, just without the sleeps.
+     *
+     * @return Frames rendered and wall-clock time taken.
+     */
+    FarmBenchmark benchmark(std::size_t ticks, double hz);
+
+private:
+    /** @brief Draw one frame of text for step into sink. */
+    template <typename Policy>
+    static std::size_t renderWith(MarqueeSink& sink, const PreparedText& text, std::uint64_t step);
+
+    RenderPool pool;
+    std::vector<VirtualMarquee> instances;
+};
@@ -0,0 +1,446 @@
+/**
+ * @file MarqueeState.hpp
+ * @brief The marquee's state store: lanes, pacing and run state (no threads, no terminal).
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "PreparedText.hpp"
+#include "ProfiledMutex.hpp"
+#include "ScrollPolicy.hpp"
+#include "SeqLock.hpp"
+
+/**
+ * @brief One independent ticker: its own text, velocity and motion.
+ *
+ * Lanes are stacked top to bottom above the prompt, lane 0 (the main
+ * marquee) first.
+ */
+struct MarqueeLane {
+    std::shared_ptr<const PreparedText> text;
+    double velocity{5.0};                 // columns (rows, when vertical) per second
+    ScrollMode mode{ScrollMode::Left};
+};
+
+/** @brief One edit of a lane's text: bytes [pos, pos + count) replaced by insert. */
+struct TextSplice {
+    std::size_t pos{0};
+    std::size_t count{0};
+    std::string_view insert;
+};
+
+/**
+ * @brief Everything that decides what the marquee shows, safe to share between threads.
+ *
+ * Setters may be called from any thread. Readers get immutable snapshots
+ * (lanes are replaced copy-on-write, never edited in place), and every
+ * change bumps Control::textGeneration or Control::timingGeneration and
+ * wakes changeSignal, so a renderer (MarqueeEngine) knows when to re-read.
+ *
+ * The interactive console extends this with its terminal and thread
+ * plumbing (MarqueeContext); embedders use it on its own.
+ */
+struct MarqueeState {
+public:
+
+    // >>> CONTROL BLOCK (read together, every tick)
+
+    /**
+     * @brief What the display decides each tick by, as one snapshot.
+     *
+     * Published with a SeqLock, so a reader never sees, say, a restarted
+     * marquee together with the previous refresh rate, or with the timing
+     * generation from before the restart.
+     */
+    struct Control {
+        std::int64_t frameIntervalNs{200000000};  // time between marquee frames (set_fps)
+        std::uint64_t textGeneration{0};          // bumped on every text/lane change so stale pre-rendered frames can be dropped
+        std::uint64_t timingGeneration{0};        // bumped when pacing changes so the scroll timeline is re-anchored
+        bool active{false};                       // start_marquee is in effect
+        bool anchored{false};                     // frames go above a console prompt (see MarqueeContext)
+    };
+
+    /** @brief A consistent copy of the control block (two sequence loads when no update races it). */
+    Control control() const {
+        return controlBlock.load();
+    }
+
+    // >>> RUN STATE
+
+    /** @brief Start scrolling; every lane resumes from the step last shown. */
+    void startMarquee() {
+        controlBlock.update([](Control& c) {
+            c.active = true;
+            ++c.timingGeneration;
+        });
+        signalChange();
+    }
+
+    /** @brief Freeze the marquee where it is. */
+    void stopMarquee() {
+        controlBlock.update([](Control& c) { c.active = false; });
+    }
+
+    /** @brief Verify whether the marquee is active. */
+    bool isMarqueeActive() const {
+        return control().active;
+    }
+
+    // >>> MARQUEE STATE (lanes)
+
+    /** @brief Most lanes stacked on screen at once. */
+    static constexpr std::size_t kMaxLanes = 8;
+
+    using LaneList = std::vector<MarqueeLane>;
+
+    ProfiledMutex textMutex{"textMutex"}; // Lock guards the lanes pointer's access
+    std::shared_ptr<const LaneList> lanes{std::make_shared<const LaneList>(LaneList{MarqueeLane{
+        std::make_shared<const PreparedText>("Welcome to Marquee Console!")}})}; // Lane 0 is the main marquee; replaced (copy-on-write), never edited in place.
+    alignas(kCacheLine) std::array<std::atomic<std::size_t>, kMaxLanes> laneSteps{}; // Scroll step of each lane currently on screen (set by the display); written under textMutex.
+    std::array<std::atomic<std::uint64_t>, kMaxLanes> laneCycles{}; // Full periods each lane has completed on screen (counted by the display).
+    alignas(kCacheLine) std::atomic<std::uint32_t> changeSignal{0}; // Bumped and notified after any generation bump (wakes an idle renderer).
+
+    // >>> PACING (refresh rate and scroll velocity are independent)
+
+    /** @brief Set the refresh rate; the scroll velocities are unaffected. */
+    void setFrameInterval(std::chrono::nanoseconds interval) {
+        controlBlock.update([interval](Control& c) {
+            c.frameIntervalNs = interval.count();
+            ++c.timingGeneration;
+        });
+        signalChange();
+    }
+
+    /** @brief Time between marquee frames. */
+    std::chrono::nanoseconds frameInterval() const {
+        return std::chrono::nanoseconds(control().frameIntervalNs);
+    }
+
+    /** @brief Wake anything waiting on changeSignal (also used on exit). */
+    void signalChange() {
+        changeSignal.fetch_add(1);
+        changeSignal.notify_all();
+    }
+
+    // >>> LANE ACCESS
+
+    /** @brief The current lanes (shared, never copied). */
+    std::shared_ptr<const LaneList> getLanes() {
+        std::lock_guard<ProfiledMutex> lock(textMutex);
+        return lanes;
+    }
+
+    /**
+     * @brief The lanes, the steps they are shown at and the generations, read together.
+     *
+     * Lane edits store their steps (a splice's adjusted step included) and
+     * bump the generation under the same lock, so the steps always belong
+     * to these lanes.
+     */
+    std::shared_ptr<const LaneList> snapshotLanes(std::array<std::size_t, kMaxLanes>& steps,
+                                                  std::uint64_t& text, std::uint64_t& timing) {
+        std::lock_guard<ProfiledMutex> lock(textMutex);
+        for (std::size_t i = 0; i < kMaxLanes; ++i) steps[i] = laneSteps[i].load();
+        const Control c = control();
+        text = c.textGeneration;
+        timing = c.timingGeneration;
+        return lanes;
+    }
+
+    /** @brief Get the prepared text of the main marquee (lane 0). */
+    std::shared_ptr<const PreparedText> getPrepared() {
+        std::lock_guard<ProfiledMutex> lock(textMutex);
+        return (*lanes)[0].text;
+    }
+
+    /** @brief Screen rows the lanes take together (an empty text still takes one). */
+    std::size_t layoutRows() {
+        std::size_t rows = 0;
+        for (const auto& lane : *getLanes()) rows += std::max<std::size_t>(lane.text->rows(), 1);
+        return rows;
+    }
+
+    // >>> LANE CHANGES (command thread; each returns false for a lane that does not exist)
+
+    /**
+     * @brief Change the text of a lane; it restarts from its first character.
+     *
+     * The rotation cache is built before taking the lock; readers only ever
+     * see a pointer swap.
+     */
+    bool setLaneText(std::size_t lane, std::string_view s) {
+        const auto current = getLanes();
+        if (lane >= current->size()) return false;
+        auto prepared = std::make_shared<const PreparedText>(s, (*current)[lane].text->effect());
+        bool done = false;
+        editLanes(&Control::textGeneration, [&](LaneList& list) {
+            if (lane >= list.size()) return;  // removed meanwhile
+            list[lane].text = std::move(prepared);
+            laneSteps[lane].store(0);
+            done = true;
+        });
+        return done;
+    }
+
+    /**
+     * @brief Replace bytes [pos, pos + count) of a lane's text with insert, without restarting it.
+     *
+     * pos and count are clamped to the text. A plain text is spliced in
+     * its rope in O(log n) (PreparedText::spliced), outside the lock. The
+     * lane's step moves with the edit (stepAfterSplice), so the characters
+     * on screen stay put unless the edit removed them.
+     */
+    bool spliceLaneText(std::size_t lane, std::size_t pos, std::size_t count, std::string_view insert) {
+        const auto current = getLanes();
+        if (lane >= current->size()) return false;
+        const std::shared_ptr<const PreparedText> was = (*current)[lane].text;
+        auto next = std::make_shared<const PreparedText>(was->spliced(pos, count, insert));
+        bool done = false;
+        editLanes(&Control::textGeneration, [&](LaneList& list) {
+            if (lane >= list.size()) return;
+            MarqueeLane& l = list[lane];
+            if (l.text != was) {  // another edit got in first: splice the newer text instead
+                next = std::make_shared<const PreparedText>(l.text->spliced(pos, count, insert));
+            }
+            const std::size_t at = std::min(pos, l.text->rope().size());
+            const std::size_t erased = std::min(count, l.text->rope().size() - at);
+            laneSteps[lane].store(stepAfterSplice(l.mode, laneSteps[lane].load(), *l.text, *next,
+                                                  at, erased, insert.size()));
+            l.text = std::move(next);
+            done = true;
+        });
+        return done;
+    }
+
+    /**
+     * @brief Apply edits to a lane's text, in order, as one change, if the lane still shows expected.
+     *
+     * Each edit's positions are in the text the edits before it left. The
+     * texts are built outside the lock and readers see only the last one;
+     * the lane's step moves with every edit (stepAfterSplice). A caller
+     * that keeps the returned text can tell later whether the lane still
+     * shows what it published.
+     *
+     * @return The text now on the lane, or nullptr (nothing changed) when
+     *         the lane does not exist or shows another text than expected.
+     */
+    std::shared_ptr<const PreparedText> spliceLaneText(std::size_t lane, std::span<const TextSplice> edits,
+                                                       const PreparedText* expected) {
+        const auto current = getLanes();
+        if (lane >= current->size() || (*current)[lane].text.get() != expected) return nullptr;
+        const std::shared_ptr<const PreparedText> was = (*current)[lane].text;
+        std::vector<std::shared_ptr<const PreparedText>> texts;
+        texts.reserve(edits.size());
+        for (const TextSplice& e : edits) {
+            const PreparedText& before = texts.empty() ? *was : *texts.back();
+            texts.push_back(std::make_shared<const PreparedText>(before.spliced(e.pos, e.count, e.insert)));
+        }
+        if (texts.empty()) return was;
+
+        bool done = false;
+        editLanes(&Control::textGeneration, [&](LaneList& list) {
+            if (lane >= list.size() || list[lane].text != was) return;  // changed meanwhile
+            MarqueeLane& l = list[lane];
+            std::size_t step = laneSteps[lane].load();
+            for (std::size_t i = 0; i < edits.size(); ++i) {
+                const PreparedText& before = i ? *texts[i - 1] : *was;
+                const std::size_t at = std::min(edits[i].pos, before.rope().size());
+                const std::size_t erased = std::min(edits[i].count, before.rope().size() - at);
+                step = stepAfterSplice(l.mode, step, before, *texts[i], at, erased, edits[i].insert.size());
+            }
+            laneSteps[lane].store(step);
+            l.text = texts.back();
+            done = true;
+        });
+        return done ? texts.back() : nullptr;
+    }
+
+    /**
+     * @brief Show an already prepared text on a lane; it restarts from its first character.
+     *
+     * Nothing is built: the lane's pointer is swapped under the lock, so a
+     * text prepared ahead of time (a playlist item) costs the renderer no
+     * more than any other text change.
+     */
+    bool showPrepared(std::size_t lane, std::shared_ptr<const PreparedText> text) {
+        if (lane >= getLanes()->size()) return false;
+        bool done = false;
+        editLanes(&Control::textGeneration, [&](LaneList& list) {
+            if (lane >= list.size()) return;  // removed meanwhile
+            list[lane].text = std::move(text);
+            laneSteps[lane].store(0);
+            done = true;
+        });
+        return done;
+    }
+
+    /** @brief Set the scroll velocity of a lane; the refresh rate is unaffected. */
+    bool setLaneVelocity(std::size_t lane, double columnsPerSecond) {
+        if (lane >= getLanes()->size()) return false;
+        bool done = false;
+        editLanes(&Control::timingGeneration, [&](LaneList& list) {
+            if (lane >= list.size()) return;  // removed meanwhile
+            list[lane].velocity = columnsPerSecond;
+            done = true;
+        });
+        return done;
+    }
+
+    /** @brief Switch the motion of a lane; the new one starts from its first step. */
+    bool setLaneMode(std::size_t lane, ScrollMode mode) {
+        if (lane >= getLanes()->size()) return false;
+        bool done = false;
+        editLanes(&Control::timingGeneration, [&](LaneList& list) {
+            if (lane >= list.size()) return;  // removed meanwhile
+            list[lane].mode = mode;
+            laneSteps[lane].store(0);
+            done = true;
+        });
+        return done;
+    }
+
+    /** @brief Stack a new lane under the others (false when kMaxLanes are in use). */
+    bool addLane(std::string_view s, double columnsPerSecond) {
+        if (getLanes()->size() >= kMaxLanes) return false;
+        auto prepared = std::make_shared<const PreparedText>(s);
+        bool done = false;
+        editLanes(&Control::textGeneration, [&](LaneList& list) {
+            if (list.size() >= kMaxLanes) return;  // filled meanwhile
+            laneSteps[list.size()].store(0);
+            list.push_back(MarqueeLane{std::move(prepared), columnsPerSecond});
+            done = true;
+        });
+        return done;
+    }
+
+    /** @brief Remove a lane; the lanes below move up. Lane 0 stays. */
+    bool removeLane(std::size_t lane) {
+        if (lane == 0 || lane >= getLanes()->size()) return false;
+        bool done = false;
+        editLanes(&Control::textGeneration, [&](LaneList& list) {
+            if (lane >= list.size()) return;  // removed meanwhile
+            list.erase(list.begin() + static_cast<std::ptrdiff_t>(lane));
+            for (std::size_t i = lane; i + 1 < kMaxLanes; ++i) {
+                laneSteps[i].store(laneSteps[i + 1].load());
+                laneCycles[i].store(laneCycles[i + 1].load());
+            }
+            done = true;
+        });
+        return done;
+    }
+
+    // The single-marquee commands act on lane 0.
+    void setText(std::string_view s) { setLaneText(0, s); }
+    void setVelocity(double columnsPerSecond) { setLaneVelocity(0, columnsPerSecond); }
+    void setScrollMode(ScrollMode mode) { setLaneMode(0, mode); }
+
+    /**
+     * @brief Lay a colour/attribute effect over the main marquee's current (and any later) text.
+     *
+     * The text is prepared again with the new style runs, outside the lock;
+     * scrolling carries on from the step on screen.
+     */
+    void setEffect(const TextEffect& effect) {
+        const std::shared_ptr<const PreparedText> was = getPrepared();
+        auto prepared = std::make_shared<const PreparedText>(was->source(), effect);
+        editLanes(&Control::textGeneration, [&](LaneList& list) {
+            if (list[0].text != was) {  // another edit got in first: style the newer text instead
+                prepared = std::make_shared<const PreparedText>(list[0].text->source(), effect);
+            }
+            list[0].text = std::move(prepared);
+        });
+    }
+
+    /**
+     * @brief Append every lane as it is currently shown (laneSteps under each lane's mode).
+     * @param out Any string-like sink with append(std::string_view).
+     * @param rowSeparator Inserted between screen rows.
+     */
+    template <typename Out>
+    void appendVisibleText(Out& out, std::string_view rowSeparator = "\n") {
+        const auto current = getLanes();
+        bool first = true;
+        for (std::size_t l = 0; l < current->size(); ++l) {
+            const MarqueeLane& lane = (*current)[l];
+            const PreparedText& text = *lane.text;
+            withScrollPolicy(lane.mode, [&](auto policy) {
+                using Policy = decltype(policy);
+                const ScrollFrame frame = Policy::at(laneSteps[l].load() % Policy::period(text), text);
+                const std::size_t rows = std::max<std::size_t>(text.rows(), 1);
+                for (std::size_t r = 0; r < rows; ++r) {
+                    if (!first) out.append(rowSeparator);
+                    first = false;
+                    const std::size_t src = text.rows() ? Policy::sourceRow(r, frame, text.rows()) : 0;
+                    if (src < text.rows()) text.appendRow(out, src, frame.offset, text.width());
+                }
+            });
+        }
+    }
+
+    /** @brief Replace every lane at once (at most kMaxLanes; an empty list keeps lane 0); all restart from step 0. */
+    void setLanes(LaneList list) {
+        if (list.empty()) list.push_back(MarqueeLane{getPrepared()});
+        if (list.size() > kMaxLanes) list.resize(kMaxLanes);
+        auto next = std::make_shared<const LaneList>(std::move(list));
+        {
+            std::lock_guard<ProfiledMutex> lock(textMutex);
+            lanes = std::move(next);
+            for (auto& step : laneSteps) step.store(0);
+            controlBlock.update([](Control& c) { ++c.textGeneration; });
+        }
+        signalChange();
+    }
+
+    /** @brief Get a copy of the text that is currently displayed in the marquee. */
+    std::string getText() {
+        return getPrepared()->source();
+    }
+
+protected:
+    /** @brief Change the control block (front ends own some of its fields). */
+    template <typename Edit>
+    void updateControl(Edit&& edit) {
+        controlBlock.update(std::forward<Edit>(edit));
+    }
+
+private:
+    /**
+     * @brief Copy the lanes, apply edit to the copy, publish it and bump a generation.
+     * @param generation The Control counter to bump (textGeneration or timingGeneration).
+     *
+     * The bump happens under textMutex together with the edit's laneSteps
+     * stores, so MarqueeEngine::markShown (which checks the generation under
+     * the same lock) never lets a frame of the old lanes overwrite them.
+     * The list may have changed since the caller checked a lane index, so
+     * edit checks it again against the copy.
+     */
+    template <typename Edit>
+    bool editLanes(std::uint64_t Control::*generation, Edit&& edit) {
+        {
+            std::lock_guard<ProfiledMutex> lock(textMutex);
+            auto next = std::make_shared<LaneList>(*lanes);
+            edit(*next);
+            lanes = std::move(next);
+            controlBlock.update([generation](Control& c) { ++(c.*generation); });
+        }
+        signalChange();
+        return true;
+    }
+
+
+    SeqLock<Control> controlBlock;  // own cache line: read every tick, written by commands
+};
@@ -0,0 +1,158 @@
+/**
+ * @file PlaylistCommands.cpp
+ * @brief The "playlist" commands.
+ */
+
+#include "CommandHandler.hpp"
+#include "CommandArgs.hpp"
+#include "CommandFeedback.hpp"
+#include "HandlerRegistry.hpp"
+#include "PlaylistHandler.hpp"
+#include <fstream>
+
+/**
+ * @brief Run one "playlist ..." line.
+ *
+ * Items are prepared here, when they are added, so the PlaylistHandler's
+ * switches are pointer swaps. The handler is started by the first
+ * "playlist start".
+ *
+ * @param line The whole command line (for the echo).
+ * @param rest Everything after "playlist".
+ */
+void CommandHandler::handlePlaylist(std::string_view line, std::string_view rest) {
+  std::pmr::memory_resource* mr = commandArena.resource();
+  PlaylistHandler& playlist = *ctx.playlist;
+  std::pmr::string sub{takeWord(rest), mr};
+  toLowerInPlace(sub);
+  const std::string_view arg = trimView(rest);
+
+  // >>> PLAYLIST ADD / ADD_FILE (prepared now, with the main marquee's effect)
+  if ((sub == "add" || sub == "add_file") && !arg.empty()) {
+    std::string text;
+    if (sub == "add") {
+      appendMarqueeText(text, arg);
+    } else {
+      std::ifstream in{std::string{arg}, std::ios::binary};
+      std::string raw;
+      if (in) {
+        raw.resize(kMaxArtFileBytes + 1);
+        in.read(raw.data(), static_cast<std::streamsize>(raw.size()));
+        raw.resize(static_cast<std::size_t>(in.gcount()));
+      }
+      if (!in.is_open() || in.bad() || raw.size() > kMaxArtFileBytes) {
+        paintMessage(ctx, mr, line, in.is_open() && !in.bad() ? "Cannot add: the file is over 1 MiB." : "Cannot add: the file cannot be read.");
+        return;
+      }
+      for (char ch : raw) {
+        if (ch != '\r') text += ch;  // CRLF art reads the same as LF
+      }
+      while (!text.empty() && text.back() == '\n') text.pop_back();
+      text += ' ';  // the gap set_text adds
+    }
+
+    const bool added = playlist.add(std::make_shared<const PreparedText>(text, ctx.getPrepared()->effect()));
+    const std::size_t count = playlist.status().items.size();
+    paintEchoFeedbackMarqueePrompt(ctx, mr, line, [&](std::pmr::string& out){
+      if (!added) {
+        out += "The playlist is full (";
+        appendNumber(out, PlaylistHandler::kMaxItems);
+        out += " items).\n";
+        return;
+      }
+      out += "Item ";   appendNumber(out, count - 1);
+      out += " added (";
+      appendNumber(out, count);
+      out += count == 1 ? " item).\n" : " items).\n";
+    });
+    return;
+  }
+
+  // >>> PLAYLIST ROTATE (a bare count is cycles, anything with a unit is a time)
+  if (sub == "rotate" && !arg.empty()) {
+    std::size_t cycles = 0;
+    std::chrono::nanoseconds interval{0};
+    const bool byCycles = parseCount(arg, cycles);
+    if (byCycles && cycles > 0) {
+      playlist.rotateAfterCycles(cycles);
+    } else if (!byCycles && parseDuration(arg, interval) && interval >= std::chrono::milliseconds(100)) {
+      playlist.rotateAfter(interval);
+    } else {
+      paintMessage(ctx, mr, line, "Usage: playlist rotate <cycles (1 or more)|interval (100ms or more)>");
+      return;
+    }
+    paintEchoFeedbackMarqueePrompt(ctx, mr, line, [&](std::pmr::string& out){
+      out += "Playlist rotates after ";
+      if (byCycles) {
+        appendNumber(out, cycles);
+        out += cycles == 1 ? " cycle.\n" : " cycles.\n";
+      } else {
+        appendDuration(out, interval);
+        out += ".\n";
+      }
+    });
+    return;
+  }
+
+  // >>> PLAYLIST START / NEXT / STOP / CLEAR
+  if ((sub == "start" || sub == "next") && arg.empty()) {
+    // The handler's thread prepares items ahead of their turn, so it runs for either.
+    if (!ctx.handlers->ensureStarted("playlist")) {
+      paintMessage(ctx, mr, line, "Cannot start: the console is shutting down.");
+      return;
+    }
+    if (sub == "next") {
+      paintMessage(ctx, mr, line, playlist.next() ? "Next item shown." : "The playlist is empty.");
+      return;
+    }
+    paintMessage(ctx, mr, line, playlist.start() ? "Playlist started." : "The playlist is empty (playlist add <text>).");
+    return;
+  }
+  if (sub == "stop" && arg.empty()) {
+    playlist.stop();
+    paintMessage(ctx, mr, line, "Playlist stopped.");
+    return;
+  }
+  if (sub == "clear" && arg.empty()) {
+    playlist.clear();
+    paintMessage(ctx, mr, line, "Playlist cleared.");
+    return;
+  }
+
+  // >>> PLAYLIST LIST
+  if (sub == "list" && arg.empty()) {
+    constexpr std::size_t kPreview = 40;
+    const PlaylistStatus st = playlist.status();
+    paintEchoFeedbackMarqueePrompt(ctx, mr, line, [&](std::pmr::string& out){
+      out += st.running ? "Playlist running, " : "Playlist stopped, ";
+      out += "rotates after ";
+      if (st.cycles) {
+        appendNumber(out, st.cycles);
+        out += st.cycles == 1 ? " cycle" : " cycles";
+      } else {
+        appendDuration(out, st.interval);
+      }
+      out += "; ";              appendNumber(out, st.switches);
+      out += " switches, ";     appendNumber(out, st.reprepared);
+      out += " re-prepared for a new effect\n";
+      for (std::size_t i = 0; i < st.items.size(); ++i) {
+        const std::string src = st.items[i]->source();
+        out += i == st.current ? "* " : "  ";
+        appendNumber(out, i);
+        out += ": \"";
+        for (std::size_t c = 0; c < src.size() && c < kPreview; ++c) {
+          if (src[c] == '\n') out += "\\n"; else out += src[c];
+        }
+        out += src.size() > kPreview ? "...\" (" : "\" (";
+        appendNumber(out, st.items[i]->rows());
+        out += "x";
+        appendNumber(out, st.items[i]->width());
+        out += ")\n";
+      }
+    });
+    return;
+  }
+
+  paintMessage(ctx, mr, line, "Usage: playlist add <text> | add_file <path> | rotate <cycles|interval>"
+                              " | start | stop | next | list | clear");
+}
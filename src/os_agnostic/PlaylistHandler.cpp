@@ -0,0 +1,203 @@
+/**
+ * @file PlaylistHandler.cpp
+ * @brief Rotates the main marquee through a list of texts prepared ahead of time.
+ */
+
+#include "PlaylistHandler.hpp"
+#include "FrameScheduler.hpp"
+#include "ScrollPolicy.hpp"
+#include <algorithm>
+#include <mutex>
+
+bool PlaylistHandler::add(std::shared_ptr<const PreparedText> text) {
+    {
+        std::lock_guard<ProfiledMutex> lock(m);
+        if (items.size() >= kMaxItems) return false;
+        items.push_back(std::move(text));
+    }
+    kick();  // a second item makes a running playlist rotate
+    return true;
+}
+
+void PlaylistHandler::clear() {
+    {
+        std::lock_guard<ProfiledMutex> lock(m);
+        items.clear();
+        current = 0;
+        running = false;
+    }
+    kick();
+}
+
+void PlaylistHandler::rotateAfterCycles(std::size_t n) {
+    {
+        std::lock_guard<ProfiledMutex> lock(m);
+        cycles = std::max<std::size_t>(n, 1);
+    }
+    kick();
+}
+
+void PlaylistHandler::rotateAfter(std::chrono::nanoseconds d) {
+    {
+        std::lock_guard<ProfiledMutex> lock(m);
+        cycles = 0;
+        interval = d;
+    }
+    kick();
+}
+
+bool PlaylistHandler::start() {
+    {
+        std::lock_guard<ProfiledMutex> lock(m);
+        if (items.empty()) return false;
+        running = true;
+        show(current);
+    }
+    kick();
+    return true;
+}
+
+void PlaylistHandler::stop() {
+    {
+        std::lock_guard<ProfiledMutex> lock(m);
+        running = false;
+    }
+    kick();
+}
+
+bool PlaylistHandler::next() {
+    {
+        std::lock_guard<ProfiledMutex> lock(m);
+        if (items.empty()) return false;
+        show((current + 1) % items.size());
+    }
+    kick();
+    return true;
+}
+
+PlaylistStatus PlaylistHandler::status() const {
+    std::lock_guard<ProfiledMutex> lock(m);
+    return {items, current, running, cycles, interval, switches, reprepared};
+}
+
+void PlaylistHandler::effectChanged(const TextEffect& e) {
+    {
+        std::lock_guard<ProfiledMutex> lock(m);
+        effect = e;
+    }
+    kick();
+}
+
+bool PlaylistHandler::prepareAhead() {
+    std::shared_ptr<const PreparedText> item;
+    std::size_t index = 0;
+    TextEffect want;
+    {
+        std::lock_guard<ProfiledMutex> lock(m);
+        if (items.empty()) return false;
+        for (const std::size_t i : {current, (current + 1) % items.size()}) {
+            if (items[i]->effect() != effect) {
+                item = items[i];
+                index = i;
+                break;
+            }
+        }
+        if (!item) return false;
+        want = effect;
+    }
+
+    // Outside m: a command switching items never waits for a text to be prepared.
+    auto prepared = std::make_shared<const PreparedText>(item->source(), want);
+    {
+        std::lock_guard<ProfiledMutex> lock(m);
+        if (index >= items.size() || items[index] != item) return true;  // replaced or cleared meanwhile: look again
+        items[index] = std::move(prepared);
+        ++reprepared;
+    }
+    if (ctx.getPrepared() == item) ctx.setEffect(want);  // switched to before it was ready: restyle it in place
+    return true;
+}
+
+void PlaylistHandler::show(std::size_t index) {
+    ctx.showPrepared(0, items[index]);
+    current = index;
+    shownAt = Clock::now();
+    cycleBase = ctx.laneCycles[0].load();
+    ++switches;
+}
+
+/**
+ * @brief By interval, a fixed time; by cycles, the time the remaining steps
+ * take at lane 0's velocity (at most kMaxEstimate, as the velocity may change).
+ */
+PlaylistHandler::Clock::time_point PlaylistHandler::turnEnd(Clock::time_point now) const {
+    if (cycles == 0) return shownAt + std::chrono::duration_cast<Clock::duration>(interval);
+
+    const std::uint64_t done = ctx.laneCycles[0].load() - cycleBase;
+    if (done >= cycles) return now;
+
+    const auto lanes = ctx.getLanes();
+    const MarqueeLane& lane = lanes->front();
+    if (!ctx.isMarqueeActive() || !(lane.velocity > 0)) return now + kMaxEstimate;  // not moving: look again later
+
+    const std::size_t period = withScrollPolicy(lane.mode, [&](auto policy) {
+        return decltype(policy)::period(*lane.text);
+    });
+    const std::size_t step = std::min(ctx.laneSteps[0].load(), period);
+    const double steps = static_cast<double>((cycles - done) * period - step);
+    const auto wait = std::chrono::duration<double>(steps / lane.velocity);
+    const auto floor = std::max<Clock::duration>(ctx.frameInterval(), Clock::duration{1});
+    return now + std::clamp(std::chrono::duration_cast<Clock::duration>(wait), floor, Clock::duration{kMaxEstimate});
+}
+
+PlaylistHandler::Clock::time_point PlaylistHandler::poll() {
+    while (prepareAhead()) {}  // the next turn needs no work
+
+    std::lock_guard<ProfiledMutex> lock(m);
+    if (!running || items.size() < 2) return Clock::time_point::max();
+    const Clock::time_point now = Clock::now();
+    const Clock::time_point end = turnEnd(now);
+    if (end > now) return end;
+    show((current + 1) % items.size());
+    changed = true;  // look again at once, to prepare the item after this one
+    return now;
+}
+
+void PlaylistHandler::kick() {
+    {
+        std::lock_guard<ProfiledMutex> lock(m);
+        changed = true;
+        if (loop) {
+            ctx.screen->pacer().notify();  // ends the loop's sleep; our coroutine looks again
+            return;
+        }
+    }
+    cv.notify_one();
+}
+
+void PlaylistHandler::operator()(std::stop_token stop) {
+    while (!stop.stop_requested()) {
+        const Clock::time_point wake = poll();
+
+        std::unique_lock<ProfiledMutex> lock(m);
+        if (wake == Clock::time_point::max()) {
+            cv.wait(lock, stop, [this] { return changed; });
+        } else {
+            cv.wait_until(lock, stop, wake, [this] { return changed; });
+        }
+        changed = false;
+    }
+}
+
+CoroTask PlaylistHandler::runCoroutine(EventLoop& l) {
+    {
+        std::lock_guard<ProfiledMutex> lock(m);
+        loop = &l;
+    }
+    while (!l.stopping() && !ctx.exitRequested.load()) {
+        // With nothing to rotate the loop's own idle wait bounds the sleep.
+        co_await l.sleepUntil(poll());
+    }
+    std::lock_guard<ProfiledMutex> lock(m);
+    loop = nullptr;
+}
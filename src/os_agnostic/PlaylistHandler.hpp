@@ -0,0 +1,134 @@
+/**
+ * @file PlaylistHandler.hpp
+ * @brief Rotates the main marquee through a list of texts prepared ahead of time.
+ */
+
+#pragma once
+
+#include "Context.hpp"
+#include "CoroRuntime.hpp"
+#include "PreparedText.hpp"
+#include "ProfiledMutex.hpp"
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <stop_token>
+#include <string>
+#include <vector>
+
+/** @brief The playlist as it stands (snapshot). */
+struct PlaylistStatus {
+    std::vector<std::shared_ptr<const PreparedText>> items;
+    std::size_t current{0};               // the item shown (or shown last)
+    bool running{false};
+    std::size_t cycles{0};                // rotate after this many full cycles; 0: after interval
+    std::chrono::nanoseconds interval{};
+    std::uint64_t switches{0};            // rotations so far
+    std::uint64_t reprepared{0};          // items prepared again because the effect changed
+};
+
+/**
+ * @brief Shows each playlist item on lane 0 for N full cycles or a fixed time, in turn.
+ *
+ * Items are prepared (PreparedText) when they are added, so a switch is a
+ * pointer swap (MarqueeState::showPrepared): the renderer never waits for
+ * a text to be split, padded or cached, and neither does a command. If
+ * set_effect changed the effect since an item was prepared, the driver
+ * prepares the next item again after each switch and after each
+ * effectChanged(), on this handler's thread and without m held. An item
+ * switched to before the driver got to it is restyled on screen as soon as
+ * it does (MarqueeState::setEffect, which keeps the scroll position).
+ *
+ * Cycles are counted by the display as it shows them
+ * (MarqueeState::laneCycles); between checks the driver sleeps for as long
+ * as the remaining steps take at the lane's velocity.
+ *
+ * Every method may be called from any thread.
+ */
+class PlaylistHandler : public Handler {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr std::size_t kMaxItems = 256;
+    static constexpr std::size_t kDefaultCycles = 3;
+    static constexpr std::chrono::seconds kMaxEstimate{1};  // longest a cycle-count estimate is trusted
+
+    explicit PlaylistHandler(MarqueeContext& c) : Handler(c), effect(c.getPrepared()->effect()) {}
+
+    /**
+     * @brief Rotate while running, until stopped.
+     * @param stop Ends the wait for the next switch at once.
+     */
+    void operator()(std::stop_token stop);
+
+    /**
+     * @brief The same loop as a coroutine for the single-threaded runtime.
+     * @param loop The loop to sleep on.
+     */
+    CoroTask runCoroutine(EventLoop& loop);
+
+    /** @brief Append an item. @return false if kMaxItems are already listed. */
+    bool add(std::shared_ptr<const PreparedText> text);
+
+    /** @brief Drop every item and stop rotating (the text on screen stays). */
+    void clear();
+
+    /** @brief Rotate after this many full cycles of the item (at least 1). */
+    void rotateAfterCycles(std::size_t cycles);
+
+    /** @brief Rotate after this long on screen. */
+    void rotateAfter(std::chrono::nanoseconds interval);
+
+    /** @brief Show the current item now and start rotating. @return false if the list is empty. */
+    bool start();
+
+    /** @brief Stop rotating (the item on screen stays). */
+    void stop();
+
+    /** @brief Show the next item now. @return false if the list is empty. */
+    bool next();
+
+    /** @brief set_effect changed lane 0's effect: the items are prepared again for it, one turn ahead. */
+    void effectChanged(const TextEffect& e);
+
+    PlaylistStatus status() const;
+
+private:
+    /**
+     * @brief Switch if the item on screen has had its turn.
+     * @return When to look again (Clock::time_point::max(): not until something changes).
+     */
+    Clock::time_point poll();
+
+    /** @brief When the current item's turn ends (m held). */
+    Clock::time_point turnEnd(Clock::time_point now) const;
+
+    /** @brief Put item index on screen as it is prepared and restart the turn (m held). */
+    void show(std::size_t index);
+
+    /**
+     * @brief Prepare the current item, else the next, for effect if it is not yet (m not held).
+     * @return false if both already were.
+     */
+    bool prepareAhead();
+
+    /** @brief Record a change and tell the driver. Call without m. */
+    void kick();
+
+    mutable ProfiledMutex m{"playlistMutex"};  // guards everything below
+    std::condition_variable_any cv;            // the thread driver waits here
+    bool changed{false};                       // something changed since the driver last looked
+    std::vector<std::shared_ptr<const PreparedText>> items;
+    std::size_t current{0};
+    bool running{false};
+    std::size_t cycles{kDefaultCycles};
+    std::chrono::nanoseconds interval{};
+    Clock::time_point shownAt;                 // when the current turn began
+    std::uint64_t cycleBase{0};                // lane 0's cycle count then
+    std::uint64_t switches{0};
+    std::uint64_t reprepared{0};
+    TextEffect effect;                         // the effect set_effect last set on lane 0
+    EventLoop* loop{nullptr};                  // set while running as a coroutine
+};
@@ -0,0 +1,222 @@
+/**
+ * @file PreparedText.cpp
+ * @brief Splits marquee text into rows and builds the rotation cache.
+ */
+
+#include "PreparedText.hpp"
+#include <algorithm>
+#include <iterator>
+#include <string>
+
+/**
+ * @brief Prepare text for rendering.
+ *
+ * Runs once per set_text on the command thread, never per frame.
+ *
+ * @param text Raw text; '\n' starts a new row.
+ * @param effect Colour/attribute effect to lay over the text.
+ * @param cacheCapBytes Memory cap for the doubled rows.
+ */
+PreparedText::PreparedText(std::string_view text, const TextEffect& effect, std::size_t cacheCapBytes)
+    : raw(text), rowCount(raw.lines()), cols(raw.widestLine()), cap(cacheCapBytes), fx(effect)
+{
+    if (text.empty()) return;
+
+    beginRows();
+    rowData.reserve(rowCount);
+    std::size_t start = 0;
+    while (true) {
+        const std::size_t nl = text.find('\n', start);
+        rowData.push_back(makeRow(text.substr(start, nl == std::string_view::npos ? nl : nl - start)));
+        if (nl == std::string_view::npos) break;
+        start = nl + 1;
+    }
+    finishRows();
+}
+
+/**
+ * @brief Take rows and width from the rope's root metrics (O(1)).
+ */
+PreparedText::PreparedText(TextRope rope, const TextEffect& effect, std::size_t cacheCapBytes)
+    : raw(std::move(rope)), rowCount(raw.lines()), cols(raw.widestLine()), cap(cacheCapBytes), fx(effect)
+{
+}
+
+/**
+ * @brief Share the rows before and after the edit; build the ones between from the rope.
+ *
+ * The edit touched rows lineOf(pos) to lineOf(pos + count) of this text,
+ * which became rows lineOf(pos) to lineOf(pos + insert.size()) of the
+ * new one; the rows after them are the same, shifted by the newlines the
+ * edit added or removed.
+ */
+PreparedText PreparedText::spliced(std::size_t pos, std::size_t count, std::string_view insert) const {
+    pos = std::min(pos, raw.size());
+    count = std::min(count, raw.size() - pos);
+    PreparedText out(raw.splice(pos, count, insert), fx, cap);
+    if (out.raw.empty()) return out;
+
+    out.beginRows();
+    const bool share = !rowData.empty() && out.cols == cols && out.doubledRows == doubledRows;
+    const std::size_t first = raw.lineOf(pos);
+    const std::size_t lastBefore = raw.lineOf(pos + count);
+    const std::size_t lastAfter = out.raw.lineOf(pos + insert.size());
+    const std::size_t rebuilt = share ? lastAfter - first + 1 : out.rowCount;
+    if (fx.kind == TextEffectKind::None && (!out.cached() || rebuilt * out.cols > kRebuildCapBytes)) {
+        out.doubledRows = false;
+        return out;  // composed from the rope
+    }
+    std::string line;
+    out.rowData.reserve(out.rowCount);
+    for (std::size_t r = 0; r < out.rowCount; ++r) {
+        if (share && r < first) {
+            out.rowData.push_back(rowData[r]);
+        } else if (share && r > lastAfter) {
+            out.rowData.push_back(rowData[r - lastAfter + lastBefore]);
+        } else {
+            line.clear();
+            out.raw.append(line, out.raw.lineStart(r), out.raw.lineLength(r));
+            out.rowData.push_back(out.makeRow(line));
+        }
+    }
+    out.finishRows();
+    return out;
+}
+
+// >>> EFFECTS
+
+namespace {
+// 256-colour foregrounds: a six-step rainbow and a twelve-step red-to-blue ramp.
+constexpr int kRainbow[] = {196, 208, 226, 46, 21, 93};
+constexpr int kRamp[] = {196, 202, 208, 214, 220, 190, 118, 48, 51, 39, 27, 57};
+constexpr std::size_t kRampSteps = sizeof kRamp / sizeof kRamp[0];
+
+// Every style starts from a reset, so each SGR string alone sets the full state.
+std::string foreground(int colour) {
+    return "\x1b[0;38;5;" + std::to_string(colour) + "m";
+}
+
+// Append a run, merging it into the previous one when the style is the same.
+void pushRun(std::vector<StyleRun>& spans, std::size_t start, std::size_t length, std::uint16_t style) {
+    if (!length) return;
+    if (!spans.empty() && spans.back().style == style) {
+        spans.back().length += length;
+        return;
+    }
+    spans.push_back({start, length, style});
+}
+} // namespace
+
+/**
+ * @brief Double rows only if the cache fits under the cap; an effect starts with its full SGR table.
+ */
+void PreparedText::beginRows() {
+    doubledRows = cols != 0 && rowCount * cols * 2 <= cap;
+    if (fx.kind == TextEffectKind::None || cols == 0) return;
+
+    sgr.emplace_back("\x1b[0m");
+    switch (fx.kind) {
+        case TextEffectKind::Rainbow:
+            for (int c : kRainbow) sgr.push_back(foreground(c));
+            break;
+        case TextEffectKind::Gradient:
+            for (int c : kRamp) sgr.push_back(foreground(c));
+            break;
+        case TextEffectKind::Words:
+            for (int c : kRainbow) sgr.push_back(foreground(c));
+            break;
+        case TextEffectKind::Highlight:
+            sgr.emplace_back("\x1b[0;1;5;7m");  // bold, blink, reverse
+            break;
+        default:
+            break;
+    }
+}
+
+/**
+ * @brief sgrBytes assumes a full-width window: it can cross each run boundary once, plus one wrap and a reset.
+ */
+std::shared_ptr<const PreparedText::Row> PreparedText::makeRow(std::string_view text) const {
+    auto row = std::make_shared<Row>();
+    row->text.reserve(cols);
+    row->text.assign(text);
+    row->text.resize(cols, ' ');  // padded so all rows share one period
+    if (doubledRows) {
+        row->doubled.reserve(cols * 2);
+        row->doubled.append(row->text).append(row->text);
+    }
+    if (sgr.empty()) return row;
+
+    row->runs = styleRow(row->text);
+    std::size_t longest = 0;
+    for (const auto& code : sgr) longest = std::max(longest, code.size());
+    row->sgrBytes = (row->runs.size() + 1) * longest + sgr[0].size();
+    for (const auto& run : row->runs) row->styled = row->styled || run.style != 0;
+    return row;
+}
+
+void PreparedText::finishRows() {
+    bool any = false;
+    bound = 0;
+    for (const auto& row : rowData) {
+        any = any || row->styled;
+        bound += row->sgrBytes;
+    }
+    // An effect that styles nothing (e.g. a highlight word that never occurs) is plain text.
+    if (!any) {
+        sgr.clear();
+        bound = 0;
+    }
+}
+
+/**
+ * @brief Lay fx over one row as style runs.
+ *
+ * Runs cover the row completely (style 0 where nothing is set), so the
+ * emitter never searches for gaps.
+ */
+std::vector<StyleRun> PreparedText::styleRow(std::string_view row) const {
+    std::vector<StyleRun> spans;
+    if (fx.kind == TextEffectKind::Rainbow) {
+        // One colour per character. A foreground colour is invisible on a
+        // blank, so blanks join the run before them instead of switching.
+        for (std::size_t c = 0; c < cols; ++c) {
+            const bool blank = row[c] == ' ' && !spans.empty();
+            pushRun(spans, c, 1, blank ? spans.back().style : static_cast<std::uint16_t>(1 + c % std::size(kRainbow)));
+        }
+    } else if (fx.kind == TextEffectKind::Gradient) {
+        // Twelve bands across the width (fewer when the text is narrower).
+        for (std::size_t c = 0; c < cols; ++c) {
+            pushRun(spans, c, 1, static_cast<std::uint16_t>(1 + c * kRampSteps / cols));
+        }
+    } else if (fx.kind == TextEffectKind::Words) {
+        // Each word gets the next colour.
+        std::size_t word = 0;
+        for (std::size_t c = 0; c < cols;) {
+            std::size_t end = c;
+            if (row[c] == ' ') {
+                // Blanks join the word before them (see Rainbow).
+                while (end < cols && row[end] == ' ') ++end;
+                pushRun(spans, c, end - c, spans.empty() ? 0 : spans.back().style);
+            } else {
+                while (end < cols && row[end] != ' ') ++end;
+                pushRun(spans, c, end - c, static_cast<std::uint16_t>(1 + word++ % std::size(kRainbow)));
+            }
+            c = end;
+        }
+    } else if (fx.kind == TextEffectKind::Highlight) {
+        // Every occurrence of the word.
+        std::size_t c = 0;
+        while (c < cols) {
+            const std::size_t at = fx.word.empty() ? std::string_view::npos : row.find(fx.word, c);
+            if (at == std::string_view::npos) {
+                pushRun(spans, c, cols - c, 0);
+                break;
+            }
+            pushRun(spans, c, at - c, 0);
+            pushRun(spans, at, fx.word.size(), 1);
+            c = at + fx.word.size();
+        }
+    }
+    return spans;
+}
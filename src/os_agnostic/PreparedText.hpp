@@ -0,0 +1,240 @@
+/**
+ * @file PreparedText.hpp
+ * @brief Marquee text prepared once for cheap per-frame rotation.
+ */
+
+#pragma once
+
+#include "TextRope.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/** @brief Colour/attribute effects (set_effect). Order matches kTextEffectNames. */
+enum class TextEffectKind : std::uint8_t { None, Rainbow, Gradient, Words, Highlight };
+
+inline constexpr std::size_t kTextEffectCount = 5;
+inline constexpr std::string_view kTextEffectNames[kTextEffectCount] = {
+    "none", "rainbow", "gradient", "words", "highlight"};
+
+/** @brief An effect and its argument (the word to highlight). */
+struct TextEffect {
+    TextEffectKind kind{TextEffectKind::None};
+    std::string word;
+
+    bool operator==(const TextEffect&) const = default;
+};
+
+/** @brief A run of columns [start, start + length) drawn with one style. */
+struct StyleRun {
+    std::size_t start{0};
+    std::size_t length{0};
+    std::uint16_t style{0};  // index into the SGR table; 0 is the terminal default
+};
+
+/**
+ * @brief Immutable marquee text split into rows, with a rotation cache.
+ *
+ * Every frame of a static text is one of width() rotations. When the cache
+ * fits under the memory cap, each row is stored twice back to back
+ * (row+row) so rotation k is simply the contiguous view at offset k.
+ * Larger texts keep only the plain rows and compose a rotation from two
+ * pieces on the fly.
+ *
+ * Multi-row art (rows separated by '\n') is padded to a common width so
+ * all rows scroll together.
+ *
+ * An effect is stored as run-length style spans per row plus a table of
+ * precomputed SGR strings. A frame only pays for an SGR string where the
+ * style changes inside the visible window, never per character, and every
+ * styled row ends in a reset; sgrBound() is the most a frame can add.
+ *
+ * The source is kept in a TextRope, and each row (padded text, doubled
+ * copy, runs) is built once and shared by the texts spliced from it.
+ * spliced() edits the rope and builds only the rows the edit touched;
+ * the others are shared as they are, unless the width changed (every
+ * row is padded, and styled, to the width). A plain text keeps no rows
+ * at all once edited if it is over the cache cap, or if the edit would
+ * rebuild more than kRebuildCapBytes of rows (a width change on a large
+ * text): rows, width and row starts are the rope's node metrics, so only
+ * the edited paths are recomputed, and frames are composed straight from
+ * its leaves (rows shorter than width() are padded on the fly).
+ */
+class PreparedText {
+public:
+    /** @brief Largest total size of the doubled rows before falling back to on-the-fly composition. */
+    static constexpr std::size_t kDefaultCacheCapBytes = std::size_t{1} << 20;
+
+    /** @brief Most row bytes spliced() rebuilds for a plain text; past it the result is drawn from the rope. */
+    static constexpr std::size_t kRebuildCapBytes = 64 * 1024;
+
+    PreparedText() = default;
+
+    /**
+     * @brief Split and (if it fits) cache the rotations of text.
+     * @param text Raw text; '\n' starts a new row.
+     * @param effect Colour/attribute effect to lay over the text.
+     * @param cacheCapBytes Memory cap for the doubled rows.
+     */
+    explicit PreparedText(std::string_view text, const TextEffect& effect = {},
+                          std::size_t cacheCapBytes = kDefaultCacheCapBytes);
+
+    /** @brief The text exactly as it was given (or edited to). */
+    std::string source() const { return raw.str(); }
+
+    /** @brief The text as a rope (shared, never copied). */
+    const TextRope& rope() const { return raw; }
+
+    /** @brief Number of rows (0 for an empty text). */
+    std::size_t rows() const { return rowCount; }
+
+    /** @brief Number of distinct rotations (the common row width). */
+    std::size_t width() const { return cols; }
+
+    /**
+     * @brief The same text with bytes [pos, pos + count) replaced by insert (clamped to the text).
+     *
+     * The rows from the first to the last one the edit touched are built
+     * again (all of them if the width changed); the rest are shared with
+     * this text. A plain text only splices its rope, O(log n), when it is
+     * over the cache cap or those rows hold more than kRebuildCapBytes, so
+     * a plain edit costs O(log n + kRebuildCapBytes) at most. A styled
+     * text always rebuilds them (its runs are read from the rows).
+     */
+    PreparedText spliced(std::size_t pos, std::size_t count, std::string_view insert) const;
+
+    /** @brief Whether rotations are served straight from the doubled buffers. */
+    bool cached() const { return doubledRows; }
+
+    /** @brief The effect laid over the text. */
+    const TextEffect& effect() const { return fx; }
+
+    /** @brief Whether any column is styled (false means rows are emitted as plain text). */
+    bool styled() const { return !sgr.empty(); }
+
+    /** @brief Most SGR bytes one full frame (every row, any rotation) can add to the plain text. */
+    std::size_t sgrBound() const { return bound; }
+
+    /**
+     * @brief Append count characters of row, starting at rotation offset.
+     *
+     * Styled text switches attributes only where a run boundary falls inside
+     * the window, and resets at the end.
+     *
+     * @param out Any string-like sink with append(std::string_view).
+     * @param row Row index (< rows()).
+     * @param offset Rotation (< width()).
+     * @param count Characters to append (<= width()).
+     * @return Escape-sequence bytes appended on top of the count characters.
+     */
+    template <typename Out>
+    std::size_t appendRow(Out& out, std::size_t row, std::size_t offset, std::size_t count) const {
+        if (!styled()) {
+            appendPlain(out, row, offset, count);
+            return 0;
+        }
+
+        const Row& r = *rowData[row];
+        const std::vector<StyleRun>& spans = r.runs;
+        auto it = std::upper_bound(spans.begin(), spans.end(), offset,
+                                   [](std::size_t col, const StyleRun& run) { return col < run.start; });
+        std::size_t idx = static_cast<std::size_t>(it - spans.begin()) - 1;  // run holding offset
+        std::size_t pos = offset;
+        std::size_t left = count;
+        std::uint16_t current = 0;
+        std::size_t extra = 0;
+
+        while (left) {
+            const StyleRun& run = spans[idx];
+            const std::size_t n = std::min(left, run.start + run.length - pos);
+            if (run.style != current) {
+                out.append(std::string_view{sgr[run.style]});
+                extra += sgr[run.style].size();
+                current = run.style;
+            }
+            out.append(std::string_view{r.text}.substr(pos, n));
+            pos += n;
+            left -= n;
+            if (pos == cols) { pos = 0; idx = 0; } else { ++idx; }
+        }
+
+        if (current != 0) {
+            out.append(std::string_view{sgr[0]});
+            extra += sgr[0].size();
+        }
+        return extra;
+    }
+
+private:
+    /** @brief One row as drawn, shared between a text and the texts spliced from it. */
+    struct Row {
+        std::string text;             // padded to cols
+        std::string doubled;          // text twice, empty when over the cap
+        std::vector<StyleRun> runs;   // covering [0, cols) in order; empty without an effect
+        std::size_t sgrBytes{0};      // this row's share of sgrBound()
+        bool styled{false};           // some run has a style other than 0
+    };
+
+    /** @brief An edited text: the rope and its metrics only; spliced() adds the rows. */
+    PreparedText(TextRope rope, const TextEffect& effect, std::size_t cacheCapBytes);
+
+    /** @brief Pad, double and style one row (sgr must hold the effect's full table). */
+    std::shared_ptr<const Row> makeRow(std::string_view text) const;
+
+    /** @brief Set the effect's SGR table and whether rows are doubled, before any row is made. */
+    void beginRows();
+
+    /** @brief Sum the rows' SGR bounds; an effect that styles nothing drops its table. */
+    void finishRows();
+
+    /** @brief Unstyled slice of a row (one or two pieces). */
+    template <typename Out>
+    void appendPlain(Out& out, std::size_t row, std::size_t offset, std::size_t count) const {
+        if (cached()) {
+            out.append(std::string_view{rowData[row]->doubled}.substr(offset, count));
+            return;
+        }
+        const std::size_t first = std::min(cols - offset, count);
+        if (rowData.empty()) {
+            appendFromRope(out, row, offset, first);
+            appendFromRope(out, row, 0, count - first);
+            return;
+        }
+        const std::string_view r{rowData[row]->text};
+        out.append(r.substr(offset, first));
+        out.append(r.substr(0, count - first));
+    }
+
+    /** @brief Columns [from, from + count) of a row read from the rope, blanks past its end. */
+    template <typename Out>
+    void appendFromRope(Out& out, std::size_t row, std::size_t from, std::size_t count) const {
+        static constexpr std::string_view kBlanks = "                                ";
+        if (!count) return;
+        const std::size_t start = raw.lineStart(row);
+        const std::size_t length = raw.lineLength(row);
+        if (from < length) {
+            const std::size_t n = std::min(count, length - from);
+            raw.append(out, start + from, n);
+            count -= n;
+        }
+        for (; count; count -= std::min(count, kBlanks.size())) out.append(kBlanks.substr(0, count));
+    }
+
+    /** @brief Style runs of one padded row under fx. */
+    std::vector<StyleRun> styleRow(std::string_view row) const;
+
+    TextRope raw;                       // original text
+    std::size_t rowCount{0};            // rows()
+    std::vector<std::shared_ptr<const Row>> rowData;  // per row; empty for an edited plain text over the cap
+    std::size_t cols{0};
+    std::size_t cap{kDefaultCacheCapBytes};  // cacheCapBytes, kept for spliced()
+    bool doubledRows{false};            // cached()
+
+    TextEffect fx;                          // effect the runs were built from
+    std::vector<std::string> sgr;           // precomputed SGR per style; [0] resets, empty when unstyled
+    std::size_t bound{0};                   // sgrBound()
+};
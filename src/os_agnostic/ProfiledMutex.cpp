@@ -0,0 +1,314 @@
+/**
+ * @file ProfiledMutex.cpp
+ * @brief Lock profiles: recording, the registry of live and destroyed locks, and the report.
+ */
+
+#include "ProfiledMutex.hpp"
+
+#if defined(MARQUEE_PROFILE_LOCKS)
+
+#include "CommandArgs.hpp"
+#include <algorithm>
+#include <bit>
+#include <vector>
+
+namespace {
+
+/** @brief A Slot's figures at one moment (plain numbers, mergeable). */
+struct Profile {
+    std::uint64_t acquisitions{0};
+    std::uint64_t contended{0};
+    std::uint64_t waitNsTotal{0};
+    std::uint64_t waitNsMax{0};
+    std::uint64_t holdNsTotal{0};
+    std::uint64_t holdNsMax{0};
+    std::array<std::uint64_t, ProfiledMutex::kBuckets> wait{};
+    std::array<std::uint64_t, ProfiledMutex::kBuckets> hold{};
+
+    void add(const ProfiledMutex::Slot& s) {
+        acquisitions += s.acquisitions.load(std::memory_order_relaxed);
+        contended += s.contended.load(std::memory_order_relaxed);
+        waitNsTotal += s.waitNsTotal.load(std::memory_order_relaxed);
+        waitNsMax = std::max(waitNsMax, s.waitNsMax.load(std::memory_order_relaxed));
+        holdNsTotal += s.holdNsTotal.load(std::memory_order_relaxed);
+        holdNsMax = std::max(holdNsMax, s.holdNsMax.load(std::memory_order_relaxed));
+        for (std::size_t i = 0; i < ProfiledMutex::kBuckets; ++i) {
+            wait[i] += s.wait[i].load(std::memory_order_relaxed);
+            hold[i] += s.hold[i].load(std::memory_order_relaxed);
+        }
+    }
+
+    void add(const Profile& p) {
+        acquisitions += p.acquisitions;
+        contended += p.contended;
+        waitNsTotal += p.waitNsTotal;
+        waitNsMax = std::max(waitNsMax, p.waitNsMax);
+        holdNsTotal += p.holdNsTotal;
+        holdNsMax = std::max(holdNsMax, p.holdNsMax);
+        for (std::size_t i = 0; i < ProfiledMutex::kBuckets; ++i) {
+            wait[i] += p.wait[i];
+            hold[i] += p.hold[i];
+        }
+    }
+};
+
+/** @brief Every lock of one name, per thread slot. */
+struct LockProfile {
+    std::string name;
+    std::array<Profile, ProfiledMutex::kMaxThreads> threads{};
+};
+
+/** @brief Live locks, profiles of destroyed ones and the thread names (all under m). */
+struct Registry {
+    std::mutex m;
+    std::vector<ProfiledMutex*> live;
+    std::vector<LockProfile> retired;
+    std::array<std::string, ProfiledMutex::kMaxThreads> threadNames{"other"};
+    std::size_t threadCount{1};
+};
+
+Registry& registry() {
+    static Registry r;  // first use may come from any static-duration lock's constructor
+    return r;
+}
+
+thread_local std::size_t threadSlot = 0;  // the calling thread's name, as an index into threadNames
+
+/** @brief The entry named name in list, appended if missing. */
+LockProfile& profileFor(std::vector<LockProfile>& list, std::string_view name) {
+    for (LockProfile& p : list) {
+        if (p.name == name) return p;
+    }
+    list.push_back(LockProfile{std::string{name}, {}});
+    return list.back();
+}
+
+/** @brief Histogram bucket of a duration. */
+std::size_t bucketOf(std::uint64_t ns) {
+    return std::min<std::size_t>(ns ? std::bit_width(ns) - 1 : 0, ProfiledMutex::kBuckets - 1);
+}
+
+/** @brief Add v to a counter only ever written under the profiled lock. */
+void add(std::atomic<std::uint64_t>& counter, std::uint64_t v) {
+    counter.store(counter.load(std::memory_order_relaxed) + v, std::memory_order_relaxed);
+}
+
+void raiseMax(std::atomic<std::uint64_t>& max, std::uint64_t v) {
+    if (v > max.load(std::memory_order_relaxed)) max.store(v, std::memory_order_relaxed);
+}
+
+/** @brief Upper bound of the bucket holding the p-quantile of counts. */
+std::uint64_t quantileNs(const std::array<std::uint64_t, ProfiledMutex::kBuckets>& counts, double p) {
+    std::uint64_t total = 0;
+    for (std::uint64_t c : counts) total += c;
+    const auto rank = std::max<std::uint64_t>(static_cast<std::uint64_t>(p * static_cast<double>(total) + 0.5), 1);
+    std::uint64_t seen = 0;
+    for (std::size_t i = 0; i < counts.size(); ++i) {
+        seen += counts[i];
+        if (seen >= rank) return std::uint64_t{2} << i;
+    }
+    return std::uint64_t{2} << (counts.size() - 1);
+}
+
+/** @brief One histogram as rows of "< bound  count  bars", first to last non-empty bucket. */
+void appendHistogram(std::string& out, const std::array<std::uint64_t, ProfiledMutex::kBuckets>& counts) {
+    constexpr std::size_t kBarWidth = 40;
+    std::size_t first = 0;
+    std::size_t last = counts.size();
+    while (first < counts.size() && counts[first] == 0) ++first;
+    while (last > first && counts[last - 1] == 0) --last;
+    if (first == last) {
+        out += "    (none)\n";
+        return;
+    }
+    const std::uint64_t peak = *std::max_element(counts.begin(), counts.end());
+    for (std::size_t i = first; i < last; ++i) {
+        std::string label = i + 1 == counts.size() ? ">= " : "< ";
+        appendShortDuration(label, i + 1 == counts.size() ? std::uint64_t{1} << i : std::uint64_t{2} << i);
+        out.append(label.size() < 12 ? 12 - label.size() : 0, ' ');
+        out += label;
+        std::string count;
+        appendNumber(count, counts[i]);
+        out.append(count.size() < 10 ? 10 - count.size() : 0, ' ');
+        out += count;
+        out += "  ";
+        out.append(static_cast<std::size_t>((counts[i] * kBarWidth + peak - 1) / peak), '#');
+        out += "\n";
+    }
+}
+
+/** @brief "wait avg .., max ..; hold avg .., p99 <= .., max .." for one profile. */
+void appendSummary(std::string& out, const Profile& p) {
+    appendNumber(out, p.acquisitions);
+    out += " acquisitions, ";  appendNumber(out, p.contended);
+    out += " contended";
+    if (p.contended) {
+        out += " (wait avg ";  appendShortDuration(out, p.waitNsTotal / p.contended);
+        out += ", max ";       appendShortDuration(out, p.waitNsMax);
+        out += ")";
+    }
+    if (p.acquisitions) {
+        out += "; hold avg ";  appendShortDuration(out, p.holdNsTotal / p.acquisitions);
+        out += ", p99 <= ";    appendShortDuration(out, std::min(quantileNs(p.hold, 0.99), p.holdNsMax));
+        out += ", max ";       appendShortDuration(out, p.holdNsMax);
+    }
+    out += "\n";
+}
+
+}  // namespace
+
+ProfiledMutex::ProfiledMutex(const char* lockName) : name(lockName) {
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.m);
+    r.live.push_back(this);
+}
+
+/**
+ * @brief Keep the profile: it is folded into the retired one of the same name.
+ */
+ProfiledMutex::~ProfiledMutex() {
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.m);
+    r.live.erase(std::remove(r.live.begin(), r.live.end(), this), r.live.end());
+    LockProfile& retired = profileFor(r.retired, name);
+    for (std::size_t t = 0; t < kMaxThreads; ++t) retired.threads[t].add(slots[t]);
+}
+
+/**
+ * @brief Take the lock; only a failed try_lock() is timed as a wait.
+ */
+void ProfiledMutex::lock() {
+    const std::size_t self = threadSlot;
+    if (m.try_lock()) {
+        acquiredAt = Clock::now();
+    } else {
+        const auto waitFrom = Clock::now();
+        m.lock();
+        acquiredAt = Clock::now();
+        const auto waited = static_cast<std::uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(acquiredAt - waitFrom).count());
+        Slot& s = slots[self];
+        add(s.contended, 1);
+        add(s.waitNsTotal, waited);
+        raiseMax(s.waitNsMax, waited);
+        add(s.wait[bucketOf(waited)], 1);
+    }
+    holder = self;
+    add(slots[self].acquisitions, 1);
+}
+
+bool ProfiledMutex::try_lock() {
+    if (!m.try_lock()) return false;
+    acquiredAt = Clock::now();
+    holder = threadSlot;
+    add(slots[holder].acquisitions, 1);
+    return true;
+}
+
+void ProfiledMutex::unlock() {
+    const auto held = static_cast<std::uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - acquiredAt).count());
+    Slot& s = slots[holder];
+    add(s.holdNsTotal, held);
+    raiseMax(s.holdNsMax, held);
+    add(s.hold[bucketOf(held)], 1);
+    m.unlock();
+}
+
+void ProfiledMutex::setThreadName(std::string_view threadName) {
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.m);
+    for (std::size_t i = 0; i < r.threadCount; ++i) {
+        if (r.threadNames[i] == threadName) {
+            threadSlot = i;
+            return;
+        }
+    }
+    if (r.threadCount == kMaxThreads) {
+        threadSlot = 0;  // out of slots: counted as "other"
+        return;
+    }
+    r.threadNames[r.threadCount].assign(threadName);
+    threadSlot = r.threadCount++;
+}
+
+std::string ProfiledMutex::report(std::string_view lockName) {
+    Registry& r = registry();
+    std::vector<LockProfile> locks;
+    std::array<std::string, kMaxThreads> threadNames;
+    {
+        std::lock_guard<std::mutex> lock(r.m);
+        for (const ProfiledMutex* mutex : r.live) {
+            LockProfile& p = profileFor(locks, mutex->name);
+            for (std::size_t t = 0; t < kMaxThreads; ++t) p.threads[t].add(mutex->slots[t]);
+        }
+        for (const LockProfile& retired : r.retired) {
+            LockProfile& p = profileFor(locks, retired.name);
+            for (std::size_t t = 0; t < kMaxThreads; ++t) p.threads[t].add(retired.threads[t]);
+        }
+        threadNames = r.threadNames;
+    }
+
+    std::string out;
+
+    // >>> ONE LOCK: FULL HISTOGRAMS
+    if (!lockName.empty()) {
+        const auto it = std::find_if(locks.begin(), locks.end(), [&](const LockProfile& p) { return p.name == lockName; });
+        if (it == locks.end()) {
+            out += "No lock named ";  out += lockName;
+            out += ".\n";
+            return out;
+        }
+        Profile all;
+        for (const Profile& p : it->threads) all.add(p);
+        out += it->name;  out += ": ";
+        appendSummary(out, all);
+        out += "  wait (contended acquisitions):\n";
+        appendHistogram(out, all.wait);
+        out += "  hold:\n";
+        appendHistogram(out, all.hold);
+        return out;
+    }
+
+    // >>> EVERY LOCK: ONE LINE PER THREAD
+    if (locks.empty()) out += "No profiled locks.\n";
+    for (const LockProfile& lock : locks) {
+        Profile all;
+        for (const Profile& p : lock.threads) all.add(p);
+        out += lock.name;  out += ": ";
+        appendSummary(out, all);
+        for (std::size_t t = 0; t < kMaxThreads; ++t) {
+            if (lock.threads[t].acquisitions == 0) continue;
+            out += "  ";  out += threadNames[t];
+            out += ": ";
+            appendSummary(out, lock.threads[t]);
+        }
+    }
+    return out;
+}
+
+void ProfiledMutex::reset() {
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.m);
+    r.retired.clear();
+    for (ProfiledMutex* mutex : r.live) {
+        for (Slot& s : mutex->slots) {
+            s.acquisitions.store(0, std::memory_order_relaxed);
+            s.contended.store(0, std::memory_order_relaxed);
+            s.waitNsTotal.store(0, std::memory_order_relaxed);
+            s.waitNsMax.store(0, std::memory_order_relaxed);
+            s.holdNsTotal.store(0, std::memory_order_relaxed);
+            s.holdNsMax.store(0, std::memory_order_relaxed);
+            for (auto& c : s.wait) c.store(0, std::memory_order_relaxed);
+            for (auto& c : s.hold) c.store(0, std::memory_order_relaxed);
+        }
+    }
+}
+
+#else
+
+std::string ProfiledMutex::report(std::string_view) {
+    return "Lock profiling is off (configure with -DMARQUEE_PROFILE_LOCKS=ON).\n";
+}
+
+#endif
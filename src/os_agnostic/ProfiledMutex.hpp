@@ -0,0 +1,104 @@
+/**
+ * @file ProfiledMutex.hpp
+ * @brief A named mutex that can record its own contention (build with MARQUEE_PROFILE_LOCKS).
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+
+#if defined(MARQUEE_PROFILE_LOCKS)
+
+/**
+ * @brief A std::mutex that counts, per caller thread, how often it was taken,
+ * how long callers waited for it and how long they held it.
+ *
+ * Threads are told apart by the name given to setThreadName() (unnamed
+ * threads share "other"). Waits and holds go into log2 nanosecond
+ * histograms. Every sample is recorded while the lock is held, so writers
+ * never race each other; readers (report()) see relaxed atomics.
+ *
+ * Meets the Lockable requirements: use it with std::lock_guard,
+ * std::unique_lock and std::condition_variable_any. A profile outlives
+ * its mutex, so report() at exit still covers destroyed locks.
+ */
+class ProfiledMutex {
+public:
+    static constexpr bool kEnabled = true;
+    static constexpr std::size_t kMaxThreads = 16;  // distinct thread names (slot 0: "other")
+    static constexpr std::size_t kBuckets = 28;     // bucket i: [2^i, 2^(i+1)) ns; the last one is open-ended
+
+    /** @param name Shown by report(); locks with the same name are reported together. */
+    explicit ProfiledMutex(const char* name);
+    ~ProfiledMutex();
+    ProfiledMutex(const ProfiledMutex&) = delete;
+    ProfiledMutex& operator=(const ProfiledMutex&) = delete;
+
+    void lock();
+    bool try_lock();
+    void unlock();
+
+    /** @brief Name the calling thread in every lock's profile from now on. */
+    static void setThreadName(std::string_view name);
+
+    /**
+     * @brief Every lock's profile as text.
+     * @param lockName Empty for one summary line per lock and thread; a
+     *        lock's name for its full wait and hold histograms.
+     */
+    static std::string report(std::string_view lockName = {});
+
+    /** @brief Start every profile over (samples taken meanwhile may survive). */
+    static void reset();
+
+    /** @brief One thread's figures for one lock. */
+    struct Slot {
+        std::atomic<std::uint64_t> acquisitions{0};
+        std::atomic<std::uint64_t> contended{0};   // had to wait (try_lock failed)
+        std::atomic<std::uint64_t> waitNsTotal{0};
+        std::atomic<std::uint64_t> waitNsMax{0};
+        std::atomic<std::uint64_t> holdNsTotal{0};
+        std::atomic<std::uint64_t> holdNsMax{0};
+        std::array<std::atomic<std::uint64_t>, kBuckets> wait{};
+        std::array<std::atomic<std::uint64_t>, kBuckets> hold{};
+    };
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    std::mutex m;
+    const char* name;
+    std::array<Slot, kMaxThreads> slots;
+    Clock::time_point acquiredAt;  // by the holder (guarded by m)
+    std::size_t holder{0};         // its slot
+};
+
+#else
+
+/**
+ * @brief Plain std::mutex: built without MARQUEE_PROFILE_LOCKS nothing is recorded.
+ *
+ * The name and the static hooks are kept so call sites compile either way.
+ */
+class ProfiledMutex : public std::mutex {
+public:
+    static constexpr bool kEnabled = false;
+
+    explicit ProfiledMutex(const char*) {}
+
+    static void setThreadName(std::string_view) {}
+
+    /** @brief Says how to turn profiling on. */
+    static std::string report(std::string_view lockName = {});
+
+    static void reset() {}
+};
+
+#endif
@@ -0,0 +1,72 @@
+/**
+ * @file RecordCommands.cpp
+ * @brief The "record" commands: asciicast session recording.
+ */
+
+#include "CommandHandler.hpp"
+#include "CommandArgs.hpp"
+#include "CommandFeedback.hpp"
+
+/**
+ * @brief Run one "record <file>" or "record stop" line.
+ *
+ * Everything written to the console from then on is captured with its
+ * time and written to the file by the Recorder's own thread. Starting and
+ * stopping also restart the frame lateness figures in stats, so a
+ * recorded stretch can be compared with an unrecorded one.
+ *
+ * @param line The whole command line (for the echo).
+ * @param rest Everything after "record".
+ */
+void CommandHandler::handleRecord(std::string_view line, std::string_view rest) {
+  std::pmr::memory_resource* mr = commandArena.resource();
+  const std::string_view file = trimView(rest);
+  std::string_view args = rest;
+  const std::string_view word = takeWord(args);
+
+  // >>> RECORD STOP
+  if (word == "stop" && args.empty()) {
+    if (!ctx.screen->recorder().active()) {
+      paintMessage(ctx, mr, line, "Not recording.");
+      return;
+    }
+    const RecorderStats rs = ctx.screen->stopRecording();
+    ctx.metrics.resetLateness();
+    paintEchoFeedbackMarqueePrompt(ctx, mr, line, [&](std::pmr::string& out){
+      out += "Recording saved to ";  out += ctx.screen->recorder().path();
+      out += ": ";                   appendNumber(out, rs.events);
+      out += " events, ";            appendNumber(out, rs.fileBytes);
+      out += " bytes in ";           appendNumber(out, rs.writes);
+      out += " writes";
+      if (rs.dropped) {
+        out += ", ";                 appendNumber(out, rs.dropped);
+        out += " chunks dropped (writer fell behind)";
+      }
+      out += ".\nCapture cost: ";    appendNumber(out, rs.events ? rs.captureNsTotal / rs.events : 0);
+      out += " ns avg, ";            appendNumber(out, rs.captureNsMax);
+      out += " ns max per write.\n";
+    });
+    return;
+  }
+
+  // >>> RECORD <FILE>
+  if (!file.empty()) {
+    std::string error;
+    const bool started = ctx.screen->startRecording(std::string{file}, error);
+    if (started) ctx.metrics.resetLateness();
+    paintEchoFeedbackMarqueePrompt(ctx, mr, line, [&](std::pmr::string& out){
+      if (started) {
+        out += "Recording to ";
+        out += file;
+        out += " ('record stop' to finish).\n";
+      } else {
+        out += "Cannot record: ";
+        out += error;
+        out += "\n";
+      }
+    });
+    return;
+  }
+
+  paintMessage(ctx, mr, line, "Usage: record <file> | record stop");
+}
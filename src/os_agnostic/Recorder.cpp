@@ -0,0 +1,221 @@
+/**
+ * @file Recorder.cpp
+ * @brief asciicast v2 recording through a lock-free handoff ring.
+ */
+
+#include "Recorder.hpp"
+#include "CommandArgs.hpp"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+static_assert((Recorder::kRingBytes & (Recorder::kRingBytes - 1)) == 0, "kRingBytes must be a power of two");
+
+/**
+ * @brief Append s as the body of a JSON string (quotes not included).
+ *
+ * Control characters (the escape sequences that make up most of the
+ * stream) become \\u00XX; UTF-8 passes through.
+ */
+static void appendJsonEscaped(std::string& out, std::string_view s) {
+    static constexpr char kHex[] = "0123456789abcdef";
+    for (char c : s) {
+        const auto u = static_cast<unsigned char>(c);
+        switch (c) {
+            case '"':  out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n";  break;
+            case '\r': out += "\\r";  break;
+            case '\t': out += "\\t";  break;
+            default:
+                if (u < 0x20 || u == 0x7f) {
+                    out += "\\u00";
+                    out += kHex[u >> 4];
+                    out += kHex[u & 0xf];
+                } else {
+                    out += c;
+                }
+        }
+    }
+}
+
+/**
+ * @brief Append a time in seconds with microsecond precision (asciicast event time).
+ */
+static void appendSeconds(std::string& out, std::uint64_t ns) {
+    appendFixed(out, static_cast<double>(ns / 1000) / 1e6, 6);
+}
+
+/**
+ * @brief Open the file, write the header line and start the writer.
+ */
+bool Recorder::start(const std::string& path, unsigned width, unsigned height, std::string& error) {
+    if (active()) {
+        error = "already recording to " + file;
+        return false;
+    }
+
+    out.open(path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        error = "cannot create " + path;
+        return false;
+    }
+    file = path;
+    if (!ring) ring = std::make_unique<char[]>(kRingBytes);
+    head.store(0);
+    tail.store(0);
+    events.store(0);
+    dropped.store(0);
+    captureNsTotal.store(0);
+    captureNsMax.store(0);
+    fileBytes.store(0);
+    writes.store(0);
+
+    // Header: {"version": 2, "width": W, "height": H, "timestamp": T, "env": {"TERM": "..."}}
+    const char* term = std::getenv("TERM");
+    lines.assign("{\"version\": 2, \"width\": ");
+    appendNumber(lines, width);
+    lines += ", \"height\": ";
+    appendNumber(lines, height);
+    lines += ", \"timestamp\": ";
+    appendNumber(lines, static_cast<std::uint64_t>(
+        std::chrono::duration_cast<std::chrono::seconds>(std::chrono::system_clock::now().time_since_epoch()).count()));
+    lines += ", \"env\": {\"TERM\": \"";
+    appendJsonEscaped(lines, term ? term : "");
+    lines += "\"}}\n";
+    flush();
+
+    started = Clock::now();
+    lastFlush = started;
+    stopping = false;
+    recording.store(true, std::memory_order_release);
+    writer = std::thread([this] { drain(); });
+    return true;
+}
+
+/**
+ * @brief Stop capturing and let the writer finish the file.
+ */
+RecorderStats Recorder::stop() {
+    if (!writer.joinable()) return stats();
+    recording.store(false, std::memory_order_release);
+    {
+        std::lock_guard<std::mutex> lock(stopMutex);
+        stopping = true;
+    }
+    stopCv.notify_one();
+    writer.join();
+    out.close();
+    return stats();
+}
+
+void Recorder::copyIn(std::uint64_t pos, const char* data, std::size_t n) {
+    const std::size_t at = static_cast<std::size_t>(pos & (kRingBytes - 1));
+    const std::size_t first = std::min(n, kRingBytes - at);
+    std::memcpy(ring.get() + at, data, first);
+    std::memcpy(ring.get(), data + first, n - first);
+}
+
+void Recorder::copyOut(std::uint64_t pos, char* data, std::size_t n) const {
+    const std::size_t at = static_cast<std::size_t>(pos & (kRingBytes - 1));
+    const std::size_t first = std::min(n, kRingBytes - at);
+    std::memcpy(data, ring.get() + at, first);
+    std::memcpy(data + first, ring.get(), n - first);
+}
+
+/**
+ * @brief Publish one record; drops it (and counts) when the ring has no room.
+ */
+void Recorder::capture(std::initializer_list<std::string_view> parts) {
+    if (!recording.load(std::memory_order_acquire)) return;
+    const auto t0 = Clock::now();
+
+    std::size_t length = 0;
+    for (std::string_view p : parts) length += p.size();
+    const std::size_t total = sizeof(RecordHeader) + length;
+
+    const std::uint64_t h = head.load(std::memory_order_relaxed);
+    if (total > kRingBytes - (h - tail.load(std::memory_order_acquire))) {
+        dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    const RecordHeader hdr{static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(t0 - started).count()),
+                           length};
+    copyIn(h, reinterpret_cast<const char*>(&hdr), sizeof hdr);
+    std::uint64_t pos = h + sizeof hdr;
+    for (std::string_view p : parts) {
+        copyIn(pos, p.data(), p.size());
+        pos += p.size();
+    }
+    head.store(h + total, std::memory_order_release);
+
+    events.fetch_add(1, std::memory_order_relaxed);
+    const auto ns = static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - t0).count());
+    captureNsTotal.fetch_add(ns, std::memory_order_relaxed);
+    if (ns > captureNsMax.load(std::memory_order_relaxed)) captureNsMax.store(ns, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Convert every published record into a [time, "o", data] line.
+ */
+bool Recorder::takeRecords() {
+    const std::uint64_t h = head.load(std::memory_order_acquire);
+    std::uint64_t t = tail.load(std::memory_order_relaxed);
+    if (t == h) return false;
+
+    while (t != h) {
+        RecordHeader hdr;
+        copyOut(t, reinterpret_cast<char*>(&hdr), sizeof hdr);
+        payload.resize(static_cast<std::size_t>(hdr.length));
+        copyOut(t + sizeof hdr, payload.data(), payload.size());
+        t += sizeof hdr + hdr.length;
+
+        lines += '[';
+        appendSeconds(lines, hdr.ns);
+        lines += ", \"o\", \"";
+        appendJsonEscaped(lines, payload);
+        lines += "\"]\n";
+    }
+    tail.store(t, std::memory_order_release);  // the producer may reuse the space now
+    return true;
+}
+
+void Recorder::flush() {
+    if (lines.empty()) return;
+    out.write(lines.data(), static_cast<std::streamsize>(lines.size()));
+    out.flush();
+    fileBytes.fetch_add(lines.size(), std::memory_order_relaxed);
+    writes.fetch_add(1, std::memory_order_relaxed);
+    lines.clear();
+}
+
+/**
+ * @brief Writer loop: collect records every kPollInterval and write in large batches.
+ */
+void Recorder::drain() {
+    lines.reserve(kFlushBytes * 2);
+    std::unique_lock<std::mutex> lock(stopMutex);
+    while (!stopping) {
+        stopCv.wait_for(lock, kPollInterval, [this] { return stopping; });
+        takeRecords();
+        const auto now = Clock::now();
+        if (lines.size() >= kFlushBytes || now - lastFlush >= kMaxFlushDelay) {
+            flush();
+            lastFlush = now;
+        }
+    }
+    takeRecords();  // capture() has stopped: this is everything
+    flush();
+}
+
+RecorderStats Recorder::stats() const {
+    RecorderStats s;
+    s.events = events.load(std::memory_order_relaxed);
+    s.dropped = dropped.load(std::memory_order_relaxed);
+    s.fileBytes = fileBytes.load(std::memory_order_relaxed);
+    s.writes = writes.load(std::memory_order_relaxed);
+    s.captureNsTotal = captureNsTotal.load(std::memory_order_relaxed);
+    s.captureNsMax = captureNsMax.load(std::memory_order_relaxed);
+    return s;
+}
@@ -0,0 +1,139 @@
+/**
+ * @file Recorder.hpp
+ * @brief Records console output as an asciicast v2 file from a background thread.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <initializer_list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+
+/** @brief Counters of the current (or last) recording. */
+struct RecorderStats {
+    std::uint64_t events{0};        // output chunks captured
+    std::uint64_t dropped{0};       // chunks lost because the handoff ring was full
+    std::uint64_t fileBytes{0};     // bytes written to the file
+    std::uint64_t writes{0};        // file writes issued
+    std::uint64_t captureNsTotal{0}; // time the capturing (display/command) threads spent handing chunks off
+    std::uint64_t captureNsMax{0};
+};
+
+/**
+ * @brief asciicast v2 recorder: capture() costs a copy, the file is written elsewhere.
+ *
+ * Captured chunks go into a lock-free single-producer/single-consumer byte
+ * ring as (timestamp, length, bytes) records. capture() never blocks and
+ * never allocates. When the ring is full, the chunk is dropped and counted.
+ * A background thread wakes every kPollInterval, turns the records into
+ * asciicast event lines and writes them in batches of kFlushBytes (sooner
+ * if output is sparse).
+ *
+ * capture() and start() must be serialised by the caller: FrameScheduler
+ * calls both with ctx.coutMutex held. stop() takes no lock and may race
+ * capture() (FrameScheduler::stopRecording runs without coutMutex): it
+ * clears active() first, so a capture() already past that check only
+ * fills ring space the writer no longer reads, and the next start()
+ * resets the ring. start() and stop() must not race each other (the
+ * record commands issue both from the command thread).
+ */
+class Recorder {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr std::size_t kRingBytes = std::size_t{4} << 20;      // handoff ring (power of two)
+    static constexpr std::size_t kFlushBytes = std::size_t{256} << 10;   // preferred file write size
+    static constexpr std::chrono::milliseconds kPollInterval{20};        // writer wake-up period
+    static constexpr std::chrono::seconds kMaxFlushDelay{1};             // longest output waits for the file
+
+    Recorder() = default;
+    ~Recorder() { stop(); }
+
+    Recorder(const Recorder&) = delete;
+    Recorder& operator=(const Recorder&) = delete;
+
+    /**
+     * @brief Create path, write the asciicast header and start the writer thread.
+     * @param width Terminal columns for the header.
+     * @param height Terminal rows for the header.
+     * @param error Receives a short reason on failure.
+     * @return false if already recording or the file cannot be created.
+     */
+    bool start(const std::string& path, unsigned width, unsigned height, std::string& error);
+
+    /** @brief Stop capturing, write out everything captured and close the file. */
+    RecorderStats stop();
+
+    /** @brief Whether a recording is in progress. */
+    bool active() const { return recording.load(std::memory_order_acquire); }
+
+    /** @brief Path of the current (or last) recording. */
+    const std::string& path() const { return file; }
+
+    /**
+     * @brief Capture one output chunk (parts back to back) with the current time.
+     *
+     * No-op when not recording. Serialised with start() by the caller; may race stop().
+     */
+    void capture(std::initializer_list<std::string_view> parts);
+
+    /** @brief Counters so far (fileBytes and writes lag by up to one poll). */
+    RecorderStats stats() const;
+
+private:
+    /** @brief (timestamp, length) in front of every record in the ring. */
+    struct RecordHeader {
+        std::uint64_t ns;       // since start()
+        std::uint64_t length;   // payload bytes
+    };
+
+    /** @brief Copy n bytes into the ring at position pos (wrapping). */
+    void copyIn(std::uint64_t pos, const char* data, std::size_t n);
+
+    /** @brief Copy n bytes out of the ring at position pos (wrapping). */
+    void copyOut(std::uint64_t pos, char* data, std::size_t n) const;
+
+    /** @brief Writer thread body. */
+    void drain();
+
+    /** @brief Turn every published record into event lines; true if any were taken. */
+    bool takeRecords();
+
+    /** @brief Write the pending lines to the file. */
+    void flush();
+
+    std::unique_ptr<char[]> ring;
+    alignas(64) std::atomic<std::uint64_t> head{0};   // written by the producer only
+    alignas(64) std::atomic<std::uint64_t> tail{0};   // written by the writer only
+    alignas(64) std::atomic<bool> recording{false};
+
+    // Producer-side counters (read by stats()).
+    std::atomic<std::uint64_t> events{0};
+    std::atomic<std::uint64_t> dropped{0};
+    std::atomic<std::uint64_t> captureNsTotal{0};
+    std::atomic<std::uint64_t> captureNsMax{0};
+
+    // Writer-side state.
+    std::ofstream out;
+    std::string file;
+    std::string lines;                  // event lines waiting to be written (capacity kept)
+    std::string payload;                // one record's bytes (capacity kept)
+    Clock::time_point started{};
+    Clock::time_point lastFlush{};
+    std::atomic<std::uint64_t> fileBytes{0};
+    std::atomic<std::uint64_t> writes{0};
+
+    std::mutex stopMutex;
+    std::condition_variable stopCv;
+    bool stopping{false};
+    std::thread writer;
+};
@@ -0,0 +1,111 @@
+/**
+ * @file RenderPool.cpp
+ * @brief Work-stealing worker pool.
+ */
+
+#include "RenderPool.hpp"
+#include <algorithm>
+
+/**
+ * @brief Start the workers; each parks until the first batch.
+ * @param count Number of threads (at least one).
+ */
+RenderPool::RenderPool(std::size_t count) {
+    count = std::max<std::size_t>(count, 1);
+    workers.reserve(count);
+    for (std::size_t i = 0; i < count; ++i) workers.push_back(std::make_unique<Worker>());
+    for (std::size_t i = 0; i < count; ++i) {
+        workers[i]->thread = std::thread([this, i] { work(i); });
+    }
+}
+
+/**
+ * @brief Stop and join the workers (no batch may be running).
+ */
+RenderPool::~RenderPool() {
+    stopping.store(true);
+    epoch.fetch_add(1);
+    epoch.notify_all();
+    for (auto& w : workers) w->thread.join();
+}
+
+/**
+ * @brief Deal [0, count) round-robin, wake the workers and wait for the batch.
+ */
+void RenderPool::dispatch(std::size_t count, std::size_t grain, Job job, void* fn) {
+    if (count == 0) return;
+    grain = std::max<std::size_t>(grain, 1);
+    const std::size_t total = (count + grain - 1) / grain;
+
+    currentJob = job;
+    currentFn = fn;
+    remaining.store(total);
+    for (std::size_t c = 0; c < total; ++c) {
+        Worker& w = *workers[c % workers.size()];
+        std::lock_guard<std::mutex> lock(w.queueMutex);
+        w.queue.push_back(Range{c * grain, std::min(count, (c + 1) * grain)});
+    }
+
+    // The epoch bump publishes the job (release) to workers woken by it.
+    epoch.fetch_add(1, std::memory_order_release);
+    epoch.notify_all();
+
+    for (std::size_t left = remaining.load(std::memory_order_acquire); left != 0;
+         left = remaining.load(std::memory_order_acquire)) {
+        remaining.wait(left, std::memory_order_acquire);
+    }
+    batches.fetch_add(1, std::memory_order_relaxed);
+    chunks.fetch_add(total, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Pop self's newest range, or steal the oldest range of another worker.
+ * @return false when every queue is empty.
+ */
+bool RenderPool::take(std::size_t self, Range& out) {
+    {
+        Worker& own = *workers[self];
+        std::lock_guard<std::mutex> lock(own.queueMutex);
+        if (!own.queue.empty()) {
+            out = own.queue.back();
+            own.queue.pop_back();
+            return true;
+        }
+    }
+    for (std::size_t k = 1; k < workers.size(); ++k) {
+        Worker& victim = *workers[(self + k) % workers.size()];
+        std::lock_guard<std::mutex> lock(victim.queueMutex);
+        if (!victim.queue.empty()) {
+            out = victim.queue.front();
+            victim.queue.pop_front();
+            steals.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Worker loop: sleep until a batch starts, then drain and steal until nothing is left.
+ */
+void RenderPool::work(std::size_t self) {
+    std::uint64_t seen = 0;
+    for (;;) {
+        epoch.wait(seen, std::memory_order_acquire);
+        seen = epoch.load(std::memory_order_acquire);
+        if (stopping.load()) return;
+
+        Range r{};
+        while (take(self, r)) {
+            currentJob(currentFn, r.begin, r.end);
+            if (remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) remaining.notify_all();
+        }
+    }
+}
+
+/**
+ * @brief Snapshot of the counters.
+ */
+RenderPoolStats RenderPool::stats() const {
+    return RenderPoolStats{batches.load(), chunks.load(), steals.load()};
+}
@@ -0,0 +1,110 @@
+/**
+ * @file RenderPool.hpp
+ * @brief Fixed set of worker threads that split a batch of index ranges by work stealing.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/** @brief Counters of one RenderPool since it was created. */
+struct RenderPoolStats {
+    std::uint64_t batches{0};  // run() calls
+    std::uint64_t chunks{0};   // ranges executed
+    std::uint64_t steals{0};   // ranges taken from another worker's queue
+};
+
+/**
+ * @brief Work-stealing pool for short, independent render jobs.
+ *
+ * run() cuts [0, count) into chunks and deals them round-robin onto the
+ * workers' own queues. A worker pops from the back of its own queue (the
+ * chunk it was just dealt, still warm) and, once that is empty, steals from
+ * the front of the others', so a worker stuck on expensive chunks hands the
+ * rest of its share to whoever is idle. run() returns when every chunk is
+ * done; the caller only waits.
+ *
+ * Each queue has its own small lock, held just long enough to push or pop
+ * one range, so workers only contend when they steal.
+ */
+class RenderPool {
+public:
+    /**
+     * @brief Start the workers.
+     * @param workers Number of threads (at least one).
+     */
+    explicit RenderPool(std::size_t workers);
+    ~RenderPool();
+
+    RenderPool(const RenderPool&) = delete;
+    RenderPool& operator=(const RenderPool&) = delete;
+
+    /** @brief Number of worker threads. */
+    std::size_t size() const { return workers.size(); }
+
+    /**
+     * @brief Call fn(begin, end) over [0, count) in chunks of grain and wait for all of them.
+     *
+     * fn is called concurrently from the workers and must only touch the
+     * items in its range. It is taken by reference rather than boxed, so a
+     * capturing lambda costs no allocation.
+     *
+     * @param count Number of items.
+     * @param grain Items per chunk (at least one).
+     * @param fn Callable as fn(std::size_t begin, std::size_t end).
+     */
+    template <typename F>
+    void run(std::size_t count, std::size_t grain, F& fn) {
+        dispatch(count, grain, &invoke<F>, &fn);
+    }
+
+    RenderPoolStats stats() const;
+
+private:
+    using Job = void (*)(void* fn, std::size_t begin, std::size_t end);
+
+    template <typename F>
+    static void invoke(void* fn, std::size_t begin, std::size_t end) {
+        (*static_cast<F*>(fn))(begin, end);
+    }
+
+    struct Range {
+        std::size_t begin;
+        std::size_t end;
+    };
+
+    /** @brief One worker: its thread and its own queue (padded so queues do not share cache lines). */
+    struct alignas(64) Worker {
+        std::mutex queueMutex;
+        std::deque<Range> queue;
+        std::thread thread;
+    };
+
+    /** @brief Deal the chunks, wake the workers and wait until remaining drops to zero. */
+    void dispatch(std::size_t count, std::size_t grain, Job job, void* fn);
+
+    /** @brief Worker thread body. */
+    void work(std::size_t self);
+
+    /** @brief Take the next range for self: own queue first, then steal. */
+    bool take(std::size_t self, Range& out);
+
+    std::vector<std::unique_ptr<Worker>> workers;
+
+    Job currentJob{nullptr};                     // set before epoch is bumped
+    void* currentFn{nullptr};
+    std::atomic<std::uint64_t> epoch{0};         // bumped once per batch (and on shutdown)
+    std::atomic<std::size_t> remaining{0};       // chunks of the current batch not yet finished
+    std::atomic<bool> stopping{false};
+
+    std::atomic<std::uint64_t> batches{0};
+    std::atomic<std::uint64_t> chunks{0};
+    std::atomic<std::uint64_t> steals{0};
+};
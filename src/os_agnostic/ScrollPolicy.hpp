@@ -0,0 +1,134 @@
+/**
+ * @file ScrollPolicy.hpp
+ * @brief Compile-time scroll policies: how a scroll step maps to what is drawn.
+ */
+
+#pragma once
+
+#include "PreparedText.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+/** @brief Selectable motions (set_mode). Order matches kScrollModeNames. */
+enum class ScrollMode : std::uint8_t { Left, Right, Bounce, Vertical };
+
+inline constexpr std::size_t kScrollModeCount = 4;
+inline constexpr std::string_view kScrollModeNames[kScrollModeCount] = {"left", "right", "bounce", "vertical"};
+
+/**
+ * @brief Look a mode up by name.
+ * @param name One of kScrollModeNames (exact, lowercase).
+ * @param mode Receives the mode on success.
+ * @return true if name was recognised.
+ */
+inline bool parseScrollMode(std::string_view name, ScrollMode& mode) {
+    for (std::size_t i = 0; i < kScrollModeCount; ++i) {
+        if (name == kScrollModeNames[i]) {
+            mode = static_cast<ScrollMode>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+/** @brief Where one frame reads from the text. */
+struct ScrollFrame {
+    std::size_t offset{0};    // first column of every row (rotation)
+    std::size_t rowShift{0};  // display row r shows text row (r + rowShift) mod (rows + 1)
+};
+
+// >>> POLICIES
+//
+// Each policy is a stateless offset-sequence generator:
+//   period(text)    steps before the motion repeats (>= 1),
+//   at(step, text)  the frame for a step in [0, period),
+//   sourceRow(...)  which text row a display row shows; rows() means a blank row.
+// They are only ever used as template arguments, so the render loop is
+// specialised per policy with no virtual calls or per-frame mode checks.
+
+/** @brief Text moves left (the original motion). */
+struct ScrollLeft {
+    static constexpr ScrollMode mode = ScrollMode::Left;
+    static std::size_t period(const PreparedText& t) { return t.width() ? t.width() : 1; }
+    static ScrollFrame at(std::uint64_t step, const PreparedText&) { return {static_cast<std::size_t>(step), 0}; }
+    static std::size_t sourceRow(std::size_t r, const ScrollFrame&, std::size_t) { return r; }
+};
+
+/** @brief Text moves right. */
+struct ScrollRight {
+    static constexpr ScrollMode mode = ScrollMode::Right;
+    static std::size_t period(const PreparedText& t) { return t.width() ? t.width() : 1; }
+    static ScrollFrame at(std::uint64_t step, const PreparedText& t) {
+        return {step ? t.width() - static_cast<std::size_t>(step) : 0, 0};
+    }
+    static std::size_t sourceRow(std::size_t r, const ScrollFrame&, std::size_t) { return r; }
+};
+
+/** @brief Text moves left to the last column, then back right (ping-pong). */
+struct ScrollBounce {
+    static constexpr ScrollMode mode = ScrollMode::Bounce;
+    static std::size_t period(const PreparedText& t) { return t.width() > 1 ? 2 * (t.width() - 1) : 1; }
+    static ScrollFrame at(std::uint64_t step, const PreparedText& t) {
+        const std::size_t s = static_cast<std::size_t>(step);
+        return {s < t.width() ? s : period(t) - s, 0};
+    }
+    static std::size_t sourceRow(std::size_t r, const ScrollFrame&, std::size_t) { return r; }
+};
+
+/** @brief Rows roll upwards, with one blank row between repeats (for multi-row art). */
+struct ScrollVertical {
+    static constexpr ScrollMode mode = ScrollMode::Vertical;
+    static std::size_t period(const PreparedText& t) { return t.rows() + 1; }
+    static ScrollFrame at(std::uint64_t step, const PreparedText&) { return {0, static_cast<std::size_t>(step)}; }
+    static std::size_t sourceRow(std::size_t r, const ScrollFrame& f, std::size_t rows) {
+        return (r + f.rowShift) % (rows + 1);
+    }
+};
+
+/**
+ * @brief Call f with the policy object for mode (cold paths only: one switch per call).
+ * @return Whatever f returns.
+ */
+template <typename F>
+decltype(auto) withScrollPolicy(ScrollMode mode, F&& f) {
+    switch (mode) {
+        case ScrollMode::Right:    return f(ScrollRight{});
+        case ScrollMode::Bounce:   return f(ScrollBounce{});
+        case ScrollMode::Vertical: return f(ScrollVertical{});
+        case ScrollMode::Left:
+        default:                   return f(ScrollLeft{});
+    }
+}
+
+/**
+ * @brief The step that keeps the same characters on screen after an edit.
+ *
+ * Bytes [pos, pos + erased) of before were replaced by inserted bytes
+ * (both already clamped to the text). An edit behind the first visible
+ * column moves that column by the change in size; one that removed it
+ * leaves the view where the replacement starts. Multi-row texts and
+ * vertical motion keep their step, wrapped into the new period.
+ */
+inline std::size_t stepAfterSplice(ScrollMode mode, std::size_t step, const PreparedText& before,
+                                   const PreparedText& after, std::size_t pos, std::size_t erased,
+                                   std::size_t inserted) {
+    return withScrollPolicy(mode, [&](auto policy) -> std::size_t {
+        using Policy = decltype(policy);
+        const std::size_t period = Policy::period(after);
+        if (Policy::mode == ScrollMode::Vertical || before.rows() != 1 || after.rows() != 1
+            || !before.width() || !after.width()) {
+            return step % period;
+        }
+
+        step %= Policy::period(before);
+        const bool returning = Policy::mode == ScrollMode::Bounce && step >= before.width();
+        std::size_t offset = Policy::at(step, before).offset;
+        if (offset >= pos + erased) offset = offset - erased + inserted;
+        else if (offset > pos) offset = pos;
+        offset %= after.width();
+
+        if (Policy::mode == ScrollMode::Right) return offset ? after.width() - offset : 0;
+        return (returning ? period - offset : offset) % period;
+    });
+}
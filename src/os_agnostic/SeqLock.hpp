@@ -0,0 +1,106 @@
+/**
+ * @file SeqLock.hpp
+ * @brief A small value published with a sequence lock: consistent multi-field reads, readers never block writers.
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <type_traits>
+
+/** @brief Assumed cache line size, for keeping shared atomics written by different threads apart. */
+inline constexpr std::size_t kCacheLine = 64;
+
+/**
+ * @brief A trivially copyable T that any thread may read or update.
+ *
+ * load() returns a snapshot taken between two updates, never a mix of
+ * two: the sequence number is odd while an update is in progress and
+ * changes with each one, and a read that saw it change is retried. An
+ * uncontended read is two loads of the sequence plus the value's words.
+ *
+ * Updates take the odd sequence number as their lock, so concurrent
+ * updaters are serialized; readers take no lock at all. Meant for values
+ * read every tick and updated by commands.
+ *
+ * The value is kept as relaxed atomic words, so racing reads are not
+ * data races.
+ */
+template <typename T>
+class alignas(kCacheLine) SeqLock {
+    static_assert(std::is_trivially_copyable_v<T>, "SeqLock values are copied word by word");
+
+public:
+    explicit SeqLock(const T& initial = T{}) { store(initial); }
+
+    SeqLock(const SeqLock&) = delete;
+    SeqLock& operator=(const SeqLock&) = delete;
+
+    /** @brief A consistent copy of the value. */
+    T load() const {
+        for (;;) {
+            const std::uint64_t before = seq.load(std::memory_order_acquire);
+            if (before & 1) {  // an update is in progress
+                std::this_thread::yield();
+                continue;
+            }
+            const T value = readWords();
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (seq.load(std::memory_order_relaxed) == before) return value;
+        }
+    }
+
+    /**
+     * @brief Apply edit to the value and publish the result.
+     * @param edit Called with a T& (keep it short: readers spin meanwhile).
+     */
+    template <typename Edit>
+    void update(Edit&& edit) {
+        std::uint64_t s = seq.load(std::memory_order_relaxed);
+        for (;;) {
+            if (s & 1) {
+                std::this_thread::yield();
+                s = seq.load(std::memory_order_relaxed);
+            } else if (seq.compare_exchange_weak(s, s + 1, std::memory_order_acquire, std::memory_order_relaxed)) {
+                break;
+            }
+        }
+        std::atomic_thread_fence(std::memory_order_release);  // the odd number is seen before any new word
+
+        T value = readWords();
+        edit(value);
+        writeWords(value);
+
+        seq.store(s + 2, std::memory_order_release);
+    }
+
+    /** @brief Replace the value. */
+    void store(const T& value) {
+        update([&value](T& v) { v = value; });
+    }
+
+private:
+    static constexpr std::size_t kWords = (sizeof(T) + sizeof(std::uint64_t) - 1) / sizeof(std::uint64_t);
+
+    T readWords() const {
+        std::array<std::uint64_t, kWords> raw;
+        for (std::size_t i = 0; i < kWords; ++i) raw[i] = words[i].load(std::memory_order_relaxed);
+        T value;
+        std::memcpy(static_cast<void*>(&value), raw.data(), sizeof(T));  // trivially copyable, if not trivial
+        return value;
+    }
+
+    void writeWords(const T& value) {
+        std::array<std::uint64_t, kWords> raw{};
+        std::memcpy(raw.data(), &value, sizeof(T));
+        for (std::size_t i = 0; i < kWords; ++i) words[i].store(raw[i], std::memory_order_relaxed);
+    }
+
+    std::atomic<std::uint64_t> seq{0};
+    std::array<std::atomic<std::uint64_t>, kWords> words{};
+};
@@ -0,0 +1,73 @@
+/**
+ * @file SinkCommands.cpp
+ * @brief The "sink" commands: mirror the console to FIFOs and files.
+ */
+
+#include "CommandHandler.hpp"
+#include "CommandArgs.hpp"
+#include "CommandFeedback.hpp"
+
+/**
+ * @brief Run one "sink <subcommand> ..." line.
+ *
+ * Sinks receive a copy of everything written to the console from the
+ * moment they are added (see Broadcast).
+ *
+ * @param line The whole command line (for the echo).
+ * @param rest Everything after "sink".
+ */
+void CommandHandler::handleSink(std::string_view line, std::string_view rest) {
+  std::pmr::memory_resource* mr = commandArena.resource();
+  std::pmr::string sub{takeWord(rest), mr};
+  toLowerInPlace(sub);
+
+  // >>> SINK ADD
+  if (sub == "add" && !rest.empty()) {
+    std::string error;
+    const std::uint32_t id = ctx.screen->addSink(rest, error);
+    paintEchoFeedbackMarqueePrompt(ctx, mr, line, [&](std::pmr::string& out){
+      if (id) {
+        out += "Sink ";
+        appendNumber(out, id);
+        out += " added.\n";
+      } else {
+        out += "Cannot add sink: ";
+        out += error;
+        out += "\n";
+      }
+    });
+    return;
+  }
+
+  // >>> SINK REMOVE
+  std::size_t id = 0;
+  if (sub == "remove" && parseCount(rest, id)) {
+    const bool removed = ctx.screen->sinks().remove(static_cast<std::uint32_t>(id));
+    paintMessage(ctx, mr, line, removed ? "Sink removed." : "No such sink.");
+    return;
+  }
+
+  // >>> SINK LIST
+  if (sub == "list" && rest.empty()) {
+    std::uint64_t dropped = 0;
+    const std::vector<SinkInfo> sinks = ctx.screen->sinks().list(dropped);
+    paintEchoFeedbackMarqueePrompt(ctx, mr, line, [&](std::pmr::string& out){
+      if (sinks.empty()) out += "No sinks.\n";
+      for (const SinkInfo& s : sinks) {
+        out += "Sink ";            appendNumber(out, s.id);
+        out += ": ";               out += s.spec;
+        out += ", ";               appendNumber(out, s.bytes);
+        out += " bytes written, "; appendNumber(out, s.skipped);
+        out += " chunks skipped, "; appendNumber(out, s.queued);
+        out += " queued\n";
+      }
+      if (dropped) {
+        appendNumber(out, dropped);
+        out += dropped == 1 ? " sink was dropped (write failed).\n" : " sinks were dropped (write failed).\n";
+      }
+    });
+    return;
+  }
+
+  paintMessage(ctx, mr, line, "Usage: sink add <fifo:path|file:path> | sink remove <id> | sink list");
+}
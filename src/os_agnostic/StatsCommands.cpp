@@ -0,0 +1,102 @@
+/**
+ * @file StatsCommands.cpp
+ * @brief The "stats" command: output counters, pacing, CPU use and scheduling.
+ */
+
+#include "CommandHandler.hpp"
+#include "CommandArgs.hpp"
+#include "CommandFeedback.hpp"
+#include "HandlerRegistry.hpp"
+#include <chrono>
+#include <cmath>
+#include <vector>
+
+/**
+ * @brief Run one "stats" line.
+ *
+ * Terminal output counters, the frame scheduler's writes, the pacing and
+ * effect of the marquee, frame lateness, the recording (if any), and the
+ * whole-process CPU use since startup, for comparing --runtime=threads
+ * and --runtime=coro.
+ *
+ * @param line The whole command line (for the echo).
+ */
+void CommandHandler::handleStats(std::string_view line) {
+  std::pmr::memory_resource* mr = commandArena.resource();
+  TerminalStats st;
+  TerminalCaps caps;
+  {
+    std::lock_guard<ConsoleMutex> lock(ctx.coutMutex);
+    st = ctx.terminal.stats();
+    caps = ctx.terminal.caps();
+  }
+  const SchedulerStats sched = ctx.screen->stats();
+
+  // Whole-process figures since startup, for comparing --runtime=threads and --runtime=coro.
+  const ProcessUsage usage = ProcessUsage::now();
+  const double elapsed = std::max(1e-3, std::chrono::duration<double>(std::chrono::steady_clock::now() - ctx.startTime).count());
+  const double cpu = usage.cpuSeconds - ctx.startUsage.cpuSeconds;
+  const std::uint64_t switches = usage.contextSwitches - ctx.startUsage.contextSwitches;
+  const std::uint64_t wakeups = ctx.loop ? ctx.loop->stats().wakeups : 0;
+  const std::vector<HandlerInfo> handlers = ctx.handlers ? ctx.handlers->list() : std::vector<HandlerInfo>{};
+  const std::string scheduling = ctx.schedulingReport();
+
+  paintEchoFeedbackMarqueePrompt(ctx, mr, line, [&](std::pmr::string& out){
+    out += "Frames written: ";  appendNumber(out, st.framesWritten);
+    out += ", dropped: ";       appendNumber(out, st.framesDropped);
+    out += "\nBytes written: ";  appendNumber(out, st.bytesWritten);
+    out += "\nStalls: ";         appendNumber(out, st.stalls);
+    out += " (total ";          appendNumber(out, st.stallNsTotal / 1000000);
+    out += " ms, longest ";     appendNumber(out, st.stallNsMax / 1000000);
+    out += " ms)\nScreen updates: ";  appendNumber(out, sched.updates);
+    out += ", composed writes: "; appendNumber(out, sched.writes);
+    out += "\nPacing: ";          appendReal(out, 1e9 / static_cast<double>(ctx.frameInterval().count()));
+    out += " fps, ";            appendReal(out, ctx.getLanes()->front().velocity);
+    out += " columns/s (";      out += sched.timer;
+    out += "), ";               appendNumber(out, ctx.getLanes()->size());
+    out += ctx.getLanes()->size() == 1 ? " lane" : " lanes";
+    const auto text = ctx.getPrepared();
+    const std::uint64_t frames = ctx.metrics.framesPresented.load(std::memory_order_relaxed);
+    const std::uint64_t bytes = ctx.metrics.frameBytes.load(std::memory_order_relaxed);
+    const std::uint64_t sgrBytes = ctx.metrics.sgrBytes.load(std::memory_order_relaxed);
+    out += "\nEffect: ";          out += kTextEffectNames[static_cast<std::size_t>(text->effect().kind)];
+    out += ", frame ";          appendNumber(out, frames ? bytes / frames : 0);
+    out += " bytes avg, SGR ";  appendNumber(out, frames ? sgrBytes / frames : 0);
+    out += " bytes avg (bound "; appendNumber(out, text->sgrBound());
+    out += ")";
+    const std::uint64_t timed = ctx.metrics.lateFrames.load(std::memory_order_relaxed);
+    out += "\nFrame lateness: ";  appendNumber(out, timed ? ctx.metrics.lateNsTotal.load(std::memory_order_relaxed) / timed / 1000 : 0);
+    out += " us avg, ";         appendNumber(out, ctx.metrics.lateNsMax.load(std::memory_order_relaxed) / 1000);
+    out += " us max over ";     appendNumber(out, timed);
+    out += " frames";
+    const Recorder& rec = ctx.screen->recorder();
+    if (rec.active()) {
+      const RecorderStats rs = rec.stats();
+      out += "\nRecording: ";      out += rec.path();
+      out += ", ";                appendNumber(out, rs.events);
+      out += " events, ";         appendNumber(out, rs.dropped);
+      out += " dropped, capture "; appendNumber(out, rs.events ? rs.captureNsTotal / rs.events : 0);
+      out += " ns avg";
+    }
+    out += "\nRuntime: ";        out += ctx.runtime;
+    out += ", CPU ";            appendReal(out, std::round(cpu / elapsed * 1000) / 10);
+    out += "% (";               appendReal(out, std::round(cpu * 100) / 100);
+    out += " s in ";            appendNumber(out, static_cast<std::uint64_t>(elapsed));
+    out += " s), ";             appendNumber(out, static_cast<std::uint64_t>(static_cast<double>(switches) / elapsed));
+    out += " context switches/s";
+    if (ctx.loop) {
+      out += ", ";              appendNumber(out, static_cast<std::uint64_t>(static_cast<double>(wakeups) / elapsed));
+      out += " loop wakeups/s";
+    }
+    out += "\nHandlers: ";
+    for (std::size_t i = 0; i < handlers.size(); ++i) {
+      if (i) out += ", ";
+      out += handlers[i].name;
+      if (!handlers[i].running) out += " (off)";  // on demand, not needed yet
+    }
+    out += "\nScheduling: ";     out += scheduling;
+    out += "\nSynchronized output: ";
+    out += caps.syncOutput ? "on" : "off";
+    out += caps.probed ? " (terminal reply)\n" : " (TERM table)\n";
+  });
+}
@@ -0,0 +1,52 @@
+/**
+ * @file StatusLine.cpp
+ * @brief Composes the [status] row shown above the marquee.
+ */
+
+#include "StatusLine.hpp"
+#include "CommandArgs.hpp"
+
+/**
+ * @brief Compose "[status] fps | echo latency | queue depth | bytes/s".
+ *
+ * Rates are averaged over the window since the previous refresh. The
+ * string keeps its capacity across refreshes, so this does not allocate in
+ * steady state.
+ *
+ * @param now Current time.
+ * @param out Overwritten with the row text.
+ * @param term Terminal counters (caller holds ctx.coutMutex).
+ */
+void StatusLine::refresh(Clock::time_point now, std::string& out, const TerminalStats& term) {
+    const double secs = std::chrono::duration<double>(now - windowStart).count();
+    const std::uint64_t echoNs = ctx.metrics.echoNsTotal.load(std::memory_order_relaxed);
+    const std::uint64_t echoCount = ctx.metrics.echoCount.load(std::memory_order_relaxed);
+
+    const double fps = secs > 0 ? static_cast<double>(term.framesWritten - lastFrames) / secs : 0.0;
+    const double bytesPerSec = secs > 0 ? static_cast<double>(term.bytesWritten - lastBytes) / secs : 0.0;
+    const std::uint64_t echoes = echoCount - lastEchoCount;
+    const double echoMs = echoes ? static_cast<double>(echoNs - lastEchoNs) / static_cast<double>(echoes) / 1e6 : 0.0;
+
+    out.clear();
+    out += "[status] ";
+    appendFixed(out, fps, 1);
+    out += " fps | echo ";
+    if (echoes) {
+        appendFixed(out, echoMs, 2);
+        out += " ms";
+    } else {
+        out += "-";
+    }
+    out += " | queue ";
+    appendNumber(out, ctx.metrics.queueDepth.load(std::memory_order_relaxed));
+    out += " | ";
+    appendFixed(out, bytesPerSec / 1024.0, 1);
+    out += " KiB/s";
+
+    windowStart = now;
+    nextRefresh = now + kPeriod;
+    lastFrames = term.framesWritten;
+    lastBytes = term.bytesWritten;
+    lastEchoNs = echoNs;
+    lastEchoCount = echoCount;
+}
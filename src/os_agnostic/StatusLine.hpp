@@ -0,0 +1,48 @@
+/**
+ * @file StatusLine.hpp
+ * @brief Composes the [status] row shown above the marquee.
+ */
+
+#pragma once
+
+#include "Context.hpp"
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+/**
+ * @brief Turns the live counters into a one-line summary at a fixed low rate.
+ *
+ * Not a handler: the display thread owns it and folds the row into the same
+ * terminal write as a marquee frame, so the status never costs a write of
+ * its own while the marquee is running.
+ */
+class StatusLine {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    /** @brief How often the row is refreshed (2 Hz). */
+    static constexpr std::chrono::milliseconds kPeriod{500};
+
+    explicit StatusLine(MarqueeContext& c) : ctx(c) {}
+
+    /** @brief Whether a refresh is due at now. */
+    bool due(Clock::time_point now) const { return now >= nextRefresh; }
+
+    /**
+     * @brief Compose the row text for the window ending at now and start a new window.
+     * @param now Current time.
+     * @param out Overwritten with the row text (no cursor movement, no newline).
+     * @param term Terminal counters (caller holds ctx.coutMutex).
+     */
+    void refresh(Clock::time_point now, std::string& out, const TerminalStats& term);
+
+private:
+    MarqueeContext& ctx;
+    Clock::time_point windowStart{Clock::now()};
+    Clock::time_point nextRefresh{Clock::now()};
+    std::uint64_t lastFrames{0};
+    std::uint64_t lastBytes{0};
+    std::uint64_t lastEchoNs{0};
+    std::uint64_t lastEchoCount{0};
+};
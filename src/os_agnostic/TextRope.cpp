@@ -0,0 +1,191 @@
+/**
+ * @file TextRope.cpp
+ * @brief Building, splitting and joining the rope's AVL tree.
+ */
+
+#include "TextRope.hpp"
+#include <algorithm>
+#include <vector>
+
+// >>> METRICS
+
+TextRope::Metrics TextRope::Metrics::of(std::string_view s) {
+    Metrics m;
+    m.bytes = s.size();
+    std::size_t lineStart = 0;
+    for (std::size_t i = 0; i < s.size(); ++i) {
+        if (s[i] != '\n') continue;
+        if (m.newlines++ == 0) m.firstLine = i;
+        m.widestLine = std::max(m.widestLine, i - lineStart);
+        lineStart = i + 1;
+    }
+    m.lastLine = s.size() - lineStart;
+    if (m.newlines == 0) m.firstLine = s.size();
+    m.widestLine = std::max(m.widestLine, m.lastLine);
+    return m;
+}
+
+/**
+ * @brief The last line of this run and the first line of r become one line.
+ */
+TextRope::Metrics TextRope::Metrics::operator+(const Metrics& r) const {
+    Metrics m;
+    m.bytes = bytes + r.bytes;
+    m.newlines = newlines + r.newlines;
+    m.firstLine = newlines ? firstLine : bytes + r.firstLine;
+    m.lastLine = r.newlines ? r.lastLine : lastLine + r.bytes;
+    m.widestLine = std::max({widestLine, r.widestLine, lastLine + r.firstLine});
+    return m;
+}
+
+// >>> TREE
+
+TextRope::Ptr TextRope::leaf(std::string_view s) {
+    auto n = std::make_shared<Node>();
+    n->leaf.assign(s);
+    n->m = Metrics::of(s);
+    return n;
+}
+
+TextRope::Ptr TextRope::node(Ptr l, Ptr r) {
+    auto n = std::make_shared<Node>();
+    n->m = l->m + r->m;
+    n->height = static_cast<std::uint8_t>(std::max(l->height, r->height) + 1);
+    n->left = std::move(l);
+    n->right = std::move(r);
+    return n;
+}
+
+/**
+ * @brief Split s into leaf-sized chunks and pair them up by halves, so sibling heights differ by at most one.
+ */
+TextRope::Ptr TextRope::build(std::string_view s) {
+    if (s.empty()) return nullptr;
+    std::vector<Ptr> level;
+    level.reserve((s.size() + kLeafBytes - 1) / kLeafBytes);
+    for (std::size_t at = 0; at < s.size(); at += kLeafBytes) level.push_back(leaf(s.substr(at, kLeafBytes)));
+
+    auto range = [&level](auto& self, std::size_t lo, std::size_t hi) -> Ptr {
+        if (hi - lo == 1) return level[lo];
+        const std::size_t mid = lo + (hi - lo) / 2;
+        return node(self(self, lo, mid), self(self, mid, hi));
+    };
+    return range(range, 0, level.size());
+}
+
+/**
+ * @brief The usual single and double AVL rotations.
+ */
+TextRope::Ptr TextRope::balance(Ptr l, Ptr r) {
+    if (height(l) > height(r) + 1) {
+        if (height(l->left) >= height(l->right)) return node(l->left, node(l->right, std::move(r)));
+        return node(node(l->left, l->right->left), node(l->right->right, std::move(r)));
+    }
+    if (height(r) > height(l) + 1) {
+        if (height(r->right) >= height(r->left)) return node(node(std::move(l), r->left), r->right);
+        return node(node(std::move(l), r->left->left), node(r->left->right, r->right));
+    }
+    return node(std::move(l), std::move(r));
+}
+
+/**
+ * @brief Descend the taller side until the heights meet, then rebalance on the way up.
+ *
+ * A leaf joined to a tree is taken all the way down to the tree's edge
+ * leaf, so a run of small appends grows the last leaf instead of the
+ * tree. Both ways the result is at most one taller than the taller input.
+ */
+TextRope::Ptr TextRope::join(Ptr l, Ptr r) {
+    if (!l) return r;
+    if (!r) return l;
+    const bool leftLeaf = !l->left;
+    const bool rightLeaf = !r->left;
+    if (leftLeaf && rightLeaf) {
+        if (l->leaf.size() + r->leaf.size() > kLeafBytes) return node(std::move(l), std::move(r));
+        std::string both;
+        both.reserve(l->leaf.size() + r->leaf.size());
+        both.append(l->leaf).append(r->leaf);
+        return leaf(both);
+    }
+    if (rightLeaf || height(l) > height(r) + 1) return balance(l->left, join(l->right, std::move(r)));
+    if (leftLeaf || height(r) > height(l) + 1) return balance(join(std::move(l), r->left), r->right);
+    return node(std::move(l), std::move(r));
+}
+
+/**
+ * @brief Only the path to pos is cut; the subtrees beside it are joined back, shared.
+ */
+std::pair<TextRope::Ptr, TextRope::Ptr> TextRope::split(const Ptr& n, std::size_t pos) {
+    if (!n || pos == 0) return {nullptr, n};
+    if (pos >= n->m.bytes) return {n, nullptr};
+    if (!n->left) {
+        const std::string_view s{n->leaf};
+        return {leaf(s.substr(0, pos)), leaf(s.substr(pos))};
+    }
+    const std::size_t leftBytes = n->left->m.bytes;
+    if (pos <= leftBytes) {
+        auto [a, b] = split(n->left, pos);
+        return {std::move(a), join(std::move(b), n->right)};
+    }
+    auto [a, b] = split(n->right, pos - leftBytes);
+    return {join(n->left, std::move(a)), std::move(b)};
+}
+
+// >>> EDITS AND LOOKUPS
+
+TextRope TextRope::splice(std::size_t pos, std::size_t count, std::string_view insert) const {
+    pos = std::min(pos, size());
+    count = std::min(count, size() - pos);
+    auto [front, rest] = split(root, pos);
+    Ptr back = split(rest, count).second;
+    return TextRope{join(join(std::move(front), build(insert)), std::move(back))};
+}
+
+std::size_t TextRope::lineStart(std::size_t line) const {
+    if (line == 0 || !root) return 0;
+    std::size_t pos = 0;
+    const Node* n = root.get();
+    while (n->left) {
+        if (n->left->m.newlines >= line) {
+            n = n->left.get();
+        } else {
+            line -= n->left->m.newlines;
+            pos += n->left->m.bytes;
+            n = n->right.get();
+        }
+    }
+    for (std::size_t i = 0; i < n->leaf.size(); ++i) {
+        if (n->leaf[i] == '\n' && --line == 0) return pos + i + 1;
+    }
+    return size();  // no such line
+}
+
+std::size_t TextRope::lineLength(std::size_t line) const {
+    const std::size_t start = lineStart(line);
+    const std::size_t end = line + 1 < lines() ? lineStart(line + 1) - 1 : size();
+    return end - start;
+}
+
+std::size_t TextRope::lineOf(std::size_t pos) const {
+    if (!root) return 0;
+    pos = std::min(pos, size());
+    std::size_t line = 0;
+    const Node* n = root.get();
+    while (n->left) {
+        if (pos < n->left->m.bytes) {
+            n = n->left.get();
+        } else {
+            line += n->left->m.newlines;
+            pos -= n->left->m.bytes;
+            n = n->right.get();
+        }
+    }
+    return line + static_cast<std::size_t>(std::count(n->leaf.begin(), n->leaf.begin() + static_cast<std::ptrdiff_t>(std::min(pos, n->leaf.size())), '\n'));
+}
+
+std::string TextRope::str() const {
+    std::string out;
+    out.reserve(size());
+    append(out, 0, size());
+    return out;
+}
@@ -0,0 +1,160 @@
+/**
+ * @file TextRope.hpp
+ * @brief Persistent balanced rope: text that is edited in O(log n) and shared between versions.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+
+/**
+ * @brief Immutable text held as a balanced tree of chunks, with line metrics in every node.
+ *
+ * Each node carries the metrics of the bytes under it (size, newlines,
+ * first, last and widest line), so the number of lines and the widest
+ * line are read off the root, and a line's start is one root-to-leaf
+ * walk. splice() copies only the nodes on the paths it cuts and joins
+ * (O(log n) of them) and shares everything else with the rope it came
+ * from. That rope is never changed, so a reader still holding it (a frame
+ * being rendered) is unaffected, and only the metrics along the edited
+ * paths are computed again.
+ *
+ * The tree is height-balanced (AVL); leaves hold up to kLeafBytes.
+ */
+class TextRope {
+public:
+    /** @brief Largest leaf; text is cut into leaves this size when built. */
+    static constexpr std::size_t kLeafBytes = 512;
+
+    /** @brief Line metrics of a run of bytes ('\n' ends a line). */
+    struct Metrics {
+        std::size_t bytes{0};
+        std::size_t newlines{0};
+        std::size_t firstLine{0};   // bytes before the first '\n' (all of them without one)
+        std::size_t lastLine{0};    // bytes after the last '\n'
+        std::size_t widestLine{0};  // longest line, '\n' not counted
+
+        /** @brief Metrics of s (one scan). */
+        static Metrics of(std::string_view s);
+
+        /** @brief Metrics of this run followed by r. */
+        Metrics operator+(const Metrics& r) const;
+    };
+
+    TextRope() = default;
+
+    /** @brief Build a balanced rope over a copy of s (O(n)). */
+    explicit TextRope(std::string_view s) : root(build(s)) {}
+
+    std::size_t size() const { return root ? root->m.bytes : 0; }
+    bool empty() const { return size() == 0; }
+
+    /** @brief Number of lines (0 for an empty rope; a trailing '\n' starts an empty last line). */
+    std::size_t lines() const { return empty() ? 0 : root->m.newlines + 1; }
+
+    /** @brief Length of the longest line. */
+    std::size_t widestLine() const { return root ? root->m.widestLine : 0; }
+
+    /** @brief Height of the tree (1 for a single leaf, 0 when empty). */
+    std::size_t depth() const { return root ? root->height : 0; }
+
+    /** @brief Byte offset where line starts (line < lines()); O(log n). */
+    std::size_t lineStart(std::size_t line) const;
+
+    /** @brief Length of line without its '\n' (line < lines()); O(log n). */
+    std::size_t lineLength(std::size_t line) const;
+
+    /** @brief Index of the line holding byte pos (the number of '\n' before it); O(log n). */
+    std::size_t lineOf(std::size_t pos) const;
+
+    /**
+     * @brief The rope with bytes [pos, pos + count) replaced by insert.
+     *
+     * pos and count are clamped to the text. O(log n + insert.size()).
+     */
+    TextRope splice(std::size_t pos, std::size_t count, std::string_view insert) const;
+
+    /**
+     * @brief Call f with the pieces of bytes [pos, pos + count), in order.
+     *
+     * Pieces are views into the leaves; a range costs one walk down the
+     * tree plus one call per leaf it touches.
+     */
+    template <typename F>
+    void forEachPiece(std::size_t pos, std::size_t count, F&& f) const {
+        if (!root || pos >= size()) return;
+        count = std::min(count, size() - pos);
+        if (count) walk(root.get(), pos, count, f);
+    }
+
+    /**
+     * @brief Append bytes [pos, pos + count).
+     * @param out Any string-like sink with append(std::string_view).
+     */
+    template <typename Out>
+    void append(Out& out, std::size_t pos, std::size_t count) const {
+        forEachPiece(pos, count, [&out](std::string_view piece) { out.append(piece); });
+    }
+
+    /** @brief The whole text as one string (O(n)). */
+    std::string str() const;
+
+private:
+    struct Node;
+    using Ptr = std::shared_ptr<const Node>;
+
+    /** @brief A leaf holds bytes; an inner node holds two children and no bytes. */
+    struct Node {
+        Ptr left, right;  // both null for a leaf
+        std::string leaf;
+        Metrics m;
+        std::uint8_t height{1};
+    };
+
+    explicit TextRope(Ptr r) : root(std::move(r)) {}
+
+    static std::size_t height(const Ptr& n) { return n ? n->height : 0; }
+
+    /** @brief Balanced tree over s, cut into leaves of at most kLeafBytes. */
+    static Ptr build(std::string_view s);
+    static Ptr leaf(std::string_view s);
+
+    /** @brief Inner node over l and r (heights within one of each other). */
+    static Ptr node(Ptr l, Ptr r);
+
+    /** @brief Inner node over l and r, rotated back into balance (heights at most two apart). */
+    static Ptr balance(Ptr l, Ptr r);
+
+    /** @brief Concatenate l and r; small leaves meeting at the seam are merged. */
+    static Ptr join(Ptr l, Ptr r);
+
+    /** @brief Cut n into bytes [0, pos) and [pos, size). */
+    static std::pair<Ptr, Ptr> split(const Ptr& n, std::size_t pos);
+
+    template <typename F>
+    static void walk(const Node* n, std::size_t pos, std::size_t count, F& f) {
+        while (n->left) {
+            const std::size_t leftBytes = n->left->m.bytes;
+            if (pos >= leftBytes) {
+                pos -= leftBytes;
+                n = n->right.get();
+                continue;
+            }
+            const std::size_t here = std::min(count, leftBytes - pos);
+            walk(n->left.get(), pos, here, f);
+            count -= here;
+            if (!count) return;
+            pos = 0;
+            n = n->right.get();
+        }
+        f(std::string_view{n->leaf}.substr(pos, count));
+    }
+
+    Ptr root;
+};
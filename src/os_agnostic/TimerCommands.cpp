@@ -0,0 +1,163 @@
+/**
+ * @file TimerCommands.cpp
+ * @brief The "at", "every", "timers" and "cancel" commands.
+ */
+
+#include "CommandHandler.hpp"
+#include "CommandArgs.hpp"
+#include "CommandFeedback.hpp"
+#include "HandlerRegistry.hpp"
+#include "TimerHandler.hpp"
+#include <chrono>
+#include <ctime>
+
+/**
+ * @brief How long until the next local wall-clock time "HH:MM" or "HH:MM:SS".
+ * @param arg The time of day.
+ * @param delay Receives the wait (up to a day; a time already past today means tomorrow).
+ * @return false if arg is not a valid time of day.
+ */
+static bool untilTimeOfDay(std::string_view arg, std::chrono::nanoseconds& delay) {
+  std::size_t field[3] = {0, 0, 0};
+  std::size_t fields = 0;
+  while (fields < 3) {
+    const std::size_t colon = arg.find(':');
+    const std::string_view part = arg.substr(0, colon);
+    if (part.empty() || part.size() > 2 || !parseCount(part, field[fields])) return false;
+    ++fields;
+    if (colon == std::string_view::npos) break;
+    arg.remove_prefix(colon + 1);
+  }
+  if (fields < 2 || (fields == 3 && arg.find(':') != std::string_view::npos)
+      || field[0] > 23 || field[1] > 59 || field[2] > 59) return false;
+
+  const auto now = std::chrono::system_clock::now();
+  const std::time_t t = std::chrono::system_clock::to_time_t(now);
+  std::tm local{};
+#if defined(_WIN32)
+  localtime_s(&local, &t);
+#else
+  localtime_r(&t, &local);
+#endif
+  local.tm_hour = static_cast<int>(field[0]);
+  local.tm_min = static_cast<int>(field[1]);
+  local.tm_sec = static_cast<int>(field[2]);
+  local.tm_isdst = -1;  // let mktime work out daylight saving for that time
+  auto at = std::chrono::system_clock::from_time_t(std::mktime(&local));
+  if (at <= now) {
+    ++local.tm_mday;
+    local.tm_hour = static_cast<int>(field[0]);
+    local.tm_min = static_cast<int>(field[1]);
+    local.tm_sec = static_cast<int>(field[2]);
+    local.tm_isdst = -1;
+    at = std::chrono::system_clock::from_time_t(std::mktime(&local));
+  }
+  delay = std::chrono::duration_cast<std::chrono::nanoseconds>(at - now);
+  return true;
+}
+
+/**
+ * @brief Run one "at", "every", "timers" or "cancel" line.
+ *
+ * Scheduled commands are kept by the TimerHandler, which is started on
+ * the first "at" or "every" and queues each command here when it is due,
+ * as if it had been typed.
+ *
+ * @param line The whole command line (for the echo).
+ * @param cmd Which of the four.
+ * @param rest Everything after it.
+ */
+void CommandHandler::handleTimer(std::string_view line, std::string_view cmd, std::string_view rest) {
+  std::pmr::memory_resource* mr = commandArena.resource();
+  using Clock = TimerHandler::Clock;
+  TimerHandler& timers = *ctx.timers;
+
+  // >>> AT / EVERY
+  if (cmd == "at" || cmd == "every") {
+    const bool repeat = cmd == "every";
+    std::string_view args = rest;
+    const std::string_view when = takeWord(args);
+    const std::string_view command = trimView(args);
+    std::chrono::nanoseconds delay{0};
+    bool valid = !command.empty();
+    if (valid && repeat) {
+      valid = parseDuration(when, delay) && delay >= TimerHandler::kMinEvery;
+    } else if (valid) {
+      valid = when.size() > 1 && when.front() == '+' ? parseDuration(when.substr(1), delay) : untilTimeOfDay(when, delay);
+    }
+    if (!valid) {
+      paintMessage(ctx, mr, line, repeat ? "Usage: every <interval of 100ms or more> <command>"
+                                         : "Usage: at <HH:MM[:SS]|+delay> <command>");
+      return;
+    }
+
+    if (!ctx.handlers->ensureStarted("timers")) {
+      paintMessage(ctx, mr, line, "Cannot schedule: the console is shutting down.");
+      return;
+    }
+    const auto first = Clock::now() + std::chrono::duration_cast<Clock::duration>(delay);
+    const std::uint64_t id = timers.add(first, repeat ? std::chrono::duration_cast<Clock::duration>(delay) : Clock::duration{},
+                                        std::string{command});
+    paintEchoFeedbackMarqueePrompt(ctx, mr, line, [&](std::pmr::string& out){
+      if (!id) {
+        out += "Too many timers (";
+        appendNumber(out, TimerHandler::kMaxTimers);
+        out += " pending).\n";
+        return;
+      }
+      out += "Timer ";    appendNumber(out, id);
+      out += repeat ? ": every " : ": in ";
+      appendDuration(out, delay);
+      out += ", runs \""; out += command;
+      out += "\"\n";
+    });
+    return;
+  }
+
+  // >>> CANCEL
+  if (cmd == "cancel") {
+    const std::string_view arg = trimView(rest);
+    std::size_t id = 0;
+    if (arg == "all") {
+      const std::size_t n = timers.cancelAll();
+      paintEchoFeedbackMarqueePrompt(ctx, mr, line, [&](std::pmr::string& out){
+        appendNumber(out, n);
+        out += n == 1 ? " timer cancelled.\n" : " timers cancelled.\n";
+      });
+    } else if (parseCount(arg, id)) {
+      paintMessage(ctx, mr, line, timers.cancel(id) ? "Timer cancelled." : "No such timer.");
+    } else {
+      paintMessage(ctx, mr, line, "Usage: cancel <id|all>");
+    }
+    return;
+  }
+
+  // >>> TIMERS (the soonest few; there may be tens of thousands)
+  if (!trimView(rest).empty()) {
+    paintMessage(ctx, mr, line, "Usage: timers");
+    return;
+  }
+  constexpr std::size_t kListed = 10;
+  std::size_t total = 0;
+  const std::vector<TimerInfo> soonest = timers.list(kListed, total);
+  paintEchoFeedbackMarqueePrompt(ctx, mr, line, [&](std::pmr::string& out){
+    if (total == 0) {
+      out += "No timers.\n";
+      return;
+    }
+    for (const TimerInfo& t : soonest) {
+      out += "Timer ";  appendNumber(out, t.id);
+      out += ": in ";   appendDuration(out, t.dueIn);
+      if (t.every.count()) {
+        out += ", every "; appendDuration(out, t.every);
+      }
+      out += ", runs \""; out += t.command;
+      out += "\"\n";
+    }
+    if (total > soonest.size()) {
+      out += "... ";
+      appendNumber(out, total - soonest.size());
+      out += " more.\n";
+    }
+  });
+}
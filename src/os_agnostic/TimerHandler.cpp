@@ -0,0 +1,161 @@
+/**
+ * @file TimerHandler.cpp
+ * @brief Runs commands at a given time or at a fixed interval ("at" and "every").
+ */
+
+#include "TimerHandler.hpp"
+#include "FrameScheduler.hpp"
+#include <algorithm>
+#include <mutex>
+
+std::uint64_t TimerHandler::tickAtOrAfter(Clock::time_point t) const {
+    if (t <= epoch) return 0;
+    const auto since = t - epoch;
+    const auto tick = std::chrono::duration_cast<Clock::duration>(kTick);
+    return static_cast<std::uint64_t>((since + tick - Clock::duration{1}) / tick);
+}
+
+std::uint64_t TimerHandler::add(Clock::time_point due, Clock::duration every, std::string command) {
+    const auto tick = std::chrono::duration_cast<Clock::duration>(kTick);
+    const auto everyTicks = every.count() > 0 ? static_cast<std::uint64_t>((every + tick - Clock::duration{1}) / tick) : 0;
+    std::uint64_t id;
+    {
+        std::lock_guard<ProfiledMutex> lock(m);
+        if (wheel.size() >= kMaxTimers) return 0;
+        id = nextUserId++;
+        byUserId.emplace(id, wheel.add(tickAtOrAfter(due), Entry{id, everyTicks, std::move(command)}));
+        changed = true;
+    }
+    kick();
+    return id;
+}
+
+bool TimerHandler::cancel(std::uint64_t id) {
+    std::lock_guard<ProfiledMutex> lock(m);
+    const auto it = byUserId.find(id);
+    if (it == byUserId.end()) return false;
+    wheel.cancel(it->second);
+    byUserId.erase(it);
+    return true;  // the driver may wake for nothing once; it is not worth a kick
+}
+
+std::size_t TimerHandler::cancelAll() {
+    std::lock_guard<ProfiledMutex> lock(m);
+    const std::size_t n = byUserId.size();
+    for (const auto& [userId, wheelId] : byUserId) wheel.cancel(wheelId);
+    byUserId.clear();
+    return n;
+}
+
+std::vector<TimerInfo> TimerHandler::list(std::size_t max, std::size_t& total) const {
+    const Clock::time_point now = Clock::now();
+    std::vector<TimerInfo> out;
+    std::lock_guard<ProfiledMutex> lock(m);
+    total = wheel.size();
+
+    // Keep the max soonest: a bounded max-heap on the due time.
+    struct Pending { std::uint64_t due; const Entry* e; };
+    std::vector<Pending> soonest;
+    const auto later = [](const Pending& a, const Pending& b) { return a.due < b.due || (a.due == b.due && a.e->userId < b.e->userId); };
+    if (max == 0) return out;
+    wheel.forEach([&](Wheel::Id, std::uint64_t due, const Entry& e) {
+        if (soonest.size() < max) {
+            soonest.push_back({due, &e});
+            std::push_heap(soonest.begin(), soonest.end(), later);
+        } else if (later({due, &e}, soonest.front())) {
+            std::pop_heap(soonest.begin(), soonest.end(), later);
+            soonest.back() = {due, &e};
+            std::push_heap(soonest.begin(), soonest.end(), later);
+        }
+    });
+    std::sort_heap(soonest.begin(), soonest.end(), later);
+
+    out.reserve(soonest.size());
+    for (const Pending& p : soonest) {
+        out.push_back({p.e->userId, std::max(timeOf(p.due) - now, Clock::duration::zero()),
+                       p.e->everyTicks * std::chrono::duration_cast<Clock::duration>(kTick), p.e->command});
+    }
+    return out;
+}
+
+/**
+ * @brief Fire everything due by now.
+ *
+ * A repeating timer keeps its phase: if the driver was late by more than
+ * one interval, the missed runs are skipped rather than fired in a burst.
+ */
+void TimerHandler::collectDue(std::vector<std::string>& due) {
+    const Clock::time_point now = Clock::now();
+    const std::uint64_t nowTick = now <= epoch ? 0 : static_cast<std::uint64_t>((now - epoch) / kTick);
+    wheel.advance(nowTick, [&](Wheel::Id, Entry& e) -> std::uint64_t {
+        due.push_back(e.command);
+        if (!e.everyTicks) {
+            byUserId.erase(e.userId);
+            return 0;
+        }
+        const std::uint64_t at = wheel.now();
+        return at + e.everyTicks * ((nowTick - at) / e.everyTicks + 1);
+    });
+}
+
+void TimerHandler::run(std::vector<std::string>& due) {
+    for (const std::string& cmd : due) {
+        if (deliver) deliver(cmd);
+    }
+    due.clear();
+}
+
+void TimerHandler::kick() {
+    {
+        std::lock_guard<ProfiledMutex> lock(m);
+        if (loop) {
+            ctx.screen->pacer().notify();  // ends the loop's sleep; our coroutine recomputes
+            return;
+        }
+    }
+    cv.notify_one();
+}
+
+void TimerHandler::operator()(std::stop_token stop) {
+    std::vector<std::string> due;
+    std::unique_lock<ProfiledMutex> lock(m);
+    while (!stop.stop_requested()) {
+        collectDue(due);
+        if (!due.empty()) {
+            lock.unlock();  // the sink takes the command queue's lock
+            run(due);
+            lock.lock();
+            continue;
+        }
+
+        changed = false;
+        const std::uint64_t next = wheel.nextTick();
+        if (next == Wheel::kNever) {
+            cv.wait(lock, stop, [this] { return changed; });
+        } else {
+            cv.wait_until(lock, stop, timeOf(next), [this] { return changed; });
+        }
+    }
+}
+
+CoroTask TimerHandler::runCoroutine(EventLoop& l) {
+    {
+        std::lock_guard<ProfiledMutex> lock(m);
+        loop = &l;
+    }
+    std::vector<std::string> due;
+    while (!l.stopping() && !ctx.exitRequested.load()) {
+        std::uint64_t next;
+        {
+            std::lock_guard<ProfiledMutex> lock(m);
+            collectDue(due);
+            next = wheel.nextTick();
+        }
+        run(due);
+
+        // With nothing pending the loop's own idle wait bounds the sleep.
+        co_await l.sleepUntil(next == Wheel::kNever ? Clock::time_point::max() : timeOf(next));
+    }
+    std::lock_guard<ProfiledMutex> lock(m);
+    loop = nullptr;
+}
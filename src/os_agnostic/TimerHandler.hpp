@@ -0,0 +1,132 @@
+/**
+ * @file TimerHandler.hpp
+ * @brief Runs commands at a given time or at a fixed interval ("at" and "every").
+ */
+
+#pragma once
+
+#include "Context.hpp"
+#include "CoroRuntime.hpp"
+#include "ProfiledMutex.hpp"
+#include "TimerWheel.hpp"
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <stop_token>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+/** @brief One pending timer (snapshot). */
+struct TimerInfo {
+    std::uint64_t id{0};
+    std::chrono::steady_clock::duration dueIn{};  // from now (never negative)
+    std::chrono::steady_clock::duration every{};  // zero: runs once
+    std::string command;
+};
+
+/**
+ * @brief Keeps the scheduled commands in a TimerWheel and hands each one to
+ * the command queue when it is due.
+ *
+ * Time is counted in kTick steps from construction; a timer never fires
+ * before its time and at most one tick after it. Scheduling and cancelling
+ * are O(1) whatever the number of timers, and the driving thread (or
+ * coroutine) sleeps until the next due tick, so pending timers cost no CPU
+ * until then.
+ *
+ * add(), cancel() and list() may be called from any thread.
+ */
+class TimerHandler : public Handler {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr std::chrono::milliseconds kTick{10};       // resolution of every timer
+    static constexpr std::chrono::milliseconds kMinEvery{100};  // shortest repeat interval
+    static constexpr std::size_t kMaxTimers = 100000;           // add() refuses more
+
+    explicit TimerHandler(MarqueeContext& c) : Handler(c), epoch(Clock::now()) {}
+
+    /**
+     * @brief Fire due timers until stopped.
+     * @param stop Ends the wait for the next timer at once.
+     */
+    void operator()(std::stop_token stop);
+
+    /**
+     * @brief The same loop as a coroutine for the single-threaded runtime.
+     *
+     * Sleeps in the loop until the next due tick; add() cuts the sleep
+     * short through the scheduler's FrameTimer.
+     *
+     * @param loop The loop to sleep on.
+     */
+    CoroTask runCoroutine(EventLoop& loop);
+
+    /**
+     * @brief Where due commands go.
+     * @param sink Takes one command line (only valid during the call).
+     */
+    void setSink(std::function<void(std::string_view)> sink) {
+        deliver = std::move(sink);
+    }
+
+    /**
+     * @brief Schedule command.
+     * @param due When it first runs (a time already past means the next tick).
+     * @param every Repeat interval; zero to run once.
+     * @param command The command line.
+     * @return Its id for cancel(), or 0 if kMaxTimers are already pending.
+     */
+    std::uint64_t add(Clock::time_point due, Clock::duration every, std::string command);
+
+    /** @brief Drop one timer; false if there is no such pending id. */
+    bool cancel(std::uint64_t id);
+
+    /** @brief Drop every timer. @return How many there were. */
+    std::size_t cancelAll();
+
+    /**
+     * @brief The pending timers that are due first.
+     * @param max At most this many, soonest first.
+     * @param total Receives the number pending.
+     */
+    std::vector<TimerInfo> list(std::size_t max, std::size_t& total) const;
+
+private:
+    struct Entry {
+        std::uint64_t userId{0};
+        std::uint64_t everyTicks{0};  // 0: one-shot
+        std::string command;
+    };
+    using Wheel = TimerWheel<Entry>;
+
+    /** @brief The first tick at or after t. */
+    std::uint64_t tickAtOrAfter(Clock::time_point t) const;
+
+    /** @brief When tick begins. */
+    Clock::time_point timeOf(std::uint64_t tick) const { return epoch + tick * kTick; }
+
+    /** @brief Advance the wheel to now; move the due commands into due. Call with m held. */
+    void collectDue(std::vector<std::string>& due);
+
+    /** @brief Hand the collected commands to the sink. Call without m. */
+    void run(std::vector<std::string>& due);
+
+    /** @brief Tell the driver its next deadline may have moved. */
+    void kick();
+
+    const Clock::time_point epoch;                        // tick 0
+    mutable ProfiledMutex m{"timerMutex"};                // guards everything below
+    std::condition_variable_any cv;                       // the thread driver waits here
+    bool changed{false};                                  // a timer was added since the driver last looked
+    Wheel wheel;
+    std::unordered_map<std::uint64_t, Wheel::Id> byUserId;  // user-facing id -> wheel id
+    std::uint64_t nextUserId{1};
+    EventLoop* loop{nullptr};                             // set while running as a coroutine
+
+    std::function<void(std::string_view)> deliver;        // the command sink
+};
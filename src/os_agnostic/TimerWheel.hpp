@@ -0,0 +1,264 @@
+/**
+ * @file TimerWheel.hpp
+ * @brief Hierarchical timing wheel: O(1) insert and cancel for many pending timers.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Timers keyed by an integer tick, kept in four wheels of 256 slots.
+ *
+ * Level L holds the timers due in the current 256^(L+1)-tick block but
+ * not in the current 256^L-tick one, at the slot of their 256^L block.
+ * Whenever the clock enters a new block of level L, that level's slot is
+ * emptied into the levels below (a cascade), so each timer moves at most
+ * three times before it fires. Timers may be up to 2^32 - 1 ticks ahead.
+ *
+ * Each slot is an intrusive doubly-linked list over a slab of nodes, so
+ * add() and cancel() are O(1) and a timer costs no allocation once the
+ * slab has grown. Ids carry the node's generation, so cancelling a timer
+ * that has already fired is a harmless no-op. Per-level occupancy bitmaps
+ * let advance() and nextTick() skip empty stretches.
+ *
+ * Not thread-safe: one owner drives it.
+ *
+ * @tparam T Payload of a timer (moved in on add(), handed to the callback on firing).
+ */
+template <typename T>
+class TimerWheel {
+public:
+    using Id = std::uint64_t;                        // 0 is never a valid id
+    static constexpr std::uint64_t kMaxDelay = (std::uint64_t{1} << 32) - 1;
+    static constexpr std::uint64_t kNever = std::numeric_limits<std::uint64_t>::max();
+
+    /** @param start The tick the wheel is at (timers fire on later ticks). */
+    explicit TimerWheel(std::uint64_t start = 0) : current(start) {
+        for (auto& level : heads) level.fill(kNil);
+    }
+
+    /** @brief Last tick processed by advance(). */
+    std::uint64_t now() const { return current; }
+
+    /** @brief Timers pending. */
+    std::size_t size() const { return count; }
+
+    /**
+     * @brief Schedule value for tick due (clamped to (now(), now() + kMaxDelay]).
+     * @return Its id, for cancel().
+     */
+    Id add(std::uint64_t due, T value) {
+        std::uint32_t index;
+        if (!freeList.empty()) {
+            index = freeList.back();
+            freeList.pop_back();
+        } else {
+            index = static_cast<std::uint32_t>(nodes.size());
+            nodes.emplace_back();
+        }
+        Node& n = nodes[index];
+        n.value = std::move(value);
+        n.live = true;
+        place(index, clampDue(due));
+        ++count;
+        return idOf(index);
+    }
+
+    /** @brief The payload of a pending timer, or nullptr. */
+    T* find(Id id) {
+        const std::uint32_t index = indexOf(id);
+        return index == kNil ? nullptr : &nodes[index].value;
+    }
+
+    /** @brief Due tick of a pending timer (kNever if there is none). */
+    std::uint64_t dueOf(Id id) const {
+        const std::uint32_t index = indexOf(id);
+        return index == kNil ? kNever : nodes[index].due;
+    }
+
+    /** @brief Drop a pending timer; false if it already fired or was cancelled. */
+    bool cancel(Id id) {
+        const std::uint32_t index = indexOf(id);
+        if (index == kNil) return false;
+        unlink(index);
+        release(index);
+        return true;
+    }
+
+    /**
+     * @brief Run the clock up to tick target, firing every timer due on the way, in tick order.
+     *
+     * @param fire Called as fire(id, value) for each due timer; it returns
+     *        the tick to fire again at (the same id stays valid), or 0 to
+     *        finish the timer. It must not add or cancel timers.
+     */
+    template <typename Fire>
+    void advance(std::uint64_t target, Fire&& fire) {
+        while (current < target) {
+            const std::uint64_t next = nextEvent();
+            if (next > target) {
+                current = target;  // nothing to do before target
+                return;
+            }
+            current = next;
+
+            // >>> CASCADE (enter new blocks from the top down)
+            if ((current & kMask) == 0) {
+                if ((current & 0xFFFF) == 0) {
+                    if ((current & 0xFFFFFF) == 0) cascade(3);
+                    cascade(2);
+                }
+                cascade(1);
+            }
+
+            // >>> FIRE (detach the slot first: rescheduled timers land elsewhere)
+            const std::size_t slot = static_cast<std::size_t>(current & kMask);
+            std::uint32_t index = heads[0][slot];
+            heads[0][slot] = kNil;
+            clearBit(0, slot);
+            while (index != kNil) {
+                const std::uint32_t following = nodes[index].next;
+                const std::uint64_t again = fire(idOf(index), nodes[index].value);
+                if (again) {
+                    place(index, clampDue(again));
+                } else {
+                    release(index);
+                }
+                index = following;
+            }
+        }
+    }
+
+    /**
+     * @brief The next tick advance() has work on (kNever with no timers).
+     *
+     * An occupied slot of the current 256-tick block, or else the start
+     * of the next block, whose cascade may bring timers down. Sleeping
+     * until then costs at most one wakeup per 256 ticks for far timers.
+     */
+    std::uint64_t nextTick() const {
+        return count ? nextEvent() : kNever;
+    }
+
+    /** @brief Call visit(id, due, value) for every pending timer (in no particular order). */
+    template <typename Visit>
+    void forEach(Visit&& visit) const {
+        for (std::uint32_t i = 0; i < nodes.size(); ++i) {
+            if (nodes[i].live) visit(idOf(i), nodes[i].due, nodes[i].value);
+        }
+    }
+
+private:
+    static constexpr std::uint32_t kNil = std::numeric_limits<std::uint32_t>::max();
+    static constexpr std::size_t kLevels = 4;
+    static constexpr std::size_t kSlots = 256;
+    static constexpr std::uint64_t kMask = kSlots - 1;
+
+    struct Node {
+        T value{};
+        std::uint64_t due{0};
+        std::uint32_t prev{kNil};
+        std::uint32_t next{kNil};
+        std::uint32_t generation{0};
+        std::uint8_t level{0};
+        bool live{false};
+    };
+
+    Id idOf(std::uint32_t index) const {
+        return (static_cast<Id>(nodes[index].generation) << 32) | (index + 1);
+    }
+
+    /** @brief Node index of a pending timer's id, or kNil. */
+    std::uint32_t indexOf(Id id) const {
+        const std::uint64_t low = id & 0xFFFFFFFFu;
+        if (low == 0 || low > nodes.size()) return kNil;
+        const auto index = static_cast<std::uint32_t>(low - 1);
+        const Node& n = nodes[index];
+        return n.live && n.generation == static_cast<std::uint32_t>(id >> 32) ? index : kNil;
+    }
+
+    std::uint64_t clampDue(std::uint64_t due) const {
+        return std::clamp(due, current + 1, current + kMaxDelay);
+    }
+
+    /** @brief Link node index into the slot its due tick belongs to (now() or later). */
+    void place(std::uint32_t index, std::uint64_t due) {
+        Node& n = nodes[index];
+        n.due = due;
+
+        // The lowest level whose enclosing block is the current one (level 3 if it wraps).
+        std::size_t level = 0;
+        while (level + 1 < kLevels && (due >> (8 * (level + 1))) != (current >> (8 * (level + 1)))) ++level;
+        const auto slot = static_cast<std::size_t>((due >> (8 * level)) & kMask);
+
+        n.level = static_cast<std::uint8_t>(level);
+        n.prev = kNil;
+        n.next = heads[level][slot];
+        if (n.next != kNil) nodes[n.next].prev = index;
+        heads[level][slot] = index;
+        occupied[level][slot / 64] |= std::uint64_t{1} << (slot % 64);
+    }
+
+    void unlink(std::uint32_t index) {
+        Node& n = nodes[index];
+        const auto slot = static_cast<std::size_t>((n.due >> (8 * n.level)) & kMask);
+        if (n.prev != kNil) nodes[n.prev].next = n.next;
+        else heads[n.level][slot] = n.next;
+        if (n.next != kNil) nodes[n.next].prev = n.prev;
+        if (heads[n.level][slot] == kNil) clearBit(n.level, slot);
+    }
+
+    /** @brief Forget a detached node; its id stops being valid. */
+    void release(std::uint32_t index) {
+        Node& n = nodes[index];
+        n.live = false;
+        n.value = T{};
+        ++n.generation;
+        freeList.push_back(index);
+        --count;
+    }
+
+    /** @brief Move the timers of level's slot for the current tick down a level or more. */
+    void cascade(std::size_t level) {
+        const auto slot = static_cast<std::size_t>((current >> (8 * level)) & kMask);
+        std::uint32_t index = heads[level][slot];
+        heads[level][slot] = kNil;
+        clearBit(level, slot);
+        while (index != kNil) {
+            const std::uint32_t following = nodes[index].next;
+            place(index, nodes[index].due);
+            index = following;
+        }
+    }
+
+    void clearBit(std::size_t level, std::size_t slot) {
+        occupied[level][slot / 64] &= ~(std::uint64_t{1} << (slot % 64));
+    }
+
+    /** @brief First tick after current with an occupied level-0 slot, or the next block start. */
+    std::uint64_t nextEvent() const {
+        const std::uint64_t blockEnd = (current | kMask) + 1;
+        const auto from = static_cast<std::size_t>(current & kMask) + 1;
+        for (std::size_t word = from / 64; word < kSlots / 64; ++word) {
+            std::uint64_t bits = occupied[0][word];
+            if (word == from / 64 && from % 64) bits &= ~std::uint64_t{0} << (from % 64);
+            if (bits) return (current & ~kMask) + word * 64 + static_cast<std::size_t>(std::countr_zero(bits));
+        }
+        return blockEnd;
+    }
+
+    std::uint64_t current;
+    std::size_t count{0};
+    std::vector<Node> nodes;                                        // slab; links are indices, so it may grow
+    std::vector<std::uint32_t> freeList;
+    std::array<std::array<std::uint32_t, kSlots>, kLevels> heads;   // kNil: empty slot
+    std::array<std::array<std::uint64_t, kSlots / 64>, kLevels> occupied{};
+};
@@ -0,0 +1,75 @@
+/**
+ * OS-dependent reader for a file another process appends to (like tail -f).
+ * Linux: inotify on the file + eventfd for cancel(), waited on with poll(); no wakeups while idle
+ * Other POSIX: stat() every 100 ms
+ * Windows: GetFileSizeEx() every 100 ms, cancel() through an event
+ *
+ * One thread opens, waits and reads; cancel() may come from any thread.
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+class FileFollower {
+public:
+  /** @brief How often the polling backends look at the file. */
+  static constexpr int kPollMs = 100;
+
+  FileFollower();
+  ~FileFollower();
+  FileFollower(const FileFollower&) = delete;
+  FileFollower& operator=(const FileFollower&) = delete;
+
+  /**
+   * @brief Start following path (closing any previous file).
+   *
+   * Reading starts tailBytes before the current end, so the first
+   * readNew() returns the end of what is already there.
+   *
+   * @param error Receives a short reason on failure.
+   * @return true if the file is open and watched.
+   */
+  bool open(const std::string& path, std::size_t tailBytes, std::string& error);
+
+  /** @brief Stop watching and close the file. */
+  void close();
+
+  /** @brief What ended a wait(). */
+  enum class Event { Changed, Gone, Cancelled };
+
+  /**
+   * @brief Block until the file may have grown, was removed or renamed, or cancel() was called.
+   *
+   * A cancel() that arrives before the wait starts is not lost: the next
+   * wait returns Cancelled at once.
+   */
+  Event wait();
+
+  /** @brief Make the current (or next) wait() return Cancelled. */
+  void cancel();
+
+  /**
+   * @brief Append the bytes added since the last call.
+   *
+   * Only the new bytes are read. If the file shrank (truncated or
+   * rewritten), reading starts over from its beginning.
+   *
+   * @param out Receives the bytes (appended).
+   * @param max Most bytes to read; the rest is left for the next call.
+   * @param truncated Set to true if the file shrank.
+   * @return Bytes appended.
+   */
+  std::size_t readNew(std::string& out, std::size_t max, bool& truncated);
+
+  /** @brief Byte offset of the next read. */
+  std::uint64_t offset() const;
+
+  /** @brief Name of the mechanism in use ("inotify", "stat poll", "size poll"). */
+  const char* backend() const;
+
+private:
+  struct Impl;
+  Impl* impl;
+};
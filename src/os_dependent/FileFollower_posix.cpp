@@ -0,0 +1,240 @@
+/**
+ * POSIX implementation of FileFollower
+ */
+#include "../os_dependent/FileFollower.hpp"
+
+#if !defined(_WIN32)
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#if defined(__linux__)
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+
+// The kernel tells us when the file is written; poll() blocks on that and
+// on the eventfd that cancel() writes, so an idle follower costs nothing.
+struct FileFollower::Impl {
+  int fileFd{-1};
+  int watchFd{-1};
+  int wakeFd{-1};
+  int wd{-1};
+  std::uint64_t offset{0};
+
+  Impl() {
+    watchFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  }
+
+  ~Impl() {
+    close();
+    if (watchFd != -1) ::close(watchFd);
+    if (wakeFd != -1) ::close(wakeFd);
+  }
+
+  bool watch(const std::string& path, std::string& error) {
+    if (watchFd == -1) {
+      error = "inotify is not available";
+      return false;
+    }
+    wd = inotify_add_watch(watchFd, path.c_str(), IN_MODIFY | IN_ATTRIB | IN_DELETE_SELF | IN_MOVE_SELF);
+    if (wd == -1) {
+      error = std::strerror(errno);
+      return false;
+    }
+    return true;
+  }
+
+  void close() {
+    if (wd != -1) inotify_rm_watch(watchFd, wd);
+    wd = -1;
+    if (fileFd != -1) ::close(fileFd);
+    fileFd = -1;
+
+    // Events of the old file must not wake the next wait.
+    alignas(inotify_event) char buf[4096];
+    while (::read(watchFd, buf, sizeof buf) > 0) {}
+  }
+
+  Event wait() {
+    pollfd fds[2] = {{wakeFd, POLLIN, 0}, {watchFd, POLLIN, 0}};
+    while (true) {
+      const int r = ::poll(fds, 2, -1);
+      if (r < 0 && errno == EINTR) continue;
+      if (r < 0) return Event::Gone;
+      break;
+    }
+
+    std::uint64_t n = 0;
+    if (::read(wakeFd, &n, sizeof n) == static_cast<ssize_t>(sizeof n)) return Event::Cancelled;
+
+    // Drain every queued event; one read of the file covers them all.
+    bool gone = false;
+    alignas(inotify_event) char buf[4096];
+    ssize_t len;
+    while ((len = ::read(watchFd, buf, sizeof buf)) > 0) {
+      for (ssize_t i = 0; i < len;) {
+        const auto* ev = reinterpret_cast<const inotify_event*>(buf + i);
+        if (ev->mask & (IN_DELETE_SELF | IN_MOVE_SELF | IN_IGNORED)) gone = true;
+        i += static_cast<ssize_t>(sizeof(inotify_event) + ev->len);
+      }
+    }
+
+    // Our open descriptor keeps an unlinked file alive (no IN_DELETE_SELF
+    // until it is closed); the unlink shows up as IN_ATTRIB on the link count.
+    struct stat st{};
+    if (!gone && ::fstat(fileFd, &st) == 0 && st.st_nlink == 0) gone = true;
+    return gone ? Event::Gone : Event::Changed;
+  }
+
+  void cancel() {
+    const std::uint64_t one = 1;
+    (void)::write(wakeFd, &one, sizeof one);
+  }
+
+  void takeCancel() {
+    std::uint64_t n = 0;
+    (void)::read(wakeFd, &n, sizeof n);
+  }
+
+  const char* backend() const { return "inotify"; }
+};
+
+#else
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+
+// No inotify: look at the size and modification time every kPollMs.
+struct FileFollower::Impl {
+  int fileFd{-1};
+  std::uint64_t offset{0};
+  std::string path;
+  struct stat last{};
+  std::mutex m;
+  std::condition_variable cv;
+  bool cancelled{false};
+
+  ~Impl() { close(); }
+
+  bool watch(const std::string& p, std::string& error) {
+    if (::stat(p.c_str(), &last) != 0) {
+      error = std::strerror(errno);
+      return false;
+    }
+    path = p;
+    return true;
+  }
+
+  void close() {
+    if (fileFd != -1) ::close(fileFd);
+    fileFd = -1;
+  }
+
+  Event wait() {
+    std::unique_lock<std::mutex> lock(m);
+    while (true) {
+      if (cv.wait_for(lock, std::chrono::milliseconds(kPollMs), [this] { return cancelled; })) {
+        cancelled = false;
+        return Event::Cancelled;
+      }
+      struct stat now{};
+      if (::stat(path.c_str(), &now) != 0) return Event::Gone;
+      if (now.st_ino != last.st_ino || now.st_dev != last.st_dev) return Event::Gone;  // replaced
+      const bool changed = now.st_size != last.st_size || now.st_mtime != last.st_mtime;
+      last = now;
+      if (changed) return Event::Changed;
+    }
+  }
+
+  void cancel() {
+    {
+      std::lock_guard<std::mutex> lock(m);
+      cancelled = true;
+    }
+    cv.notify_one();
+  }
+
+  void takeCancel() {
+    std::lock_guard<std::mutex> lock(m);
+    cancelled = false;
+  }
+
+  const char* backend() const { return "stat poll"; }
+};
+#endif
+
+FileFollower::FileFollower() : impl(new Impl()) {}
+FileFollower::~FileFollower() { delete impl; }
+
+bool FileFollower::open(const std::string& path, std::size_t tailBytes, std::string& error) {
+  impl->close();
+  impl->takeCancel();  // a cancel meant for the previous file
+
+  impl->fileFd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  struct stat st{};
+  if (impl->fileFd == -1 || ::fstat(impl->fileFd, &st) != 0) {
+    error = std::strerror(errno);
+    impl->close();
+    return false;
+  }
+  if (!S_ISREG(st.st_mode)) {
+    error = "not a regular file";
+    impl->close();
+    return false;
+  }
+
+  // Watch before taking the size, so nothing appended in between is missed.
+  if (!impl->watch(path, error)) {
+    impl->close();
+    return false;
+  }
+  const auto size = static_cast<std::uint64_t>(st.st_size);
+  impl->offset = size > tailBytes ? size - tailBytes : 0;
+  return true;
+}
+
+void FileFollower::close() { impl->close(); }
+FileFollower::Event FileFollower::wait() { return impl->wait(); }
+void FileFollower::cancel() { impl->cancel(); }
+std::uint64_t FileFollower::offset() const { return impl->offset; }
+const char* FileFollower::backend() const { return impl->backend(); }
+
+std::size_t FileFollower::readNew(std::string& out, std::size_t max, bool& truncated) {
+  truncated = false;
+  if (impl->fileFd == -1) return 0;
+
+  struct stat st{};
+  if (::fstat(impl->fileFd, &st) != 0) return 0;
+  const auto size = static_cast<std::uint64_t>(st.st_size);
+  if (size < impl->offset) {
+    impl->offset = 0;
+    truncated = true;
+  }
+
+  // pread from our own offset: only the new bytes, nothing before them.
+  const std::size_t want = static_cast<std::size_t>(std::min<std::uint64_t>(size - impl->offset, max));
+  const std::size_t start = out.size();
+  out.resize(start + want);
+  std::size_t got = 0;
+  while (got < want) {
+    const ssize_t r = ::pread(impl->fileFd, out.data() + start + got, want - got,
+                              static_cast<off_t>(impl->offset + got));
+    if (r < 0 && errno == EINTR) continue;
+    if (r <= 0) break;
+    got += static_cast<std::size_t>(r);
+  }
+  out.resize(start + got);
+  impl->offset += got;
+  return got;
+}
+
+#else
+// Windows builds should use the other translation unit
+struct DummyPosixFileFollower {};
+#endif
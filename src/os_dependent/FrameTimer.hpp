@@ -0,0 +1,53 @@
+/**
+ * OS-dependent frame pacing timer.
+ * Linux: timerfd (absolute CLOCK_MONOTONIC deadlines) + eventfd, waited on with poll()
+ * Other POSIX: condition variable
+ * Windows: high-resolution waitable timer + event
+ *
+ * One thread waits; any thread may notify. waitForInput() also watches the
+ * keyboard (stdin), for the single-threaded coroutine runtime.
+ */
+#pragma once
+
+#include <chrono>
+
+class FrameTimer {
+public:
+  using Clock = std::chrono::steady_clock;
+
+  FrameTimer();
+  ~FrameTimer();
+  FrameTimer(const FrameTimer&) = delete;
+  FrameTimer& operator=(const FrameTimer&) = delete;
+
+  /**
+   * @brief Sleep until deadline, or until notify() is called.
+   *
+   * A notify() that arrives before the wait starts is not lost: the next
+   * wait returns immediately.
+   *
+   * @return true if woken by notify(), false if the deadline passed.
+   */
+  bool waitUntil(Clock::time_point deadline);
+
+  /** @brief What ended a waitForInput(). */
+  enum class Wake { Deadline, Notified, Input };
+
+  /**
+   * @brief Like waitUntil(), but also return as soon as stdin has input to read.
+   *
+   * Input wins over a notify() when both are pending; the notification is
+   * then kept for the next wait.
+   */
+  Wake waitForInput(Clock::time_point deadline);
+
+  /** @brief Wake the waiting thread (callable from any thread). */
+  void notify();
+
+  /** @brief Name of the mechanism in use ("timerfd", "condvar", "waitable timer"). */
+  const char* backend() const;
+
+private:
+  struct Impl;
+  Impl* impl;
+};
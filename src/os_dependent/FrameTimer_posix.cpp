@@ -0,0 +1,164 @@
+/**
+ * POSIX implementation of FrameTimer
+ */
+#include "../os_dependent/FrameTimer.hpp"
+
+#if !defined(_WIN32)
+
+#if defined(__linux__)
+#include <cerrno>
+#include <cstdint>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+// steady_clock is CLOCK_MONOTONIC on Linux, so deadlines can be handed to
+// the kernel as absolute times: no drift from computing relative sleeps, and
+// sub-millisecond periods work (the old sleep path was clamped to 10 ms).
+struct FrameTimer::Impl {
+  int timerFd{-1};
+  int wakeFd{-1};
+
+  Impl() {
+    timerFd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  }
+
+  ~Impl() {
+    if (timerFd != -1) close(timerFd);
+    if (wakeFd != -1) close(wakeFd);
+  }
+
+  // Consume pending notifications; true if there were any.
+  bool takeNotify() {
+    std::uint64_t n = 0;
+    return ::read(wakeFd, &n, sizeof n) == static_cast<ssize_t>(sizeof n);
+  }
+
+  bool waitUntil(Clock::time_point deadline) {
+    if (takeNotify()) return true;
+
+    const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(deadline.time_since_epoch()).count();
+    if (ns <= 0 || deadline <= Clock::now()) return false;  // a zero it_value would disarm instead
+
+    itimerspec spec{};
+    spec.it_value.tv_sec = static_cast<time_t>(ns / 1000000000);
+    spec.it_value.tv_nsec = static_cast<long>(ns % 1000000000);
+    timerfd_settime(timerFd, TFD_TIMER_ABSTIME, &spec, nullptr);
+
+    pollfd fds[2] = {{wakeFd, POLLIN, 0}, {timerFd, POLLIN, 0}};
+    while (true) {
+      const int r = ::poll(fds, 2, -1);
+      if (r < 0 && errno == EINTR) continue;
+      if (r <= 0) return false;
+      break;
+    }
+
+    std::uint64_t expirations = 0;
+    if (fds[1].revents & POLLIN) (void)::read(timerFd, &expirations, sizeof expirations);
+    return takeNotify();
+  }
+
+  Wake waitForInput(Clock::time_point deadline) {
+    const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(deadline.time_since_epoch()).count();
+    const bool armed = ns > 0 && deadline > Clock::now();
+    if (armed) {
+      itimerspec spec{};
+      spec.it_value.tv_sec = static_cast<time_t>(ns / 1000000000);
+      spec.it_value.tv_nsec = static_cast<long>(ns % 1000000000);
+      timerfd_settime(timerFd, TFD_TIMER_ABSTIME, &spec, nullptr);
+    }
+
+    // Not armed: only look (the deadline has already passed).
+    pollfd fds[3] = {{STDIN_FILENO, POLLIN, 0}, {wakeFd, POLLIN, 0}, {timerFd, POLLIN, 0}};
+    while (true) {
+      const int r = ::poll(fds, armed ? 3 : 2, armed ? -1 : 0);
+      if (r < 0 && errno == EINTR) continue;
+      break;
+    }
+
+    std::uint64_t expirations = 0;
+    if (armed && (fds[2].revents & POLLIN)) (void)::read(timerFd, &expirations, sizeof expirations);
+    if (fds[0].revents & (POLLIN | POLLHUP)) return Wake::Input;
+    if (takeNotify()) return Wake::Notified;
+    return Wake::Deadline;
+  }
+
+  void notify() {
+    const std::uint64_t one = 1;
+    (void)::write(wakeFd, &one, sizeof one);
+  }
+
+  const char* backend() const { return "timerfd"; }
+};
+
+#else
+#include <algorithm>
+#include <condition_variable>
+#include <mutex>
+#include <sys/select.h>
+#include <unistd.h>
+
+// No timerfd: a condition variable with an absolute deadline does the job.
+struct FrameTimer::Impl {
+  std::mutex m;
+  std::condition_variable cv;
+  bool notified{false};
+
+  bool waitUntil(Clock::time_point deadline) {
+    std::unique_lock<std::mutex> lock(m);
+    cv.wait_until(lock, deadline, [this] { return notified; });
+    const bool woken = notified;
+    notified = false;
+    return woken;
+  }
+
+  // select() cannot see the condition variable, so notifications are
+  // checked between short input waits.
+  Wake waitForInput(Clock::time_point deadline) {
+    static constexpr auto kSlice = std::chrono::milliseconds(5);
+    do {
+      {
+        std::lock_guard<std::mutex> lock(m);
+        if (notified) {
+          notified = false;
+          return Wake::Notified;
+        }
+      }
+      const auto left = std::clamp<Clock::duration>(deadline - Clock::now(), Clock::duration::zero(), kSlice);
+      const auto us = std::chrono::duration_cast<std::chrono::microseconds>(left).count();
+      fd_set fds;
+      FD_ZERO(&fds);
+      FD_SET(STDIN_FILENO, &fds);
+      timeval tv{};
+      tv.tv_sec = static_cast<time_t>(us / 1000000);
+      tv.tv_usec = static_cast<suseconds_t>(us % 1000000);
+      if (select(STDIN_FILENO + 1, &fds, nullptr, nullptr, &tv) > 0) return Wake::Input;
+    } while (Clock::now() < deadline);
+    return Wake::Deadline;
+  }
+
+  void notify() {
+    {
+      std::lock_guard<std::mutex> lock(m);
+      notified = true;
+    }
+    cv.notify_one();
+  }
+
+  const char* backend() const { return "condvar"; }
+};
+#endif
+
+FrameTimer::FrameTimer() : impl(new Impl()) {}
+FrameTimer::~FrameTimer() { delete impl; }
+bool FrameTimer::waitUntil(Clock::time_point deadline) { return impl->waitUntil(deadline); }
+FrameTimer::Wake FrameTimer::waitForInput(Clock::time_point deadline) { return impl->waitForInput(deadline); }
+void FrameTimer::notify() { impl->notify(); }
+const char* FrameTimer::backend() const { return impl->backend(); }
+
+#else
+// Windows builds should use the other translation unit
+struct DummyPosixFrameTimer {};
+#endif
@@ -0,0 +1,16 @@
+/**
+ * OS-dependent process resource usage (for comparing the console runtimes).
+ * POSIX: getrusage(RUSAGE_SELF)
+ * Windows: GetProcessTimes (no context switch count: always 0)
+ */
+#pragma once
+
+#include <cstdint>
+
+struct ProcessUsage {
+  double cpuSeconds{0};             // user + system time of every thread so far
+  std::uint64_t contextSwitches{0}; // voluntary + involuntary, every thread so far
+
+  /** @brief The process's usage up to now. */
+  static ProcessUsage now();
+};
@@ -0,0 +1,22 @@
+/**
+ * POSIX implementation of ProcessUsage
+ */
+#include "../os_dependent/ProcessUsage.hpp"
+
+#if !defined(_WIN32)
+#include <sys/resource.h>
+
+ProcessUsage ProcessUsage::now() {
+  ProcessUsage u;
+  rusage ru{};
+  if (getrusage(RUSAGE_SELF, &ru) != 0) return u;
+  u.cpuSeconds = static_cast<double>(ru.ru_utime.tv_sec + ru.ru_stime.tv_sec)
+               + static_cast<double>(ru.ru_utime.tv_usec + ru.ru_stime.tv_usec) / 1e6;
+  u.contextSwitches = static_cast<std::uint64_t>(ru.ru_nvcsw + ru.ru_nivcsw);
+  return u;
+}
+
+#else
+// Windows builds should use the other translation unit
+struct DummyPosixProcessUsage {};
+#endif
@@ -0,0 +1,28 @@
+/**
+ * Windows implementation of ProcessUsage
+ */
+#include "../os_dependent/ProcessUsage.hpp"
+
+#if defined(_WIN32)
+#include <windows.h>
+
+static double seconds(const FILETIME& ft) {
+  ULARGE_INTEGER t;
+  t.LowPart = ft.dwLowDateTime;
+  t.HighPart = ft.dwHighDateTime;
+  return static_cast<double>(t.QuadPart) / 1e7;  // 100 ns units
+}
+
+ProcessUsage ProcessUsage::now() {
+  ProcessUsage u;
+  FILETIME created, exited, kernel, user;
+  if (GetProcessTimes(GetCurrentProcess(), &created, &exited, &kernel, &user)) {
+    u.cpuSeconds = seconds(kernel) + seconds(user);
+  }
+  return u;
+}
+
+#else
+// Non-windows translation unit should be empty to avoid duplicate symbols.
+struct DummyWinProcessUsage {};
+#endif
@@ -0,0 +1,51 @@
+/**
+ * OS-dependent output sink (a file or a FIFO/named pipe that mirrors the console).
+ * POSIX: open(O_NONBLOCK) + writev, so one call hands over every queued chunk
+ * Windows: CreateFile + WriteFile per chunk (blocking; only the fan-out thread waits)
+ *
+ * Owned and written by one thread at a time.
+ */
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+class SinkFile {
+public:
+  enum class Kind { File, Fifo };
+
+  /** @brief Most chunks one writeSome() call takes. */
+  static constexpr std::size_t kMaxParts = 64;
+
+  SinkFile();
+  ~SinkFile();
+  SinkFile(const SinkFile&) = delete;
+  SinkFile& operator=(const SinkFile&) = delete;
+
+  /**
+   * @brief Open path for writing.
+   *
+   * A file is created if needed and appended to. A FIFO is created if it
+   * does not exist; it can be opened before any reader attaches.
+   *
+   * @param error Receives a short reason on failure.
+   * @return true if the sink is ready.
+   */
+  bool open(Kind kind, const std::string& path, std::string& error);
+
+  /** @brief Path of the platform's null device ("/dev/null", "NUL"). */
+  static const char* nullDevice();
+
+  /**
+   * @brief Write as much of parts (in order) as the sink takes without blocking.
+   * @param parts Chunks to write back to back.
+   * @param count Number of chunks (at most kMaxParts).
+   * @return Bytes written (0 when the sink is full), or -1 if the sink is broken.
+   */
+  long long writeSome(const std::string_view* parts, std::size_t count);
+
+private:
+  struct Impl;
+  Impl* impl;
+};
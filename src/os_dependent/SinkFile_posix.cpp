@@ -0,0 +1,79 @@
+/**
+ * POSIX implementation of SinkFile
+ */
+#include "../os_dependent/SinkFile.hpp"
+
+#if !defined(_WIN32)
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+struct SinkFile::Impl {
+  int fd{-1};
+
+  ~Impl() {
+    if (fd != -1) close(fd);
+  }
+};
+
+SinkFile::SinkFile() : impl(new Impl) {}
+SinkFile::~SinkFile() { delete impl; }
+
+bool SinkFile::open(Kind kind, const std::string& path, std::string& error) {
+  int flags = O_NONBLOCK | O_CLOEXEC;
+  if (kind == Kind::Fifo) {
+    if (mkfifo(path.c_str(), 0644) != 0 && errno != EEXIST) {
+      error = std::strerror(errno);
+      return false;
+    }
+    // Read-write keeps the FIFO open with no reader attached (a daemon may
+    // start later, or restart). Holding the read end means a write never
+    // fails with EPIPE: without a reader the pipe fills up and Broadcast
+    // skips the sink until one attaches and reads.
+    flags |= O_RDWR;
+  } else {
+    flags |= O_WRONLY | O_CREAT | O_APPEND;
+  }
+
+  impl->fd = ::open(path.c_str(), flags, 0644);
+  if (impl->fd == -1) {
+    error = std::strerror(errno);
+    return false;
+  }
+
+  struct stat st{};
+  if (fstat(impl->fd, &st) == 0 && kind == Kind::Fifo && !S_ISFIFO(st.st_mode)) {
+    error = "not a FIFO";
+    close(impl->fd);
+    impl->fd = -1;
+    return false;
+  }
+  return true;
+}
+
+const char* SinkFile::nullDevice() { return "/dev/null"; }
+
+long long SinkFile::writeSome(const std::string_view* parts, std::size_t count) {
+  iovec iov[kMaxParts];
+  if (count > kMaxParts) count = kMaxParts;
+  for (std::size_t i = 0; i < count; ++i) {
+    iov[i].iov_base = const_cast<char*>(parts[i].data());
+    iov[i].iov_len = parts[i].size();
+  }
+
+  while (true) {
+    const ssize_t n = ::writev(impl->fd, iov, static_cast<int>(count));
+    if (n >= 0) return n;
+    if (errno == EINTR) continue;
+    if (errno == EAGAIN || errno == EWOULDBLOCK) return 0;
+    return -1;  // EPIPE, EBADF, ENOSPC ...
+  }
+}
+
+#else
+// Windows builds should use the other translation unit
+struct DummyPosixSinkFile {};
+#endif
@@ -0,0 +1,55 @@
+/**
+ * Windows implementation of SinkFile
+ */
+#include "../os_dependent/SinkFile.hpp"
+
+#if defined(_WIN32)
+#include <string>
+#include <windows.h>
+
+// Named pipes must already exist (created by the reading daemon, e.g.
+// fifo:\\.\pipe\marquee); WriteFile blocks, but only the fan-out thread calls it.
+struct SinkFile::Impl {
+  HANDLE h{INVALID_HANDLE_VALUE};
+
+  ~Impl() {
+    if (h != INVALID_HANDLE_VALUE) CloseHandle(h);
+  }
+};
+
+SinkFile::SinkFile() : impl(new Impl) {}
+SinkFile::~SinkFile() { delete impl; }
+
+bool SinkFile::open(Kind kind, const std::string& path, std::string& error) {
+  if (kind == Kind::Fifo) {
+    impl->h = CreateFileA(path.c_str(), GENERIC_WRITE, 0, nullptr, OPEN_EXISTING, 0, nullptr);
+  } else {
+    impl->h = CreateFileA(path.c_str(), FILE_APPEND_DATA, FILE_SHARE_READ, nullptr, OPEN_ALWAYS,
+                          FILE_ATTRIBUTE_NORMAL, nullptr);
+  }
+  if (impl->h == INVALID_HANDLE_VALUE) {
+    error = "cannot open (error " + std::to_string(GetLastError()) + ")";
+    return false;
+  }
+  return true;
+}
+
+const char* SinkFile::nullDevice() { return "NUL"; }
+
+long long SinkFile::writeSome(const std::string_view* parts, std::size_t count) {
+  long long total = 0;
+  for (std::size_t i = 0; i < count && i < kMaxParts; ++i) {
+    DWORD written = 0;
+    if (!WriteFile(impl->h, parts[i].data(), static_cast<DWORD>(parts[i].size()), &written, nullptr)) {
+      return total ? total : -1;
+    }
+    total += written;
+    if (written < parts[i].size()) break;
+  }
+  return total;
+}
+
+#else
+// Non-windows translation unit should be empty to avoid duplicate symbols.
+struct DummyWinSinkFile {};
+#endif
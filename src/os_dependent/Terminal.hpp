@@ -0,0 +1,102 @@
+/**
+ * OS-dependent terminal output.
+ * POSIX: stdout switched to O_NONBLOCK + writev, with a bounded backlog
+ * Windows: plain blocking writes through std::cout
+ *
+ * Not thread-safe on its own; callers hold MarqueeContext::coutMutex.
+ */
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <string_view>
+
+/** @brief What the attached terminal can do (filled once at startup). */
+struct TerminalCaps {
+  bool syncOutput{false};  // DEC private mode 2026 (synchronized update)
+  bool probed{false};      // true if the terminal answered the query, false if TERM decided
+};
+
+/** @brief Output counters (snapshot). */
+struct TerminalStats {
+  std::uint64_t framesWritten{0};  // marquee frames handed to the terminal
+  std::uint64_t framesDropped{0};  // marquee frames replaced by a newer one while the terminal lagged
+  std::uint64_t bytesWritten{0};   // bytes accepted by the terminal
+  std::uint64_t stalls{0};         // times the terminal stopped accepting output
+  std::uint64_t stallNsTotal{0};   // time spent stalled (finished stalls)
+  std::uint64_t stallNsMax{0};     // longest finished stall
+};
+
+/**
+ * @brief Looks TERM / TERM_PROGRAM up in a local table of terminals known to
+ * support synchronized output. Used when the terminal does not answer the probe.
+ */
+inline bool termSupportsSyncOutput(std::string_view term, std::string_view termProgram) {
+  // TERM prefixes, so "foot-extra" or "tmux-256color" also match
+  constexpr std::string_view kTerms[] = {
+    "foot", "kitty", "xterm-kitty", "alacritty", "wezterm", "contour",
+    "xterm-ghostty", "ghostty", "rio", "tmux",
+  };
+  constexpr std::string_view kPrograms[] = {
+    "WezTerm", "iTerm.app", "ghostty", "rio", "tmux", "vscode",
+  };
+  for (auto t : kTerms) {
+    if (term.substr(0, t.size()) == t) return true;
+  }
+  for (auto p : kPrograms) {
+    if (termProgram == p) return true;
+  }
+  return false;
+}
+
+class Terminal {
+public:
+  Terminal();
+  ~Terminal();
+  Terminal(const Terminal&) = delete;
+  Terminal& operator=(const Terminal&) = delete;
+
+  /**
+   * Ask the terminal what it supports (DECRQM for mode 2026, fenced by DA1),
+   * falling back to the TERM table. Must run before the keyboard thread
+   * starts reading stdin.
+   */
+  TerminalCaps probe(int timeoutMs);
+
+  /** Select the output paths for caps once; nothing is re-checked per frame. */
+  void setCaps(const TerminalCaps& caps);
+  TerminalCaps caps() const;
+
+  /**
+   * Write a marquee frame (the parts are sent back to back as one update).
+   * If the terminal is behind, the frame is parked instead and replaced by
+   * any newer frame; returns false in that case.
+   */
+  bool present(std::initializer_list<std::string_view> parts);
+
+  /** Write prompt/feedback output. Never dropped: queued if the terminal is behind. */
+  void emit(std::initializer_list<std::string_view> parts);
+
+  /** Push queued output without blocking (called on every display tick). */
+  void pump();
+
+  /** Block up to timeoutMs for queued output to reach the terminal (used at shutdown). */
+  void drain(int timeoutMs);
+
+  /**
+   * Put stdin's termios and stdout's file flags back as the first Terminal
+   * found them (echo, canonical input, blocking writes). Async-signal-safe
+   * and needs no Terminal: for an exit that skips the destructors.
+   */
+  static void restoreModes();
+
+  TerminalStats stats() const;
+
+  /** Window size in character cells; false (and 80x24) when it cannot be read. */
+  bool size(unsigned& cols, unsigned& rows) const;
+
+private:
+  struct Impl;
+  Impl* impl;
+};
@@ -0,0 +1,318 @@
+/**
+ * POSIX implementation of Terminal
+ */
+#include "../os_dependent/Terminal.hpp"
+
+#if !defined(_WIN32)
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <string>
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/uio.h>
+
+namespace {
+constexpr std::string_view kBeginSync = "\x1b[?2026h";
+constexpr std::string_view kEndSync   = "\x1b[?2026l";
+constexpr std::size_t kOutputBudget   = 16 * 1024;  // backlog (bytes) above which frames are parked
+constexpr int kMaxParts               = 8;          // iovecs per writev (more parts go through the backlog)
+using Clock = std::chrono::steady_clock;
+
+// DA1 reply: ESC [ ? <digits and ';'> c
+bool containsDa1Reply(std::string_view s) {
+  for (auto at = s.find("\x1b[?"); at != std::string_view::npos; at = s.find("\x1b[?", at + 1)) {
+    auto end = s.find_first_not_of("0123456789;", at + 3);
+    if (end != std::string_view::npos && s[end] == 'c') return true;
+  }
+  return false;
+}
+
+std::uint64_t nsBetween(Clock::time_point a, Clock::time_point b) {
+  return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(b - a).count());
+}
+
+// The modes found at startup, for Terminal::restoreModes() (set once, before any thread starts).
+termios gStartTermios{};
+bool gHaveTermios{false};
+int gStartFlags{-1};
+} // namespace
+
+struct Terminal::Impl {
+  int fd{STDOUT_FILENO};
+  int savedFlags{-1};
+  TerminalCaps caps{};
+
+  // Output path chosen once by setCaps(): with or without sync markers.
+  using WriteFn = void (Impl::*)(const std::string_view*, std::size_t);
+  WriteFn writeUpdate{&Impl::writePlain};
+
+  std::string backlog;         // accepted but not yet written (never dropped)
+  std::size_t backlogPos{0};   // first unwritten byte in backlog
+  std::string parked;          // newest frame waiting for the terminal to catch up
+  bool hasParked{false};
+
+  bool stalled{false};
+  Clock::time_point stallStart{};
+  TerminalStats st{};
+
+  Impl() {
+    savedFlags = fcntl(fd, F_GETFL);
+    if (!gHaveTermios && gStartFlags == -1) {  // the first Terminal, before Scanner makes stdin raw
+      gHaveTermios = tcgetattr(STDIN_FILENO, &gStartTermios) == 0;
+      gStartFlags = savedFlags;
+    }
+    if (savedFlags != -1) fcntl(fd, F_SETFL, savedFlags | O_NONBLOCK);
+  }
+
+  ~Impl() {
+    // The console drained within its shutdown budget already; a stalled
+    // terminal must not hold the teardown past the watchdog.
+    drain(0);
+    if (savedFlags != -1) fcntl(fd, F_SETFL, savedFlags);
+  }
+
+  std::size_t queued() const { return backlog.size() - backlogPos; }
+
+  void beginStall() {
+    if (stalled) return;
+    stalled = true;
+    stallStart = Clock::now();
+    ++st.stalls;
+  }
+
+  void endStall() {
+    if (!stalled) return;
+    stalled = false;
+    const std::uint64_t ns = nsBetween(stallStart, Clock::now());
+    st.stallNsTotal += ns;
+    if (ns > st.stallNsMax) st.stallNsMax = ns;
+  }
+
+  // Write as much of the backlog as the terminal takes right now.
+  void flushBacklog() {
+    while (backlogPos < backlog.size()) {
+      const ssize_t n = ::write(fd, backlog.data() + backlogPos, backlog.size() - backlogPos);
+      if (n > 0) {
+        backlogPos += static_cast<std::size_t>(n);
+        st.bytesWritten += static_cast<std::uint64_t>(n);
+        continue;
+      }
+      if (n < 0 && errno == EINTR) continue;
+      if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+        beginStall();
+        return;
+      }
+      break;  // hard error (e.g. hangup): nothing more will get through
+    }
+    backlog.clear();  // keeps capacity
+    backlogPos = 0;
+    endStall();
+  }
+
+  // Send prefix, parts and suffix straight to the fd when nothing is queued; queue whatever is left.
+  // Parts past the kMaxParts iovecs follow the written ones through the backlog, so none is dropped.
+  void send(const std::string_view* parts, std::size_t count,
+            std::string_view prefix = {}, std::string_view suffix = {}) {
+    const std::size_t all = count + 2;
+    const auto part = [&](std::size_t i) { return i == 0 ? prefix : i == all - 1 ? suffix : parts[i - 1]; };
+    if (queued() != 0) {
+      for (std::size_t i = 0; i < all; ++i) backlog.append(part(i));
+      flushBacklog();
+      return;
+    }
+
+    iovec iov[kMaxParts];
+    int cnt = 0;
+    std::size_t total = 0;
+    std::size_t next = 0;  // first part not in iov
+    for (; next < all && cnt < kMaxParts; ++next) {
+      const std::string_view p = part(next);
+      if (p.empty()) continue;
+      iov[cnt].iov_base = const_cast<char*>(p.data());
+      iov[cnt].iov_len = p.size();
+      total += p.size();
+      ++cnt;
+    }
+    ssize_t n;
+    do { n = ::writev(fd, iov, cnt); } while (n < 0 && errno == EINTR);
+    std::size_t written = n > 0 ? static_cast<std::size_t>(n) : 0;
+    st.bytesWritten += written;
+    if (written == total && next == all) return;
+    if (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK) return;  // hard error: drop
+
+    // Partial write: the rest must still go out, or the escape sequences break.
+    const bool partial = written != total;
+    if (partial) beginStall();
+    for (int i = 0; i < cnt; ++i) {
+      const std::string_view p{static_cast<const char*>(iov[i].iov_base), iov[i].iov_len};
+      if (written >= p.size()) { written -= p.size(); continue; }
+      backlog.append(p.substr(written));
+      written = 0;
+    }
+    for (; next < all; ++next) backlog.append(part(next));
+    if (!partial) flushBacklog();  // the terminal took every iovec: try the overflow now
+  }
+
+  void writePlain(const std::string_view* parts, std::size_t count) {
+    send(parts, count);
+  }
+
+  void writeSynced(const std::string_view* parts, std::size_t count) {
+    // Same as writePlain, with the synchronized-update markers around the parts.
+    send(parts, count, kBeginSync, kEndSync);
+  }
+
+  void write(std::initializer_list<std::string_view> parts) {
+    (this->*writeUpdate)(parts.begin(), parts.size());
+  }
+
+  // Once the backlog has drained, the parked frame (if any) goes out.
+  void releaseParked() {
+    if (!hasParked || queued() != 0) return;
+    hasParked = false;
+    ++st.framesWritten;
+    write({parked});
+  }
+
+  bool present(std::initializer_list<std::string_view> parts) {
+    flushBacklog();
+    std::size_t total = 0;
+    for (auto p : parts) total += p.size();
+
+    if (queued() + total > kOutputBudget || (queued() != 0 && hasParked)) {
+      // Terminal is behind: keep only the newest frame.
+      if (hasParked) ++st.framesDropped;
+      parked.clear();
+      for (auto p : parts) parked.append(p);
+      hasParked = true;
+      return false;
+    }
+
+    if (hasParked) {  // superseded by this one
+      hasParked = false;
+      ++st.framesDropped;
+    }
+    ++st.framesWritten;
+    write(parts);
+    return true;
+  }
+
+  void emit(std::initializer_list<std::string_view> parts) {
+    flushBacklog();
+    write(parts);
+  }
+
+  void pump() {
+    flushBacklog();
+    releaseParked();
+  }
+
+  void drain(int timeoutMs) {
+    const auto deadline = Clock::now() + std::chrono::milliseconds(timeoutMs);
+    while (true) {
+      pump();
+      if (queued() == 0 && !hasParked) return;
+      const auto left = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - Clock::now()).count();
+      if (left <= 0) return;
+      pollfd pfd{fd, POLLOUT, 0};
+      if (::poll(&pfd, 1, static_cast<int>(left)) <= 0) return;
+    }
+  }
+
+  TerminalCaps probe(int timeoutMs) {
+    TerminalCaps result{};
+    const char* term = std::getenv("TERM");
+    const char* prog = std::getenv("TERM_PROGRAM");
+    result.syncOutput = termSupportsSyncOutput(term ? term : "", prog ? prog : "");
+
+    if (!isatty(STDIN_FILENO) || !isatty(fd)) return result;
+
+    termios old{};
+    if (tcgetattr(STDIN_FILENO, &old) != 0) return result;
+    termios raw = old;
+    raw.c_lflag &= ~(ICANON | ECHO);
+    raw.c_cc[VMIN] = 0;
+    raw.c_cc[VTIME] = 0;
+    tcsetattr(STDIN_FILENO, TCSANOW, &raw);
+
+    // DECRQM for mode 2026, then DA1: every terminal answers DA1, so its
+    // reply marks the end of whatever the terminal is going to say.
+    const std::string_view query[] = {"\x1b[?2026$p", "\x1b[c"};
+    send(query, 2);
+    drain(timeoutMs);
+
+    std::string reply;
+    const auto deadline = Clock::now() + std::chrono::milliseconds(timeoutMs);
+    bool gotDa1 = false;
+    while (!gotDa1) {
+      const auto left = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - Clock::now()).count();
+      if (left <= 0) break;
+      pollfd pfd{STDIN_FILENO, POLLIN, 0};
+      if (::poll(&pfd, 1, static_cast<int>(left)) <= 0) break;
+      char buf[64];
+      const ssize_t n = ::read(STDIN_FILENO, buf, sizeof buf);
+      if (n <= 0) break;
+      reply.append(buf, static_cast<std::size_t>(n));
+      gotDa1 = containsDa1Reply(reply);
+    }
+
+    if (gotDa1) {
+      // DECRPM reply: ESC [ ? 2026 ; Ps $ y  (1 set, 2 reset, 3 permanently set, 0/4 unsupported)
+      const auto at = reply.find("\x1b[?2026;");
+      if (at != std::string::npos && at + 9 < reply.size()) {
+        const char ps = reply[at + 8];
+        result.syncOutput = (ps == '1' || ps == '2' || ps == '3');
+      } else {
+        result.syncOutput = false;  // answered DA1 but not DECRQM: mode unknown to it
+      }
+      result.probed = true;
+    } else {
+      tcflush(STDIN_FILENO, TCIFLUSH);  // don't let a late reply leak into the prompt
+    }
+
+    tcsetattr(STDIN_FILENO, TCSANOW, &old);
+    return result;
+  }
+
+  void setCaps(const TerminalCaps& c) {
+    caps = c;
+    writeUpdate = caps.syncOutput ? &Impl::writeSynced : &Impl::writePlain;
+  }
+};
+
+Terminal::Terminal() : impl(new Impl()) {}
+Terminal::~Terminal() { delete impl; }
+TerminalCaps Terminal::probe(int timeoutMs) { return impl->probe(timeoutMs); }
+void Terminal::setCaps(const TerminalCaps& caps) { impl->setCaps(caps); }
+TerminalCaps Terminal::caps() const { return impl->caps; }
+bool Terminal::present(std::initializer_list<std::string_view> parts) { return impl->present(parts); }
+void Terminal::emit(std::initializer_list<std::string_view> parts) { impl->emit(parts); }
+void Terminal::pump() { impl->pump(); }
+void Terminal::drain(int timeoutMs) { impl->drain(timeoutMs); }
+
+void Terminal::restoreModes() {
+  if (gHaveTermios) tcsetattr(STDIN_FILENO, TCSANOW, &gStartTermios);
+  if (gStartFlags != -1) fcntl(STDOUT_FILENO, F_SETFL, gStartFlags);
+}
+TerminalStats Terminal::stats() const { return impl->st; }
+
+bool Terminal::size(unsigned& cols, unsigned& rows) const {
+  winsize ws{};
+  if (ioctl(impl->fd, TIOCGWINSZ, &ws) == 0 && ws.ws_col && ws.ws_row) {
+    cols = ws.ws_col;
+    rows = ws.ws_row;
+    return true;
+  }
+  cols = 80;
+  rows = 24;
+  return false;
+}
+
+#else
+// Windows builds should use the other translation unit
+struct DummyPosixTerminal {};
+#endif
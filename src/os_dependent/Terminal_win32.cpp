@@ -0,0 +1,75 @@
+/**
+ * Windows implementation of Terminal
+ */
+#include "../os_dependent/Terminal.hpp"
+
+#if defined(_WIN32)
+#include <cstdlib>
+#include <iostream>
+#include <windows.h>
+
+// The console cannot be switched to non-blocking writes, so this build writes
+// straight through std::cout and never parks frames. Synchronized output is
+// decided from the TERM table only (no stdin probe).
+struct Terminal::Impl {
+  TerminalCaps caps{};
+  bool synced{false};
+  TerminalStats st{};
+
+  void write(std::initializer_list<std::string_view> parts) {
+    if (synced) std::cout << "\x1b[?2026h";
+    for (auto p : parts) {
+      std::cout.write(p.data(), static_cast<std::streamsize>(p.size()));
+      st.bytesWritten += p.size();
+    }
+    if (synced) std::cout << "\x1b[?2026l";
+    std::cout.flush();
+  }
+};
+
+Terminal::Terminal() : impl(new Impl()) {}
+Terminal::~Terminal() { std::cout.flush(); delete impl; }
+
+TerminalCaps Terminal::probe(int) {
+  TerminalCaps result{};
+  const char* term = std::getenv("TERM");
+  const char* prog = std::getenv("TERM_PROGRAM");
+  result.syncOutput = termSupportsSyncOutput(term ? term : "", prog ? prog : "");
+  return result;
+}
+
+void Terminal::setCaps(const TerminalCaps& caps) {
+  impl->caps = caps;
+  impl->synced = caps.syncOutput;
+}
+
+TerminalCaps Terminal::caps() const { return impl->caps; }
+
+bool Terminal::present(std::initializer_list<std::string_view> parts) {
+  ++impl->st.framesWritten;
+  impl->write(parts);
+  return true;
+}
+
+void Terminal::emit(std::initializer_list<std::string_view> parts) { impl->write(parts); }
+void Terminal::pump() {}
+void Terminal::drain(int) { std::cout.flush(); }
+void Terminal::restoreModes() {}  // no console mode is changed
+TerminalStats Terminal::stats() const { return impl->st; }
+
+bool Terminal::size(unsigned& cols, unsigned& rows) const {
+  CONSOLE_SCREEN_BUFFER_INFO info;
+  if (GetConsoleScreenBufferInfo(GetStdHandle(STD_OUTPUT_HANDLE), &info)) {
+    cols = static_cast<unsigned>(info.srWindow.Right - info.srWindow.Left + 1);
+    rows = static_cast<unsigned>(info.srWindow.Bottom - info.srWindow.Top + 1);
+    return true;
+  }
+  cols = 80;
+  rows = 24;
+  return false;
+}
+
+#else
+// Non-windows translation unit should be empty to avoid duplicate symbols.
+struct DummyWinTerminal {};
+#endif
@@ -0,0 +1,27 @@
+/**
+ * OS-dependent scheduling of the calling thread (core pinning and priority).
+ * Linux: pthread_setaffinity_np + SCHED_FIFO, falling back to a negative nice for the thread
+ * Other POSIX: SCHED_FIFO only (no affinity)
+ * Windows: SetThreadAffinityMask + SetThreadPriority
+ */
+#pragma once
+
+#include <string>
+
+struct ThreadTuning {
+  static constexpr int kFifoPriority = 10;  // low in the real-time range: above every normal thread, below kernel workers
+  static constexpr int kNice = -10;         // the fallback when SCHED_FIFO is not permitted
+
+  int core{-1};          // CPU to pin to (-1: leave as is)
+  bool realtime{false};  // raise priority: SCHED_FIFO when permitted, nice otherwise
+
+  /** @brief Whether there is anything to apply. */
+  bool requested() const { return core >= 0 || realtime; }
+
+  /**
+   * @brief Apply to the calling thread, as far as the system allows.
+   * @return What was actually applied, e.g. "core 2, SCHED_FIFO 10" or
+   *         "core 2, nice -10 (SCHED_FIFO not permitted)".
+   */
+  std::string applyToCurrentThread() const;
+};
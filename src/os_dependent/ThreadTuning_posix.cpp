@@ -0,0 +1,76 @@
+/**
+ * POSIX implementation of ThreadTuning
+ */
+#include "../os_dependent/ThreadTuning.hpp"
+
+#if !defined(_WIN32)
+#include <cerrno>
+#include <cstring>
+#include <pthread.h>
+#include <sched.h>
+
+#if defined(__linux__)
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+/**
+ * @brief Pin the calling thread to core.
+ * @return Empty on success, otherwise why not.
+ */
+static std::string pin(int core) {
+#if defined(__linux__)
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  if (core >= CPU_SETSIZE) return "no such core";
+  CPU_SET(core, &set);
+  const int err = pthread_setaffinity_np(pthread_self(), sizeof set, &set);
+  if (err == EINVAL) return "not among this process's CPUs";
+  return err == 0 ? std::string{} : std::string{std::strerror(err)};
+#else
+  (void)core;
+  return "not supported here";
+#endif
+}
+
+/**
+ * @brief Raise the calling thread's priority.
+ * @return What was applied.
+ */
+static std::string raise() {
+  sched_param param{};
+  param.sched_priority = ThreadTuning::kFifoPriority;
+  const int err = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+  if (err == 0) return "SCHED_FIFO " + std::to_string(ThreadTuning::kFifoPriority);
+
+#if defined(__linux__)
+  // Linux nice values are per thread when set through the thread id.
+  const auto tid = static_cast<id_t>(syscall(SYS_gettid));
+  if (setpriority(PRIO_PROCESS, tid, ThreadTuning::kNice) == 0) {
+    return "nice " + std::to_string(ThreadTuning::kNice) + " (SCHED_FIFO not permitted)";
+  }
+  return std::string{"normal priority (SCHED_FIFO and nice: "} + std::strerror(errno) + ")";
+#else
+  return std::string{"normal priority (SCHED_FIFO: "} + std::strerror(err) + ")";
+#endif
+}
+
+std::string ThreadTuning::applyToCurrentThread() const {
+  std::string applied;
+  if (core >= 0) {
+    const std::string error = pin(core);
+    applied = error.empty() ? "core " + std::to_string(core)
+                            : "any core (pinning to " + std::to_string(core) + ": " + error + ")";
+  }
+  if (realtime) {
+    if (!applied.empty()) applied += ", ";
+    applied += raise();
+  }
+  return applied.empty() ? std::string{"default"} : applied;
+}
+
+#else
+// Windows builds should use the other translation unit
+struct DummyPosixThreadTuning {};
+#endif
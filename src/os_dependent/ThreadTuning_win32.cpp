@@ -0,0 +1,29 @@
+/**
+ * Windows implementation of ThreadTuning
+ */
+#include "../os_dependent/ThreadTuning.hpp"
+
+#if defined(_WIN32)
+#include <windows.h>
+
+std::string ThreadTuning::applyToCurrentThread() const {
+  std::string applied;
+  if (core >= 0) {
+    const bool pinned = core < 64 && SetThreadAffinityMask(GetCurrentThread(), DWORD_PTR{1} << core) != 0;
+    applied = pinned ? "core " + std::to_string(core)
+                     : "any core (pinning to " + std::to_string(core) + " failed)";
+  }
+  if (realtime) {
+    if (!applied.empty()) applied += ", ";
+    // TIME_CRITICAL is the top of the process's class; no special rights needed.
+    applied += SetThreadPriority(GetCurrentThread(), THREAD_PRIORITY_TIME_CRITICAL)
+                   ? "THREAD_PRIORITY_TIME_CRITICAL"
+                   : "normal priority (SetThreadPriority failed)";
+  }
+  return applied.empty() ? std::string{"default"} : applied;
+}
+
+#else
+// Non-windows translation unit should be empty to avoid duplicate symbols.
+struct DummyWinThreadTuning {};
+#endif
@@ -0,0 +1,411 @@
+/**
+ * @file marquee_tests.cpp
+ * @brief Checks on marquee_core that the console cannot show by itself.
+ *
+ * The frame path (timeline, compose, ring, sink write, recorder capture,
+ * markShown) must not allocate once it is warm: every global operator new
+ * is counted while a check runs, and any call fails it. A spliced text
+ * must draw like the same text prepared from scratch, and a frame
+ * rendered before a lane edit must not be marked shown over its steps.
+ * The timer wheel must fire in order across its levels, cancel at any
+ * level and hold TimerHandler's 100000 timers without growing.
+ */
+
+#include "os_agnostic/FrameRing.hpp"
+#include "os_agnostic/MarqueeEngine.hpp"
+#include "os_agnostic/Recorder.hpp"
+#include "os_agnostic/TimerWheel.hpp"
+#include "os_dependent/SinkFile.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <memory>
+#include <new>
+#include <string>
+#include <vector>
+
+// >>> ALLOCATION COUNTING
+
+namespace {
+
+thread_local bool counting = false;     // only the checking thread's allocations count
+std::atomic<std::uint64_t> allocations{0};
+
+void* allocate(std::size_t size) {
+    if (counting) allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc{};
+}
+
+#if !defined(_MSC_VER)  // MSVC has no aligned_alloc; its aligned new stays uncounted
+void* allocateAligned(std::size_t size, std::align_val_t align) {
+    if (counting) allocations.fetch_add(1, std::memory_order_relaxed);
+    const std::size_t a = static_cast<std::size_t>(align);
+    if (void* p = std::aligned_alloc(a, (size + a - 1) / a * a)) return p;
+    throw std::bad_alloc{};
+}
+#endif
+
+/** @brief Counts the global allocations made by this thread while alive. */
+class AllocationScope {
+public:
+    AllocationScope() : before(allocations.load()) { counting = true; }
+    ~AllocationScope() { counting = false; }
+
+    std::uint64_t count() const { return allocations.load() - before; }
+
+private:
+    std::uint64_t before;
+};
+
+}  // namespace
+
+void* operator new(std::size_t size) { return allocate(size); }
+void* operator new[](std::size_t size) { return allocate(size); }
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept { return std::malloc(size ? size : 1); }
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept { return std::malloc(size ? size : 1); }
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+#if !defined(_MSC_VER)
+void* operator new(std::size_t size, std::align_val_t align) { return allocateAligned(size, align); }
+void* operator new[](std::size_t size, std::align_val_t align) { return allocateAligned(size, align); }
+void operator delete(void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept { std::free(p); }
+#endif
+
+// >>> CHECKS
+
+namespace {
+
+int failures = 0;
+
+void check(bool ok, const char* what) {
+    if (ok) return;
+    std::fprintf(stderr, "FAILED: %s\n", what);
+    ++failures;
+}
+
+using Clock = MarqueeEngine::Clock;
+
+/** @brief Lanes covering every pipeline and every way a row is read. */
+std::vector<MarqueeLane> sampleLanes() {
+    std::vector<MarqueeLane> lanes;
+    lanes.push_back(MarqueeLane{std::make_shared<const PreparedText>("Plain text, cached rotations. "), 40.0});
+    lanes.push_back(MarqueeLane{std::make_shared<const PreparedText>("Styled runs ",
+                                                                      TextEffect{TextEffectKind::Rainbow, {}}),
+                                25.0, ScrollMode::Right});
+    lanes.push_back(MarqueeLane{std::make_shared<const PreparedText>("multi\nrow\nart",
+                                                                      TextEffect{TextEffectKind::Gradient, {}}),
+                                7.0, ScrollMode::Bounce});
+    lanes.push_back(MarqueeLane{std::make_shared<const PreparedText>("up\nand\naway"), 3.0, ScrollMode::Vertical});
+    // Over the cache cap: rotations are composed from two pieces.
+    lanes.push_back(MarqueeLane{std::make_shared<const PreparedText>(std::string(600 * 1024, 'x') + " end "), 60.0});
+    // Edited in place: the text the edit commands leave behind (cached rows, and rope only over the cap).
+    const PreparedText edited = PreparedText{"an edited line "}.spliced(3, 6, "spliced");
+    lanes.push_back(MarqueeLane{std::make_shared<const PreparedText>(edited), 30.0});
+    const PreparedText big = PreparedText{std::string(600 * 1024, 'y')}.spliced(10, 0, " edited ");
+    lanes.push_back(MarqueeLane{std::make_shared<const PreparedText>(big), 50.0});
+    return lanes;
+}
+
+/**
+ * @brief Render through a ring, write, capture and mark shown, as the console's display does.
+ *
+ * The virtual clock jumps ahead now and then so catchUp() re-seeks the timeline.
+ */
+void checkFramePathDoesNotAllocate() {
+    MarqueeState st;
+    st.setLanes(sampleLanes());
+    st.setFrameInterval(std::chrono::milliseconds(20));
+    MarqueeEngine engine{st};
+
+    std::string error;
+    SinkFile sink;
+    check(sink.open(SinkFile::Kind::File, SinkFile::nullDevice(), error), "open the null device");
+    const std::filesystem::path cast = std::filesystem::temp_directory_path() / "marquee_tests.cast";
+    Recorder recorder;
+    check(recorder.start(cast.string(), 80, 24, error), "start a recording");
+
+    auto ring = std::make_unique<FrameRing<RenderedFrame, 4>>();
+    Clock::time_point now{};
+    std::uint64_t bytes = 0;
+
+    auto tick = [&](std::uint64_t i) {
+        if (i % 97 == 0) now += std::chrono::seconds(1);  // fell behind
+        if (!engine.sync(now)) {
+            if (!engine.next()) return;
+            engine.catchUp(now);
+        }
+        now = std::max(now, engine.due());
+        RenderedFrame* slot = ring->acquire();
+        engine.render(*slot, true);
+        ring->commit();
+
+        const RenderedFrame* frame = ring->front();
+        const std::string_view view = frame->view();
+        sink.writeSome(&view, 1);
+        recorder.capture({view});
+        engine.markShown(*frame);
+        bytes += frame->size;
+        ring->pop();
+    };
+
+    for (std::uint64_t i = 0; i < 200; ++i) tick(i);  // warm-up
+    bytes = 0;
+    std::uint64_t allocated = 0;
+    {
+        AllocationScope scope;
+        for (std::uint64_t i = 0; i < 20000; ++i) tick(i);
+        allocated = scope.count();
+    }
+    recorder.stop();
+    std::filesystem::remove(cast);
+
+    if (allocated) std::fprintf(stderr, "  %llu allocations in 20000 frames\n", static_cast<unsigned long long>(allocated));
+    check(allocated == 0, "the warm frame path does not allocate");
+    check(bytes > 0, "frames were written");
+}
+
+/** @brief Every row at every offset, as the frames would draw it. */
+std::string drawAll(const PreparedText& text) {
+    std::string out;
+    for (std::size_t r = 0; r < text.rows(); ++r) {
+        for (std::size_t o = 0; o < text.width(); ++o) text.appendRow(out, r, o, text.width());
+    }
+    return out;
+}
+
+/** @brief A spliced text (rows shared or rebuilt) draws exactly like the same text prepared from scratch. */
+void checkSplicedMatchesPrepared() {
+    struct Edit {
+        std::size_t pos, count;
+        std::string_view insert;
+    };
+    const std::string_view sources[] = {"one line of text ", "first\nsecond row\nthird\nlast", "ab\n\ncd\n"};
+    const Edit edits[] = {{0, 0, "start "}, {5, 3, "X"}, {7, 0, "\nnew row\n"}, {3, 9, ""},
+                          {100, 0, " end"}, {2, 1, "a much wider replacement than any row"},
+                          {0, 0, "x\n"}, {17, 6, ""}, {1, 1, "i\nj"}};  // rows move, width stays
+    const TextEffect effects[] = {{}, {TextEffectKind::Rainbow, {}}, {TextEffectKind::Gradient, {}},
+                                  {TextEffectKind::Words, {}}, {TextEffectKind::Highlight, "row"}};
+    for (const std::string_view source : sources) {
+        for (const TextEffect& fx : effects) {
+            for (const std::size_t cap : {PreparedText::kDefaultCacheCapBytes, std::size_t{0}}) {
+                const PreparedText base{source, fx, cap};
+                for (const Edit& e : edits) {
+                    const PreparedText edited = base.spliced(e.pos, e.count, e.insert);
+                    const PreparedText fresh{edited.source(), fx, cap};
+                    const bool same = edited.rows() == fresh.rows() && edited.width() == fresh.width()
+                        && edited.cached() == fresh.cached() && edited.styled() == fresh.styled()
+                        && edited.sgrBound() == fresh.sgrBound() && drawAll(edited) == drawAll(fresh);
+                    if (!same) std::fprintf(stderr, "  \"%s\" spliced at %zu\n", edited.source().c_str(), e.pos);
+                    check(same, "a spliced text draws like the same text prepared from scratch");
+                }
+            }
+        }
+    }
+}
+
+/** @brief A plain edit rebuilds at most kRebuildCapBytes of rows; past that the text is drawn from the rope. */
+void checkSpliceRebuildIsBounded() {
+    std::string art;
+    for (int r = 0; r < 200; ++r) art.append(r ? "\n" : "").append(1000, static_cast<char>('a' + r % 26));
+    const PreparedText base{art};  // 200 KB of rows: cached, over the rebuild cap
+    check(base.cached(), "a large multi-row text is cached");
+
+    const PreparedText sameWidth = base.spliced(5, 1, "#");
+    check(sameWidth.cached(), "an edit that keeps the width rebuilds one row and keeps the cache");
+
+    const PreparedText wider = base.spliced(1000, 0, "past the widest row");
+    check(!wider.cached(), "an edit that would rebuild every row is drawn from the rope");
+
+    for (const PreparedText* edited : {&sameWidth, &wider}) {
+        const PreparedText fresh{edited->source()};
+        bool same = edited->rows() == fresh.rows() && edited->width() == fresh.width();
+        for (const std::size_t row : {std::size_t{0}, std::size_t{100}, std::size_t{199}}) {
+            for (const std::size_t offset : {std::size_t{0}, std::size_t{1}, fresh.width() - 1}) {
+                std::string a, b;
+                edited->appendRow(a, row, offset, fresh.width());
+                fresh.appendRow(b, row, offset, fresh.width());
+                same = same && a == b;
+            }
+        }
+        check(same, "a large edited text draws like the same text prepared from scratch");
+    }
+}
+
+/** @brief A frame of lanes edited since it was rendered must not become the shown steps. */
+void checkStaleFrameKeepsSteps() {
+    MarqueeState st;
+    st.setLanes(sampleLanes());
+    MarqueeEngine engine{st};
+    Clock::time_point now{};
+    engine.sync(now);
+    for (int i = 0; i < 10; ++i) engine.next();
+    RenderedFrame frame;
+    engine.render(frame, true);
+    check(frame.steps[0] > 0, "the lane has moved");
+
+    st.setLaneText(0, "restarted");
+    engine.markShown(frame);
+    check(st.laneSteps[0].load() == 0, "a stale frame leaves the restarted lane's step alone");
+
+    st.removeLane(1);
+    const std::size_t moved = st.laneSteps[1].load();
+    engine.markShown(frame);
+    check(st.laneSteps[1].load() == moved, "a stale frame leaves the steps shifted by a removal alone");
+
+    engine.sync(now);
+    engine.next();
+    engine.render(frame, true);
+    engine.markShown(frame);
+    check(st.laneSteps[0].load() == frame.steps[0], "a current frame is marked shown");
+}
+
+// >>> TIMER WHEEL
+
+using Wheel = TimerWheel<std::uint64_t>;  // payload: the tick the timer should fire on
+
+/** @brief Advance to target, recording every firing as (tick fired, payload); the timers finish. */
+std::vector<std::pair<std::uint64_t, std::uint64_t>> runWheel(Wheel& wheel, std::uint64_t target) {
+    std::vector<std::pair<std::uint64_t, std::uint64_t>> fired;
+    wheel.advance(target, [&](Wheel::Id, std::uint64_t& due) -> std::uint64_t {
+        fired.emplace_back(wheel.now(), due);
+        return 0;
+    });
+    return fired;
+}
+
+/** @brief Timers fire on their tick, in order, on both sides of every level boundary. */
+void checkTimerWheelOrder() {
+    for (const std::uint64_t start : {std::uint64_t{0}, std::uint64_t{1000003}}) {
+        Wheel wheel{start};
+        std::vector<std::uint64_t> dues;
+        for (const std::uint64_t edge : {std::uint64_t{1} << 8, std::uint64_t{1} << 16, std::uint64_t{1} << 24}) {
+            for (const std::uint64_t delay : {edge - 1, edge, edge + 1}) dues.push_back(start + delay);
+        }
+        dues.push_back(start + 1);
+        dues.push_back(start + Wheel::kMaxDelay);
+        for (std::size_t i = dues.size(); i-- > 0;) wheel.add(dues[i], dues[i]);  // latest first
+
+        const auto fired = runWheel(wheel, start + Wheel::kMaxDelay);
+        std::sort(dues.begin(), dues.end());
+        bool onTime = fired.size() == dues.size();
+        for (std::size_t i = 0; onTime && i < fired.size(); ++i) {
+            onTime = fired[i].first == dues[i] && fired[i].second == dues[i];
+        }
+        check(onTime, "timers fire on their tick, in order, across level boundaries");
+        check(wheel.size() == 0 && wheel.nextTick() == Wheel::kNever, "a wheel with every timer fired is empty");
+    }
+}
+
+/** @brief Cancelling works at any level, before and after the timer cascaded down. */
+void checkTimerWheelCancel() {
+    Wheel wheel;
+    const Wheel::Id early = wheel.add(300, 300);                // level 1, cascades at 256
+    const Wheel::Id far = wheel.add(65536 + 300, 65536 + 300);  // level 2, cascades at 65536 and 65792
+    const Wheel::Id never = wheel.add(70000, 70000);            // cancelled before any cascade
+    const Wheel::Id kept = wheel.add(70001, 70001);
+    check(wheel.cancel(never), "cancel a timer still on its first level");
+
+    runWheel(wheel, 256);
+    check(wheel.dueOf(early) == 300, "a cascaded timer keeps its id and tick");
+    check(wheel.cancel(early), "cancel a timer after a cascade");
+    check(!wheel.cancel(early), "cancel twice is a no-op");
+
+    runWheel(wheel, 65536);
+    check(wheel.cancel(far), "cancel a timer after a cascade from level 2");
+
+    const auto fired = runWheel(wheel, 80000);
+    check(fired.size() == 1 && fired[0].first == 70001, "only the timer left fires");
+    check(!wheel.cancel(kept) && wheel.find(kept) == nullptr, "a fired timer's id is no longer valid");
+}
+
+/** @brief A timer that returns its next tick ("every") fires again there, under the same id. */
+void checkTimerWheelRepeat() {
+    Wheel wheel{10};
+    const Wheel::Id id = wheel.add(10 + 300, 0);  // every 300 ticks: over a level-0 block each time
+    std::vector<std::uint64_t> ticks;
+    wheel.advance(10 + 300 * 6, [&](Wheel::Id fired, std::uint64_t& runs) -> std::uint64_t {
+        check(fired == id, "a re-armed timer keeps its id");
+        ticks.push_back(wheel.now());
+        return ++runs < 5 ? wheel.now() + 300 : 0;
+    });
+    bool regular = ticks.size() == 5;
+    for (std::size_t i = 0; regular && i < ticks.size(); ++i) regular = ticks[i] == 10 + 300 * (i + 1);
+    check(regular, "a repeating timer fires every period until it finishes");
+    check(wheel.size() == 0, "a finished repeating timer is gone");
+}
+
+/**
+ * @brief 100000 pending timers (TimerHandler::kMaxTimers): the slab never outgrows them.
+ *
+ * Ids hold the node index, so an index past the count means the slab grew
+ * instead of reusing a freed node. Once grown, adding and cancelling do
+ * not allocate.
+ */
+void checkTimerWheelCapacity() {
+    constexpr std::size_t kTimers = 100000;
+    constexpr std::uint64_t kSpan = std::uint64_t{1} << 20;
+    Wheel wheel;
+    std::vector<Wheel::Id> ids;
+    ids.reserve(kTimers);
+    std::uint64_t seed = 12345;
+    const auto nextDue = [&seed] {
+        seed = seed * 6364136223846793005u + 1442695040888963407u;
+        return 1 + (seed >> 33) % (kSpan - 1);
+    };
+    for (std::size_t i = 0; i < kTimers; ++i) {
+        const std::uint64_t due = nextDue();
+        ids.push_back(wheel.add(due, due));
+    }
+    check(wheel.size() == kTimers, "every timer is pending");
+
+    const auto replaceHalf = [&] {
+        for (std::size_t i = 0; i < kTimers; i += 2) {
+            wheel.cancel(ids[i]);
+            const std::uint64_t due = nextDue();
+            ids[i] = wheel.add(due, due);
+        }
+    };
+    replaceHalf();  // warm-up: the free list grows once
+    std::uint64_t allocated = 0;
+    {
+        AllocationScope scope;
+        replaceHalf();
+        allocated = scope.count();
+    }
+    check(allocated == 0, "cancel and add reuse the slab without allocating");
+    check(std::all_of(ids.begin(), ids.end(), [](Wheel::Id id) { return (id & 0xFFFFFFFFu) <= kTimers; }),
+          "the slab holds no more nodes than timers pending");
+
+    const auto fired = runWheel(wheel, kSpan);
+    bool ordered = fired.size() == kTimers;
+    for (std::size_t i = 0; ordered && i < fired.size(); ++i) {
+        ordered = fired[i].first == fired[i].second && (i == 0 || fired[i - 1].first <= fired[i].first);
+    }
+    check(ordered, "100000 timers all fire on their tick, in order");
+}
+
+}  // namespace
+
+int main() {
+    checkFramePathDoesNotAllocate();
+    checkSplicedMatchesPrepared();
+    checkSpliceRebuildIsBounded();
+    checkStaleFrameKeepsSteps();
+    checkTimerWheelOrder();
+    checkTimerWheelCancel();
+    checkTimerWheelRepeat();
+    checkTimerWheelCapacity();
+    if (failures) return EXIT_FAILURE;
+    std::puts("marquee_tests: all checks passed");
+    return EXIT_SUCCESS;
+}